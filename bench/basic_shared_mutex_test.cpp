@@ -0,0 +1,255 @@
+/**
+ * Compile-and-run checks for basic_shared_mutex. Instantiates the template
+ * with the policies the node module doesn't use, like no_mutex_stats and
+ * park_wait_policy, and checks the locking behaviour of two instances and lock_all().
+ *
+ * Usage: basic_shared_mutex_test
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "basic_shared_mutex.hpp"
+#include "lock_all.hpp"
+
+/**
+ * Fail the test if a condition doesn't hold. Unlike assert(), also checked in release builds.
+ */
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            std::exit(1); \
+        } \
+    } while (false)
+
+static_assert(!no_mutex_stats::enabled, "no_mutex_stats must record nothing");
+
+/**
+ * Check exclusive and timed locking of two instances of the same mutex
+ *
+ * @tparam Mutex the basic_shared_mutex type
+ * @param name the mutex name
+ * @param options the mutex options
+ */
+template<class Mutex>
+static void check_locking(const std::string &name, const shared_mutex_options &options = {}) {
+    Mutex mutex(name, options);
+    Mutex other(name, options);
+
+    mutex.lock();
+    CHECK(mutex.locked());
+    CHECK(!other.try_lock());
+    CHECK(!other.try_lock_for(std::chrono::milliseconds(10)));
+    mutex.unlock();
+    CHECK(!mutex.locked());
+
+    CHECK(other.try_lock_for(std::chrono::milliseconds(10)));
+    CHECK(!mutex.try_lock());
+    other.unlock();
+
+    // A huge timeout must wait for the mutex instead of overflowing into the past
+    mutex.lock();
+    std::thread unlocker([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        mutex.unlock();
+    });
+    CHECK(other.try_lock_for(std::chrono::hours::max()));
+    unlocker.join();
+    other.unlock();
+}
+
+/**
+ * Check shared locking of two instances of the same mutex
+ *
+ * @tparam Mutex the basic_shared_mutex type, its backend must support shared ownership
+ * @param name the mutex name
+ * @param options the mutex options
+ */
+template<class Mutex>
+static void check_shared_locking(const std::string &name, const shared_mutex_options &options = {}) {
+    Mutex mutex(name, options);
+    Mutex other(name, options);
+
+    mutex.lock_shared();
+    CHECK(other.try_lock_shared());
+    CHECK(!other.try_lock());
+    other.unlock_shared();
+    mutex.unlock_shared();
+
+    mutex.lock();
+    CHECK(!other.try_lock_shared());
+    CHECK(!other.try_lock_shared_for(std::chrono::milliseconds(10)));
+    mutex.unlock();
+    CHECK(other.try_lock());
+    other.unlock();
+}
+
+/**
+ * Check that threads sharing one instance keep its lock count consistent
+ *
+ * @tparam Mutex the basic_shared_mutex type, its backend must support shared ownership
+ * @param name the mutex name
+ */
+template<class Mutex>
+static void check_shared_threads(const std::string &name) {
+    constexpr int thread_count = 4;
+    constexpr int iterations = 2000;
+
+    Mutex other(name);
+    {
+        Mutex mutex(name);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < iterations; i++) {
+                    mutex.lock_shared();
+                    mutex.unlock_shared();
+                }
+
+                // Keep one shared lock, which must be released by the destructor
+                mutex.lock_shared();
+            });
+        }
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        CHECK(!other.try_lock());
+    }
+
+    CHECK(other.try_lock());
+    other.unlock();
+}
+
+/**
+ * Check that threads contending for the mutex through separate instances exclude each other
+ *
+ * @tparam Mutex the basic_shared_mutex type
+ * @param name the mutex name
+ * @param options the mutex options
+ */
+template<class Mutex>
+static void check_contention(const std::string &name, const shared_mutex_options &options = {}) {
+    constexpr int thread_count = 4;
+    constexpr int iterations = 2000;
+
+    int counter = 0;
+    std::atomic<int> inside(0);
+    std::atomic<bool> overlapped(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; t++) {
+        threads.emplace_back([&] {
+            Mutex mutex(name, options);
+            for (int i = 0; i < iterations; i++) {
+                mutex.lock();
+                if (inside.fetch_add(1) != 0) overlapped = true;
+                counter++;
+                inside.fetch_sub(1);
+                mutex.unlock();
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    CHECK(!overlapped);
+    CHECK(counter == thread_count * iterations);
+}
+
+/**
+ * Check that a mutex without statistics records nothing, even if the stats option is set
+ *
+ * @tparam Mutex the basic_shared_mutex type
+ * @param name the mutex name
+ */
+template<class Mutex>
+static void check_no_stats(const std::string &name) {
+    static_assert(std::is_same<typename Mutex::stats_policy_type, no_mutex_stats>::value,
+                  "the mutex must not record statistics");
+
+    shared_mutex_options options;
+    options.stats = true;
+    Mutex mutex(name, options);
+    mutex.lock();
+    mutex.unlock();
+
+    const mutex_stats stats = mutex.stats();
+    CHECK(!stats.enabled);
+    CHECK(stats.acquisitions == 0);
+}
+
+/**
+ * Check locking multiple mutexes at once
+ *
+ * @tparam Mutex the basic_shared_mutex type
+ * @param name the prefix of the mutex names
+ */
+template<class Mutex>
+static void check_lock_all(const std::string &name) {
+    Mutex first(name + "_first");
+    Mutex second(name + "_second");
+    Mutex other(name + "_second");
+
+    lock_all(std::vector<Mutex *>{&first, &second});
+    CHECK(first.locked() && second.locked());
+    CHECK(!other.try_lock());
+    unlock_all(std::vector<Mutex *>{&first, &second});
+    CHECK(!first.locked() && !second.locked());
+
+    // The other instance holds the second mutex, so nothing must be locked after the timeout
+    CHECK(other.try_lock());
+    CHECK(!try_lock_all_for(std::vector<Mutex *>{&first, &second}, std::chrono::milliseconds(10)));
+    CHECK(!first.locked() && !second.locked());
+    other.unlock();
+
+    bool thrown = false;
+    try {
+        lock_all(std::vector<Mutex *>{&first, &second, &other});
+    } catch (const shared_mutex_exception &) {
+        thrown = true;
+    }
+
+    CHECK(thrown);
+    CHECK(!first.locked() && !second.locked() && !other.locked());
+}
+
+int main() {
+    shared_mutex_options adaptive;
+    adaptive.waiting.mode = wait_mode::adaptive;
+
+    check_locking<basic_shared_mutex<fair_mutex_backend, park_wait_policy, no_mutex_stats>>("bsm_test_fair");
+    check_contention<basic_shared_mutex<fair_mutex_backend, park_wait_policy, no_mutex_stats>>("bsm_test_fair");
+    check_no_stats<basic_shared_mutex<fair_mutex_backend, park_wait_policy, no_mutex_stats>>("bsm_test_fair");
+    check_lock_all<basic_shared_mutex<fair_mutex_backend, park_wait_policy, no_mutex_stats>>("bsm_test_fair");
+    check_locking<basic_shared_mutex<fair_mutex_backend, wait_policy, no_mutex_stats>>("bsm_test_fair_adaptive",
+                                                                                     adaptive);
+    check_contention<basic_shared_mutex<fair_mutex_backend, wait_policy, no_mutex_stats>>("bsm_test_fair_adaptive",
+                                                                                        adaptive);
+
+#ifdef OS_LINUX
+    check_locking<static_futex_mutex>("bsm_test_futex");
+    check_shared_locking<static_futex_mutex>("bsm_test_futex");
+    check_shared_threads<static_futex_mutex>("bsm_test_futex");
+    check_contention<static_futex_mutex>("bsm_test_futex");
+    check_no_stats<static_futex_mutex>("bsm_test_futex");
+    check_lock_all<static_futex_mutex>("bsm_test_futex");
+    check_locking<basic_shared_mutex<futex_mutex_backend, wait_policy, no_mutex_stats>>("bsm_test_futex_adaptive",
+                                                                                      adaptive);
+    check_shared_locking<basic_shared_mutex<futex_mutex_backend, wait_policy, no_mutex_stats>>(
+            "bsm_test_futex_adaptive", adaptive);
+    check_contention<basic_shared_mutex<futex_mutex_backend, wait_policy, no_mutex_stats>>("bsm_test_futex_adaptive",
+                                                                                         adaptive);
+#endif //OS_LINUX
+
+    std::cout << "All basic_shared_mutex checks passed" << std::endl;
+    return 0;
+}
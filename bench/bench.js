@@ -0,0 +1,191 @@
+/**
+ * Benchmarks for the promise based lock operations.
+ * Measures the overhead of lock() compared to lock_blocking() and
+ * try_lock() and the throughput of many concurrent lock() calls.
+ *
+ * Usage: node bench/bench.js [--backend <name>] [--iterations <n>] [--concurrency <n>] [--json]
+ */
+const {performance} = require('perf_hooks');
+const mutex = require('../index');
+
+/**
+ * Parse the command line arguments
+ *
+ * @return {{backends: string[], iterations: number, concurrency: number, json: boolean}} the options
+ */
+function parse_args() {
+    const options = {
+        backends: process.platform === 'linux' ? ['semaphore', 'futex', 'robust', 'fair'] :
+            process.platform === 'win32' ? ['semaphore', 'fair'] : ['semaphore', 'robust', 'fair'],
+        iterations: 20000,
+        concurrency: 100,
+        json: false
+    };
+
+    const args = process.argv.slice(2);
+    for (let i = 0; i < args.length; i++) {
+        switch (args[i]) {
+            case '--backend':
+                options.backends = [args[++i]];
+                break;
+            case '--iterations':
+                options.iterations = Number(args[++i]);
+                break;
+            case '--concurrency':
+                options.concurrency = Number(args[++i]);
+                break;
+            case '--json':
+                options.json = true;
+                break;
+            default:
+                throw new Error(`Unknown argument: ${args[i]}`);
+        }
+    }
+
+    return options;
+}
+
+/**
+ * Compute the latency statistics of a benchmark
+ *
+ * @param {string} name the benchmark name
+ * @param {number[]} samples the latency samples in nanoseconds
+ * @param {number} elapsed the duration of the benchmark in milliseconds
+ * @return {object} the result
+ */
+function compute_result(name, samples, elapsed) {
+    samples.sort((a, b) => a - b);
+    const percentile = p => samples[Math.floor(p * (samples.length - 1))];
+
+    return {
+        name,
+        operations: samples.length,
+        ops_per_sec: samples.length / (elapsed / 1000),
+        mean_ns: samples.reduce((a, b) => a + b, 0) / samples.length,
+        p50_ns: percentile(0.5),
+        p90_ns: percentile(0.9),
+        p99_ns: percentile(0.99),
+        p999_ns: percentile(0.999),
+        max_ns: samples[samples.length - 1]
+    };
+}
+
+/**
+ * Measure the latency of an operation
+ *
+ * @param {string} name the benchmark name
+ * @param {number} iterations the number of iterations
+ * @param {function} op the operation to measure, may return a promise
+ * @return {Promise<object>} the result
+ */
+async function measure(name, iterations, op) {
+    const samples = [];
+    const start = performance.now();
+    for (let i = 0; i < iterations; i++) {
+        const before = process.hrtime.bigint();
+        await op();
+        samples.push(Number(process.hrtime.bigint() - before));
+    }
+
+    return compute_result(name, samples, performance.now() - start);
+}
+
+/**
+ * Measure the throughput of many concurrent lock() calls on
+ * different instances of the same mutex
+ *
+ * @param {string} name the mutex name
+ * @param {object} mtx_options the mutex options
+ * @param {number} iterations the total number of acquisitions
+ * @param {number} concurrency the number of concurrent lock() calls
+ * @return {Promise<object>} the result
+ */
+async function measure_contended(name, mtx_options, iterations, concurrency) {
+    const mutexes = [];
+    for (let i = 0; i < concurrency; i++) {
+        mutexes.push(new mutex.shared_mutex(name, mtx_options));
+    }
+
+    const samples = [];
+    const per_worker = Math.ceil(iterations / concurrency);
+    const start = performance.now();
+
+    await Promise.all(mutexes.map(async mtx => {
+        for (let i = 0; i < per_worker; i++) {
+            const before = process.hrtime.bigint();
+            await mtx.lock();
+            samples.push(Number(process.hrtime.bigint() - before));
+            mtx.unlock();
+        }
+    }));
+
+    const result = compute_result('lock_contended', samples, performance.now() - start);
+    result.concurrency = concurrency;
+    mutexes.forEach(mtx => mtx.destroy());
+
+    return result;
+}
+
+/**
+ * Run all benchmarks for a backend
+ *
+ * @param {string} backend the backend name
+ * @param {object} options the benchmark options
+ * @return {Promise<object>} the results
+ */
+async function run_backend(backend, options) {
+    const name = `shared_mutex_bench_js_${backend}_${process.pid}`;
+    const mtx_options = {backend};
+    const mtx = new mutex.shared_mutex(name, mtx_options);
+    const results = [];
+
+    results.push(await measure('lock', options.iterations, async () => {
+        await mtx.lock();
+        mtx.unlock();
+    }));
+
+    results.push(await measure('lock_blocking', options.iterations, () => {
+        mtx.lock_blocking();
+        mtx.unlock();
+    }));
+
+    results.push(await measure('try_lock', options.iterations, () => {
+        if (mtx.try_lock()) mtx.unlock();
+    }));
+
+    results.push(await measure_contended(name, mtx_options, options.iterations, options.concurrency));
+    mtx.destroy();
+
+    return {backend, benchmarks: results};
+}
+
+/**
+ * Print the results in a human readable format
+ *
+ * @param {object} result the results of a backend
+ */
+function print_result(result) {
+    console.log(result.backend);
+    for (const bench of result.benchmarks) {
+        console.log(`  ${bench.name}: ${Math.round(bench.ops_per_sec)} ops/s, mean ${Math.round(bench.mean_ns)} ns, ` +
+            `p50 ${bench.p50_ns} ns, p99 ${bench.p99_ns} ns, p99.9 ${bench.p999_ns} ns, max ${bench.max_ns} ns`);
+    }
+}
+
+async function main() {
+    const options = parse_args();
+    const results = [];
+    for (const backend of options.backends) {
+        const result = await run_backend(backend, options);
+        results.push(result);
+
+        if (!options.json) print_result(result);
+    }
+
+    if (options.json) console.log(JSON.stringify(results));
+}
+
+main().catch(e => {
+    console.error(e);
+    process.exit(1);
+});
@@ -0,0 +1,608 @@
+/**
+ * Benchmarks for the shared_mutex backends.
+ * Measures the uncontended lock and try_lock latency and the
+ * throughput of a mutex contended by multiple processes and threads.
+ *
+ * Usage: shared_mutex_bench [options]
+ *   --backend <name>        auto, semaphore, futex, robust, fair or all (default: all)
+ *   --wait-policy <name>    park or adaptive (default: park)
+ *   --iterations <n>        the number of iterations of the latency benchmarks (default: 100000)
+ *   --processes <n>         the number of processes of the contended benchmark (default: 2)
+ *   --threads <n>           the number of threads per process of the contended benchmark (default: 2)
+ *   --duration <ms>         the duration of the contended benchmark (default: 1000)
+ *   --work <n>              the number of loop iterations in the critical section (default: 100)
+ *   --json                  print the results as json
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shared_mutex.hpp"
+#include "basic_shared_mutex.hpp"
+
+#ifdef OS_UNIX
+#   include <sys/mman.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#endif //OS_UNIX
+
+using bench_clock = std::chrono::steady_clock;
+
+/**
+ * The benchmark options
+ */
+struct bench_options {
+    // The backends to benchmark
+    std::vector<std::string> backends;
+    // The wait policy of the mutexes
+    std::string wait_policy = "park";
+    // The number of iterations of the latency benchmarks
+    uint64_t iterations = 100000;
+    // The number of processes of the contended benchmark
+    uint32_t processes = 2;
+    // The number of threads per process of the contended benchmark
+    uint32_t threads = 2;
+    // The duration of the contended benchmark
+    std::chrono::milliseconds duration{1000};
+    // The number of loop iterations in the critical section
+    uint32_t work = 100;
+    // Whether to print the results as json
+    bool json = false;
+};
+
+/**
+ * The result of a benchmark
+ */
+struct bench_result {
+    // The benchmark name
+    std::string name;
+    // The number of operations
+    uint64_t operations = 0;
+    // The number of operations per second
+    double ops_per_sec = 0;
+    // The mean latency in nanoseconds
+    double mean_ns = 0;
+    // The latency percentiles in nanoseconds
+    double p50_ns = 0, p90_ns = 0, p99_ns = 0, p999_ns = 0, max_ns = 0;
+    // The min and max number of operations per thread, only set for the contended benchmark
+    uint64_t min_thread_ops = 0, max_thread_ops = 0;
+};
+
+/**
+ * Get the backends available on this platform
+ *
+ * @return the backend names
+ */
+static std::vector<std::string> available_backends() {
+#ifdef OS_LINUX
+    return {"semaphore", "futex", "robust", "fair"};
+#elif defined(OS_UNIX)
+    return {"semaphore", "robust", "fair"};
+#else
+    return {"semaphore", "fair"};
+#endif
+}
+
+/**
+ * Convert a backend name and the benchmark options to mutex options
+ *
+ * @param backend the backend name
+ * @param options the benchmark options
+ * @return the mutex options
+ */
+static shared_mutex_options mutex_options(const std::string &backend, const bench_options &options) {
+    shared_mutex_options result;
+    if (backend == "auto") {
+        result.backend = shared_mutex_backend::automatic;
+    } else if (backend == "semaphore") {
+        result.backend = shared_mutex_backend::semaphore;
+    } else if (backend == "futex") {
+        result.backend = shared_mutex_backend::futex;
+    } else if (backend == "robust") {
+        result.backend = shared_mutex_backend::robust;
+    } else if (backend == "fair") {
+        result.backend = shared_mutex_backend::fair;
+    } else {
+        throw std::invalid_argument("Unknown backend: " + backend);
+    }
+
+    if (options.wait_policy == "adaptive") {
+        result.waiting.mode = wait_mode::adaptive;
+    } else if (options.wait_policy != "park") {
+        throw std::invalid_argument("Unknown wait policy: " + options.wait_policy);
+    }
+
+    return result;
+}
+
+/**
+ * Get the name of the mutex used by the benchmarks
+ *
+ * @param backend the backend name
+ * @return a mutex name unique to this run
+ */
+static std::string mutex_name(const std::string &backend) {
+#ifdef OS_UNIX
+    return "shared_mutex_bench_" + backend + "_" + std::to_string(getpid());
+#else
+    return "shared_mutex_bench_" + backend;
+#endif //OS_UNIX
+}
+
+/**
+ * Fill the latency statistics of a result from latency samples
+ *
+ * @param result the result to fill
+ * @param samples the latency samples in nanoseconds
+ */
+static void compute_percentiles(bench_result &result, std::vector<uint64_t> &samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](double p) {
+        const auto index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        return static_cast<double>(samples[index]);
+    };
+
+    double sum = 0;
+    for (uint64_t sample : samples) sum += static_cast<double>(sample);
+
+    result.mean_ns = sum / static_cast<double>(samples.size());
+    result.p50_ns = percentile(0.5);
+    result.p90_ns = percentile(0.9);
+    result.p99_ns = percentile(0.99);
+    result.p999_ns = percentile(0.999);
+    result.max_ns = static_cast<double>(samples.back());
+}
+
+/**
+ * Measure the latency of an operation
+ *
+ * @param name the benchmark name
+ * @param iterations the number of iterations
+ * @param op the operation to measure
+ * @param after called after every measured operation, not measured
+ * @return the result
+ */
+template<class Op, class After>
+static bench_result measure_latency(const std::string &name, uint64_t iterations, Op &&op, After &&after) {
+    std::vector<uint64_t> samples;
+    samples.reserve(iterations);
+
+    const auto start = bench_clock::now();
+    for (uint64_t i = 0; i < iterations; i++) {
+        const auto before = bench_clock::now();
+        op();
+        samples.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - before).count()));
+        after();
+    }
+
+    const std::chrono::duration<double> elapsed = bench_clock::now() - start;
+
+    bench_result result;
+    result.name = name;
+    result.operations = iterations;
+    result.ops_per_sec = static_cast<double>(iterations) / elapsed.count();
+    compute_percentiles(result, samples);
+
+    return result;
+}
+
+/**
+ * Measure the uncontended lock and try_lock latency of two instances of a mutex
+ *
+ * @param prefix the prefix of the benchmark names
+ * @param mutex the instance to measure
+ * @param other another instance of the same mutex
+ * @param options the benchmark options
+ * @param results the results to add to
+ */
+template<class Mutex>
+static void measure_locks(const std::string &prefix, Mutex &mutex, Mutex &other, const bench_options &options,
+                          std::vector<bench_result> &results) {
+    results.push_back(measure_latency(prefix + "lock_unlock", options.iterations, [&] {
+        mutex.lock();
+        mutex.unlock();
+    }, [] {}));
+
+    results.push_back(measure_latency(prefix + "try_lock", options.iterations, [&] {
+        if (!mutex.try_lock()) throw std::runtime_error("try_lock() failed on an unlocked mutex");
+    }, [&] {
+        mutex.unlock();
+    }));
+
+    other.lock();
+    results.push_back(measure_latency(prefix + "try_lock_contended", options.iterations, [&] {
+        if (mutex.try_lock()) throw std::runtime_error("try_lock() succeeded on a locked mutex");
+    }, [] {}));
+    other.unlock();
+}
+
+/**
+ * Measure the latency of a basic_shared_mutex, which is called without virtual calls
+ *
+ * @param name the mutex name
+ * @param options the benchmark options
+ * @param results the results to add to
+ */
+template<class Backend>
+static void measure_static_locks(const std::string &name, const bench_options &options,
+                                 std::vector<bench_result> &results) {
+    basic_shared_mutex<Backend, park_wait_policy, no_mutex_stats> mutex(name);
+    basic_shared_mutex<Backend, park_wait_policy, no_mutex_stats> other(name);
+    measure_locks("static_", mutex, other, options, results);
+}
+
+/**
+ * Run the uncontended latency benchmarks. The futex and fair backends are
+ * also measured through basic_shared_mutex without statistics.
+ *
+ * @param backend the backend name
+ * @param options the benchmark options
+ * @return the results
+ */
+static std::vector<bench_result> run_latency(const std::string &backend, const bench_options &options) {
+    const shared_mutex_options mtx_options = mutex_options(backend, options);
+    const std::string name = mutex_name(backend) + "_latency";
+    std::unique_ptr<shared_mutex> mutex = shared_mutex::createShared_mutex(name, true, mtx_options);
+    std::unique_ptr<shared_mutex> other = shared_mutex::createShared_mutex(name, true, mtx_options);
+
+    std::vector<bench_result> results;
+    measure_locks("", *mutex, *other, options, results);
+
+#ifdef OS_LINUX
+    if (backend == "futex") measure_static_locks<futex_mutex_backend>(name, options, results);
+#endif //OS_LINUX
+    if (backend == "fair") measure_static_locks<fair_mutex_backend>(name, options, results);
+
+    return results;
+}
+
+/**
+ * The results of a thread of the contended benchmark
+ */
+struct thread_result {
+    // The number of acquisitions
+    uint64_t operations;
+    // The number of stored samples
+    uint64_t sample_count;
+    // The lock latency samples in nanoseconds
+    uint64_t samples[1];
+};
+
+/**
+ * The memory shared by all processes of the contended benchmark
+ */
+struct contended_state {
+    // The number of threads ready to start
+    std::atomic<uint32_t> ready;
+    // Set once all threads should start
+    std::atomic<uint32_t> start;
+    // Set once all threads should stop
+    std::atomic<uint32_t> stop;
+    // The counter protected by the mutex
+    uint64_t counter;
+    // Set if a worker failed
+    std::atomic<uint32_t> failed;
+};
+
+// The max number of latency samples stored per thread
+static constexpr uint64_t max_samples = 20000;
+
+/**
+ * Get the size of the results of a thread
+ *
+ * @return the size in bytes
+ */
+static constexpr size_t thread_result_size() {
+    return sizeof(thread_result) + (max_samples - 1) * sizeof(uint64_t);
+}
+
+/**
+ * Run a worker thread of the contended benchmark
+ *
+ * @param name the mutex name
+ * @param mtx_options the mutex options
+ * @param work the number of loop iterations in the critical section
+ * @param state the shared state
+ * @param result the results of this thread
+ * @param seed the seed for sampling
+ */
+static void contended_worker(const std::string &name, const shared_mutex_options &mtx_options, uint32_t work,
+                             contended_state *state, thread_result *result, uint32_t seed) {
+    bool ready = false;
+    try {
+        std::unique_ptr<shared_mutex> mutex = shared_mutex::createShared_mutex(name, true, mtx_options);
+        std::mt19937_64 random(seed);
+
+        ready = true;
+        state->ready.fetch_add(1);
+        while (state->start.load() == 0) std::this_thread::yield();
+
+        while (state->stop.load(std::memory_order_relaxed) == 0) {
+            const auto before = bench_clock::now();
+            mutex->lock();
+            const auto latency = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - before).count());
+
+            for (volatile uint32_t i = 0; i < work; i = i + 1) {}
+            state->counter++;
+            mutex->unlock();
+
+            // Reservoir sampling keeps samples from the whole run
+            const uint64_t n = result->operations++;
+            if (n < max_samples) {
+                result->samples[n] = latency;
+                result->sample_count++;
+            } else {
+                const uint64_t index = random() % (n + 1);
+                if (index < max_samples) result->samples[index] = latency;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Worker failed: " << e.what() << std::endl;
+        state->failed.store(1);
+        if (!ready) state->ready.fetch_add(1);
+    }
+}
+
+/**
+ * Run the threads of a process of the contended benchmark
+ *
+ * @param name the mutex name
+ * @param mtx_options the mutex options
+ * @param options the benchmark options
+ * @param state the shared state
+ * @param results the results of the threads of this process
+ * @param process the index of this process
+ */
+static void contended_process(const std::string &name, const shared_mutex_options &mtx_options,
+                              const bench_options &options, contended_state *state, char *results, uint32_t process) {
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < options.threads; t++) {
+        auto *result = reinterpret_cast<thread_result *>(results + t * thread_result_size());
+        threads.emplace_back(contended_worker, name, mtx_options, options.work, state, result,
+                             process * options.threads + t);
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Run the contended benchmark
+ *
+ * @param backend the backend name
+ * @param options the benchmark options
+ * @return the result
+ */
+static bench_result run_contended(const std::string &backend, const bench_options &options) {
+    const shared_mutex_options mtx_options = mutex_options(backend, options);
+    const std::string name = mutex_name(backend) + "_contended";
+    const uint32_t total_threads = options.processes * options.threads;
+    const size_t size = sizeof(contended_state) + total_threads * thread_result_size();
+
+    // Keep one instance open, so the mutex isn't deleted while workers come and go
+    std::unique_ptr<shared_mutex> keep_alive = shared_mutex::createShared_mutex(name, true, mtx_options);
+
+#ifdef OS_UNIX
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw std::runtime_error("Could not map the benchmark memory");
+#else
+    if (options.processes > 1) {
+        throw std::invalid_argument("Multiple processes are only supported on unix systems");
+    }
+
+    void *memory = std::calloc(1, size);
+#endif //OS_UNIX
+
+    auto *state = new(memory) contended_state();
+    char *results = static_cast<char *>(memory) + sizeof(contended_state);
+
+#ifdef OS_UNIX
+    std::vector<pid_t> children;
+    for (uint32_t p = 1; p < options.processes; p++) {
+        const pid_t pid = fork();
+        if (pid == 0) {
+            contended_process(name, mtx_options, options, state, results + p * options.threads * thread_result_size(),
+                              p);
+            _exit(0);
+        } else if (pid == -1) {
+            throw std::runtime_error("fork() failed");
+        }
+
+        children.push_back(pid);
+    }
+#endif //OS_UNIX
+
+    std::thread local(contended_process, name, mtx_options, options, state, results, 0);
+
+    // Start all workers at once
+    while (state->ready.load() < total_threads) std::this_thread::yield();
+    const auto start = bench_clock::now();
+    state->start.store(1);
+
+    std::this_thread::sleep_for(options.duration);
+    state->stop.store(1);
+    local.join();
+
+#ifdef OS_UNIX
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+#endif //OS_UNIX
+
+    const std::chrono::duration<double> elapsed = bench_clock::now() - start;
+    if (state->failed.load()) throw std::runtime_error("A worker failed");
+
+    bench_result result;
+    result.name = "contended";
+    result.min_thread_ops = UINT64_MAX;
+
+    std::vector<uint64_t> samples;
+    for (uint32_t t = 0; t < total_threads; t++) {
+        const auto *thread = reinterpret_cast<const thread_result *>(results + t * thread_result_size());
+        result.operations += thread->operations;
+        result.min_thread_ops = std::min(result.min_thread_ops, thread->operations);
+        result.max_thread_ops = std::max(result.max_thread_ops, thread->operations);
+        samples.insert(samples.end(), thread->samples, thread->samples + thread->sample_count);
+    }
+
+    if (state->counter != result.operations) {
+        throw std::runtime_error("The mutex did not provide mutual exclusion: counter is " +
+                                 std::to_string(state->counter) + ", expected " +
+                                 std::to_string(result.operations));
+    }
+
+    result.ops_per_sec = static_cast<double>(result.operations) / elapsed.count();
+    compute_percentiles(result, samples);
+
+#ifdef OS_UNIX
+    munmap(memory, size);
+#else
+    std::free(memory);
+#endif //OS_UNIX
+
+    return result;
+}
+
+/**
+ * Print the results in a human readable format
+ *
+ * @param backend the backend name
+ * @param results the results
+ * @param options the benchmark options
+ */
+static void print_results(const std::string &backend, const std::vector<bench_result> &results,
+                          const bench_options &options) {
+    std::cout << backend << " (" << options.wait_policy << ")" << std::endl;
+    for (const bench_result &result : results) {
+        std::cout << "  " << result.name << ": " << static_cast<uint64_t>(result.ops_per_sec) << " ops/s, mean "
+                  << result.mean_ns << " ns, p50 " << result.p50_ns << " ns, p99 " << result.p99_ns
+                  << " ns, p99.9 " << result.p999_ns << " ns, max " << result.max_ns << " ns";
+        if (result.name == "contended") {
+            std::cout << ", " << options.processes << "x" << options.threads << " threads, ops per thread "
+                      << result.min_thread_ops << "-" << result.max_thread_ops;
+        }
+
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * Convert the results to json
+ *
+ * @param backend the backend name
+ * @param results the results
+ * @param options the benchmark options
+ * @return the json object
+ */
+static std::string to_json(const std::string &backend, const std::vector<bench_result> &results,
+                           const bench_options &options) {
+    std::ostringstream out;
+    out << "{\"backend\":\"" << backend << "\",\"wait_policy\":\"" << options.wait_policy
+        << "\",\"processes\":" << options.processes << ",\"threads\":" << options.threads << ",\"benchmarks\":[";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_result &result = results[i];
+        if (i > 0) out << ",";
+        out << "{\"name\":\"" << result.name << "\",\"operations\":" << result.operations
+            << ",\"ops_per_sec\":" << result.ops_per_sec << ",\"mean_ns\":" << result.mean_ns
+            << ",\"p50_ns\":" << result.p50_ns << ",\"p90_ns\":" << result.p90_ns
+            << ",\"p99_ns\":" << result.p99_ns << ",\"p999_ns\":" << result.p999_ns
+            << ",\"max_ns\":" << result.max_ns;
+        if (result.name == "contended") {
+            out << ",\"min_thread_ops\":" << result.min_thread_ops << ",\"max_thread_ops\":"
+                << result.max_thread_ops;
+        }
+
+        out << "}";
+    }
+
+    out << "]}";
+    return out.str();
+}
+
+/**
+ * Parse the command line arguments
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @return the benchmark options
+ */
+static bench_options parse_args(int argc, char **argv) {
+    bench_options options;
+    std::string backend = "all";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+
+        if (arg == "--backend") {
+            backend = value();
+        } else if (arg == "--wait-policy") {
+            options.wait_policy = value();
+        } else if (arg == "--iterations") {
+            options.iterations = std::stoull(value());
+        } else if (arg == "--processes") {
+            options.processes = static_cast<uint32_t>(std::max(std::stoul(value()), 1ul));
+        } else if (arg == "--threads") {
+            options.threads = static_cast<uint32_t>(std::max(std::stoul(value()), 1ul));
+        } else if (arg == "--duration") {
+            options.duration = std::chrono::milliseconds(std::stoull(value()));
+        } else if (arg == "--work") {
+            options.work = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--json") {
+            options.json = true;
+        } else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+
+    options.backends = backend == "all" ? available_backends() : std::vector<std::string>{backend};
+    return options;
+}
+
+int main(int argc, char **argv) {
+    try {
+        const bench_options options = parse_args(argc, argv);
+
+        if (options.json) std::cout << "[";
+        for (size_t i = 0; i < options.backends.size(); i++) {
+            const std::string &backend = options.backends[i];
+            std::vector<bench_result> results = run_latency(backend, options);
+            results.push_back(run_contended(backend, options));
+
+            if (options.json) {
+                if (i > 0) std::cout << ",";
+                std::cout << to_json(backend, results, options);
+            } else {
+                print_results(backend, results, options);
+            }
+        }
+
+        if (options.json) std::cout << "]" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,7 +1,29 @@
-const {process_mutex} = require('./index');
+const {process_mutex, shared_mutex, shared_barrier, shared_latch} = require('./index');
 const assert = require("assert");
 
-if (process.argv[2] === "expectFail") {
+if (process.argv[2] === "lockAndDie") {
+    // Die while holding the mutex, without running any cleanup
+    new shared_mutex(process.argv[3], {backend: "robust"}).lock_blocking();
+    process.kill(process.pid, "SIGKILL");
+} else if (process.argv[2] === "lockAndWait") {
+    // Hold the mutex until the parent kills this process
+    new shared_mutex(process.argv[3], {backend: "robust"}).lock_blocking();
+    process.send("locked");
+    setInterval(() => {}, 1000);
+} else if (process.argv[2] === "lockFileAndDie") {
+    // Die while holding the lock file, without running any cleanup
+    new process_mutex(process.argv[3], {backend: "lock_file", receive_args: true});
+    process.kill(process.pid, "SIGKILL");
+} else if (process.argv[2] === "forwardArgs") {
+    assert(process_mutex.forward_args(process.argv[3], process.argv.slice(4)));
+} else if (process.argv[2] === "barrierWait") {
+    // Rendezvous with the parent, then open the latch it waits for
+    const barrier = new shared_barrier(process.argv[3], 2);
+    barrier.wait({timeout: 5000}).then(() => {
+        new shared_latch(process.argv[3], 1).count_down();
+        barrier.destroy();
+    });
+} else if (process.argv[2] === "expectFail") {
     assert.throws(() => {
         new process_mutex("test");
     }, Error, "A mutex with the name 'test' is already owned by another program");
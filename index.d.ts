@@ -1,6 +1,30 @@
+/**
+ * The implementation backing a process mutex.
+ * 'semaphore' uses a named semaphore, which is left behind if the owner crashes.
+ * 'lock_file' locks a file, which the system releases once the owner exits
+ * or crashes. Only available on unix systems.
+ */
+export type process_mutex_backend = 'semaphore' | 'lock_file';
+
+/**
+ * Options for creating a process mutex
+ */
+export interface process_mutex_options {
+    /**
+     * The backend to use. Defaults to 'semaphore'.
+     */
+    backend?: process_mutex_backend;
+
+    /**
+     * Whether to receive the arguments forwarded by other instances
+     * using process_mutex.forward_args(). Requires the 'lock_file' backend.
+     */
+    receive_args?: boolean;
+}
+
 /**
  * A class for detecting if this program is already running.
- * Uses named mutexes/semaphores to detect if the program is already running.
+ * Uses named mutexes/semaphores or lock files to detect if the program is already running.
  * Can also check if other programs using @markusjx/shared_semaphore are running.
  */
 export class process_mutex {
@@ -9,8 +33,18 @@ export class process_mutex {
      * Throws an error if the program is already running.
      *
      * @param name the name of the program
+     * @param options the options
      */
-    constructor(name: string);
+    constructor(name: string, options?: process_mutex_options);
+
+    /**
+     * Wait for another instance to forward its arguments.
+     * Only available if the instance was created with receive_args.
+     *
+     * @param options the options
+     * @return the forwarded arguments
+     */
+    receive_args(options?: lock_options): Promise<string[]>;
 
     /**
      * Delete this instance's named mutex/semaphore
@@ -23,9 +57,181 @@ export class process_mutex {
      * Returns null if the program is already running.
      *
      * @param name the name of the program
+     * @param options the options
      * @return a processMutex instance or null if the program is already running
      */
-    static try_create(name: string): process_mutex | null;
+    static try_create(name: string, options?: process_mutex_options): process_mutex | null;
+
+    /**
+     * Forward arguments to the running instance of a program, which
+     * must use the 'lock_file' backend with receive_args enabled.
+     * Blocks until the running instance received them, for five seconds at most.
+     *
+     * @param name the name of the program
+     * @param args the arguments to forward
+     * @return false, if no running instance receives the arguments
+     */
+    static forward_args(name: string, args: string[]): boolean;
+}
+
+/**
+ * The implementation backing a shared mutex.
+ * 'auto' uses 'futex' on linux and 'semaphore' everywhere else.
+ * 'robust' recovers the mutex if its owner dies and is only available on unix systems.
+ * 'fair' serves waiters in the order they arrived.
+ * 'pi' boosts the priority of the owner while higher priority threads wait for it and is only available on linux.
+ * All processes using a mutex must use the same backend.
+ */
+export type shared_mutex_backend = 'auto' | 'semaphore' | 'futex' | 'robust' | 'fair' | 'pi';
+
+/**
+ * Options for creating a shared mutex
+ */
+export interface shared_mutex_options {
+    /**
+     * The backend to use. Defaults to 'auto'.
+     */
+    backend?: shared_mutex_backend;
+
+    /**
+     * Whether waiting writers block new readers from acquiring the
+     * mutex in shared mode, preventing writer starvation. Defaults to false.
+     * All instances of a mutex must use the same preference.
+     */
+    writer_preference?: boolean;
+
+    /**
+     * How to wait for the mutex if it is contended.
+     * 'park' waits in the kernel immediately. 'adaptive' spins for a while,
+     * then yields the CPU, then waits in the kernel. The number of spins
+     * adapts to how long the mutex was held for. Defaults to 'park'.
+     */
+    wait_policy?: 'park' | 'adaptive';
+
+    /**
+     * The max number of spins of the adaptive wait policy. Defaults to 4000.
+     */
+    max_spins?: number;
+
+    /**
+     * The max number of times the adaptive wait policy
+     * yields the CPU before waiting in the kernel. Defaults to 8.
+     */
+    max_yields?: number;
+
+    /**
+     * Whether to record the contention statistics of this instance in a
+     * shared memory segment next to the mutex, see shared_mutex.stats().
+     * Always enabled if the SHARED_MUTEX_STATS environment variable is set.
+     * Defaults to false.
+     */
+    stats?: boolean;
+
+    /**
+     * Whether to record the lock events of this instance in the trace
+     * ring of this machine, see shared_mutex.export_trace(). Always
+     * enabled if the SHARED_MUTEX_TRACE environment variable is set.
+     * Defaults to false.
+     */
+    trace?: boolean;
+}
+
+/**
+ * The number of contended acquisitions which succeeded in each wait phase
+ */
+export interface wait_stats {
+    /**
+     * The mutex was acquired while spinning
+     */
+    spin: number;
+
+    /**
+     * The mutex was acquired after yielding the CPU
+     */
+    yield: number;
+
+    /**
+     * The mutex was acquired after waiting in the kernel
+     */
+    park: number;
+}
+
+/**
+ * The contention statistics of a mutex, summed up over all processes using it
+ */
+export interface mutex_stats {
+    /**
+     * Whether this instance records the statistics. False if it was created
+     * without the stats option or the statistics were compiled out.
+     */
+    enabled: boolean;
+
+    /**
+     * The number of times the mutex was acquired
+     */
+    acquisitions: number;
+
+    /**
+     * The number of acquisitions which had to wait for the mutex
+     */
+    contended: number;
+
+    /**
+     * The number of try_lock() and try_lock_shared() calls which failed
+     */
+    try_lock_failures: number;
+
+    /**
+     * The total time contended acquisitions waited for, in nanoseconds
+     */
+    total_wait_ns: number;
+
+    /**
+     * The longest time a contended acquisition waited for, in nanoseconds
+     */
+    max_wait_ns: number;
+
+    /**
+     * The number of threads and lock operations currently waiting for the mutex
+     */
+    waiters: number;
+
+    /**
+     * How long the mutex was held exclusively. Element 0 counts holds shorter than
+     * 1µs, element i counts holds of [2^(i-1), 2^i) µs, the last element all longer holds.
+     */
+    hold_histogram: number[];
+}
+
+/**
+ * The result of a lock operation
+ */
+export interface lock_result {
+    /**
+     * Whether the previous owner of the mutex died while holding it.
+     * If true, the data protected by the mutex may be in an inconsistent state.
+     * Only the 'robust' and 'pi' backends can detect this.
+     */
+    inconsistent: boolean;
+}
+
+/**
+ * Options for a lock operation
+ */
+export interface lock_options {
+    /**
+     * The max time to wait for the mutex in milliseconds. Infinity waits
+     * forever, NaN is rejected with a RangeError.
+     * The promise is rejected with an error with the code
+     * 'ETIMEDOUT' if the mutex could not be acquired in time.
+     */
+    timeout?: number;
+
+    /**
+     * A signal to abort waiting for the mutex. The promise is
+     * rejected with an 'AbortError' once the signal is aborted.
+     */
+    signal?: AbortSignal;
 }
 
 /**
@@ -36,21 +242,25 @@ export class shared_mutex {
      * Create a new shared_mutex instance
      *
      * @param name the name of the mutex
+     * @param options the mutex options
      */
-    constructor(name: string);
+    constructor(name: string, options?: shared_mutex_options);
 
     /**
      * Lock the mutex. Blocking call.
      * May freeze your node.js instance.
+     *
+     * @return the lock result
      */
-    lock_blocking(): void;
+    lock_blocking(): lock_result;
 
     /**
      * Lock the mutex
      *
+     * @param options the lock options
      * @return the promise to be resolved when the ownership of the mutex is acquired
      */
-    lock(): Promise<void>;
+    lock(options?: lock_options): Promise<lock_result>;
 
     /**
      * Try locking the mutex.
@@ -70,8 +280,900 @@ export class shared_mutex {
      */
     unlock(): void;
 
+    /**
+     * Lock the mutex in shared mode. Any number of instances may own the
+     * mutex in shared mode at the same time, but not while it is owned exclusively.
+     * Only the 'futex' backend supports shared ownership, other
+     * backends lock the mutex exclusively instead.
+     *
+     * @param options the lock options
+     * @return the promise to be resolved when the shared ownership of the mutex is acquired
+     */
+    lock_shared(options?: lock_options): Promise<lock_result>;
+
+    /**
+     * Try locking the mutex in shared mode.
+     * Returns true if the shared ownership could be acquired.
+     * If so, the mutex must be unlocked using unlock_shared().
+     *
+     * @return true if the shared ownership could be acquired
+     */
+    try_lock_shared(): boolean;
+
+    /**
+     * Unlock the mutex from shared mode
+     */
+    unlock_shared(): void;
+
+    /**
+     * Lock the mutex, call a function and unlock the mutex once the
+     * function returned or the promise it returned settled, even if it threw.
+     * Resolves without a thread hop if the mutex is free.
+     *
+     * @param fn the function to call while the mutex is locked
+     * @param options the lock options
+     * @return the promise resolving to the value returned by the function
+     */
+    with_lock<T>(fn: (result: lock_result) => T | Promise<T>, options?: lock_options): Promise<T>;
+
+    /**
+     * Lock the mutex in shared mode, call a function and unlock the mutex
+     * once the function returned or the promise it returned settled, even if it threw
+     *
+     * @param fn the function to call while the mutex is locked in shared mode
+     * @param options the lock options
+     * @return the promise resolving to the value returned by the function
+     */
+    with_lock_shared<T>(fn: (result: lock_result) => T | Promise<T>, options?: lock_options): Promise<T>;
+
+    /**
+     * Check whether the previous owner of the mutex died while holding it.
+     * Refers to the last time this instance acquired the mutex.
+     *
+     * @return true if the previous owner died while holding the mutex
+     */
+    owner_died(): boolean;
+
+    /**
+     * Get the number of contended acquisitions by this instance
+     * which succeeded while spinning, yielding and waiting in the kernel
+     *
+     * @return the wait phase statistics
+     */
+    wait_stats(): wait_stats;
+
+    /**
+     * Get the contention statistics of the mutex, summed up over all
+     * processes using it. The counters are stored in a shared memory segment.
+     *
+     * @return the contention statistics
+     */
+    stats(): mutex_stats;
+
     /**
      * Delete the shared_mutex
      */
     destroy(): void;
+
+    /**
+     * Export the lock events traced by all processes on this machine
+     * as Chrome trace_event JSON, which can be loaded into Perfetto.
+     *
+     * @return the JSON document
+     */
+    static export_trace(): string;
+
+    /**
+     * Lock multiple mutexes at once. Never holds one of the mutexes while
+     * waiting for another one, so callers locking the same mutexes in a
+     * different order can't deadlock. Waits on the async waiter thread
+     * without a round trip through JavaScript per mutex.
+     *
+     * @param mutexes the mutexes to lock, each mutex name must be passed at most once
+     * @param options the lock options, none of the mutexes is locked if the lock times out or is aborted
+     * @return the promise resolving to the lock results, in the order of the mutexes
+     */
+    static lock_all(mutexes: shared_mutex[], options?: lock_options): Promise<lock_result[]>;
+
+    /**
+     * Unlock multiple mutexes locked by lock_all(), in reverse order
+     *
+     * @param mutexes the mutexes to unlock
+     */
+    static unlock_all(mutexes: shared_mutex[]): void;
+
+    /**
+     * Lock multiple mutexes at once, call a function and unlock
+     * the mutexes once the promise returned by the function settled
+     *
+     * @param mutexes the mutexes to lock, each mutex name must be passed at most once
+     * @param fn the function to call while the mutexes are locked
+     * @param options the lock options
+     * @return the promise resolving to the value returned by the function
+     */
+    static with_lock_all<T>(mutexes: shared_mutex[], fn: (results: lock_result[]) => T | Promise<T>,
+                            options?: lock_options): Promise<T>;
+}
+
+/**
+ * Options for creating a lock table
+ */
+export interface lock_table_options {
+    /**
+     * The number of lock slots the keys are hashed onto.
+     * Defaults to 1024, at most 1048576.
+     */
+    slots?: number;
+
+    /**
+     * Whether keys hashed onto a slot used by another key move
+     * to a free slot nearby instead of sharing its lock.
+     * Defaults to false.
+     */
+    detect_collisions?: boolean;
+}
+
+/**
+ * A table of exclusive locks identified by string keys,
+ * stored in a single shared memory segment
+ */
+export class lock_table {
+    /**
+     * Open or create a lock table.
+     * All processes using a table must use the same options.
+     *
+     * @param name the name of the table
+     * @param options the table options
+     */
+    constructor(name: string, options?: lock_table_options);
+
+    /**
+     * Lock a key. Blocking call.
+     * May freeze your node.js instance.
+     *
+     * @param key the key to lock
+     */
+    lock_blocking(key: string): void;
+
+    /**
+     * Lock a key
+     *
+     * @param key the key to lock
+     * @param options the lock options
+     * @return the promise to be resolved when the key is locked
+     */
+    lock(key: string, options?: lock_options): Promise<void>;
+
+    /**
+     * Try locking a key
+     *
+     * @param key the key to lock
+     * @return true if the key could be locked
+     */
+    try_lock(key: string): boolean;
+
+    /**
+     * Unlock a key locked by this instance
+     *
+     * @param key the key to unlock
+     */
+    unlock(key: string): void;
+
+    /**
+     * Get the slot a key is hashed onto
+     *
+     * @param key the key
+     * @return the index of the slot
+     */
+    home_slot(key: string): number;
+
+    /**
+     * Delete the lock table. Unlocks all keys locked by this instance.
+     */
+    destroy(): void;
+}
+
+/**
+ * Options for creating a shared semaphore
+ */
+export interface shared_semaphore_options {
+    /**
+     * The number of permits the semaphore starts with. Defaults to 1.
+     */
+    initial?: number;
+
+    /**
+     * The max number of permits. Defaults to the initial number.
+     */
+    max?: number;
+}
+
+/**
+ * A named counting semaphore
+ */
+export class shared_semaphore {
+    /**
+     * Open or create a semaphore. The options are only used by the
+     * process creating the semaphore, all processes must pass the same max count.
+     *
+     * @param name the name of the semaphore
+     * @param options the semaphore options
+     */
+    constructor(name: string, options?: shared_semaphore_options);
+
+    /**
+     * Acquire permits. Blocking call.
+     * May freeze your node.js instance.
+     *
+     * @param count the number of permits to acquire, defaults to 1
+     */
+    acquire_blocking(count?: number): void;
+
+    /**
+     * Acquire permits. All permits are acquired at once.
+     *
+     * @param count the number of permits to acquire, defaults to 1
+     * @param options the wait options
+     * @return the promise to be resolved when the permits are acquired
+     */
+    acquire(count?: number, options?: lock_options): Promise<void>;
+
+    /**
+     * Try acquiring permits
+     *
+     * @param count the number of permits to acquire, defaults to 1
+     * @return true if the permits could be acquired
+     */
+    try_acquire(count?: number): boolean;
+
+    /**
+     * Release permits. Throws if the max count would be exceeded.
+     *
+     * @param count the number of permits to release, defaults to 1
+     */
+    release(count?: number): void;
+
+    /**
+     * Get the number of available permits
+     *
+     * @return the number of permits which could be acquired right now
+     */
+    count(): number;
+
+    /**
+     * Delete the semaphore. Releases all permits acquired
+     * by this instance which were not released yet.
+     */
+    destroy(): void;
+}
+
+/**
+ * A named condition variable, used together with a shared_mutex
+ */
+export class shared_condition_variable {
+    /**
+     * Open or create a condition variable
+     *
+     * @param name the name of the condition variable
+     */
+    constructor(name: string);
+
+    /**
+     * Wait for a notification. Blocking call.
+     * The mutex must be locked by the given instance. It is unlocked
+     * while waiting and locked again before this call returns.
+     * May return spuriously, check the condition again after waiting.
+     *
+     * @param mutex the locked mutex
+     * @param timeout the max time to wait for in milliseconds
+     * @return false if the timeout was reached
+     */
+    wait_blocking(mutex: shared_mutex, timeout?: number): boolean;
+
+    /**
+     * Wait for a notification. The mutex must be locked by the given
+     * instance. It is unlocked while waiting and locked again before
+     * the promise resolves, even if the timeout was reached. If the
+     * wait is aborted, the promise is rejected and the mutex stays unlocked.
+     * May resolve spuriously, check the condition again after waiting.
+     *
+     * @param mutex the locked mutex
+     * @param options the wait options
+     * @return the promise resolving to false if the timeout was reached
+     */
+    wait(mutex: shared_mutex, options?: lock_options): Promise<boolean>;
+
+    /**
+     * Wake up one waiter
+     */
+    notify_one(): void;
+
+    /**
+     * Wake up all waiters
+     */
+    notify_all(): void;
+
+    /**
+     * Delete the condition variable
+     */
+    destroy(): void;
+}
+
+/**
+ * Options for creating a shared event
+ */
+export interface shared_event_options {
+    /**
+     * Whether the event stays set until reset() is called.
+     * Otherwise, the event is reset once a single waiter was released.
+     * Defaults to false.
+     */
+    manual_reset?: boolean;
+
+    /**
+     * Whether the event is set when it is created. Defaults to false.
+     */
+    initially_set?: boolean;
+}
+
+/**
+ * A named event
+ */
+export class shared_event {
+    /**
+     * Open or create an event. All processes must use the same reset mode.
+     *
+     * @param name the name of the event
+     * @param options the event options
+     */
+    constructor(name: string, options?: shared_event_options);
+
+    /**
+     * Set the event. Releases all waiters of a manual
+     * reset event or a single waiter of an auto reset event.
+     */
+    set(): void;
+
+    /**
+     * Reset the event
+     */
+    reset(): void;
+
+    /**
+     * Check whether the event is set. Resets an auto reset event, if it was set.
+     *
+     * @return true if the event was set
+     */
+    try_wait(): boolean;
+
+    /**
+     * Wait until the event is set. Blocking call.
+     * May freeze your node.js instance.
+     */
+    wait_blocking(): void;
+
+    /**
+     * Wait until the event is set
+     *
+     * @param options the wait options
+     * @return the promise to be resolved once the event is set
+     */
+    wait(options?: lock_options): Promise<void>;
+
+    /**
+     * Delete the event
+     */
+    destroy(): void;
+}
+
+/**
+ * Options for creating a cohort mutex
+ */
+export interface cohort_mutex_options extends shared_mutex_options {
+    /**
+     * The max number of times the cross-process mutex is passed on to
+     * a waiter in the same process before it is released. Defaults to 64.
+     */
+    max_handoffs?: number;
+}
+
+/**
+ * The cross-process acquisitions and local handoffs of a cohort mutex in this process
+ */
+export interface cohort_stats {
+    /**
+     * The number of times this process acquired the cross-process mutex
+     */
+    global_acquisitions: number;
+
+    /**
+     * The number of times the cross-process mutex was passed on to another waiter in this process
+     */
+    local_handoffs: number;
+}
+
+/**
+ * A two-level mutex. All instances in a process, including the ones in
+ * worker threads, first acquire an in-process lock. Only its owner acquires
+ * the cross-process shared_mutex, which is passed on to the next waiter in
+ * the same process instead of being released.
+ */
+export class cohort_mutex {
+    /**
+     * Create a new cohort_mutex instance. The options are
+     * only used by the first instance in a process.
+     *
+     * @param name the name of the mutex
+     * @param options the mutex options
+     */
+    constructor(name: string, options?: cohort_mutex_options);
+
+    /**
+     * Lock the mutex. Blocking call.
+     * May freeze your node.js instance.
+     */
+    lock_blocking(): void;
+
+    /**
+     * Lock the mutex
+     *
+     * @param options the lock options
+     * @return the promise to be resolved when the ownership of the mutex is acquired
+     */
+    lock(options?: lock_options): Promise<void>;
+
+    /**
+     * Try locking the mutex
+     *
+     * @return true if the ownership could be acquired
+     */
+    try_lock(): boolean;
+
+    /**
+     * Unlock the mutex
+     */
+    unlock(): void;
+
+    /**
+     * Get the number of cross-process acquisitions and local handoffs in this process
+     *
+     * @return the cohort statistics
+     */
+    stats(): cohort_stats;
+
+    /**
+     * Delete the cohort_mutex
+     */
+    destroy(): void;
+}
+
+/**
+ * Options for creating a lease mutex
+ */
+export interface lease_mutex_options {
+    /**
+     * The time to live of leases in milliseconds,
+     * if no other value is passed. Defaults to 30000.
+     */
+    ttl?: number;
+}
+
+/**
+ * Options for acquiring a lease
+ */
+export interface lease_lock_options extends lock_options {
+    /**
+     * The time to live of the lease in milliseconds
+     */
+    ttl?: number;
+}
+
+/**
+ * A mutex which is only held for a limited time. A lease expires unless
+ * it is renewed and may then be taken over by any waiter. Every lease is
+ * assigned a fencing token, which is greater than the tokens of all earlier leases.
+ */
+export class lease_mutex {
+    /**
+     * Create a new lease_mutex instance
+     *
+     * @param name the name of the mutex
+     * @param options the mutex options
+     */
+    constructor(name: string, options?: lease_mutex_options);
+
+    /**
+     * Acquire a lease. Blocking call.
+     * May freeze your node.js instance.
+     *
+     * @param ttl the time to live of the lease in milliseconds
+     * @return the fencing token of the lease
+     */
+    lock_blocking(ttl?: number): bigint;
+
+    /**
+     * Acquire a lease
+     *
+     * @param options the lock options
+     * @return the promise resolving to the fencing token of the lease
+     */
+    lock(options?: lease_lock_options): Promise<bigint>;
+
+    /**
+     * Try acquiring a lease
+     *
+     * @param ttl the time to live of the lease in milliseconds
+     * @return the fencing token of the lease or null if it is held by someone else
+     */
+    try_lock(ttl?: number): bigint | null;
+
+    /**
+     * Extend the lease held by this instance
+     *
+     * @param ttl the time to live of the lease from now on in milliseconds
+     * @return false if the lease was taken over by someone else
+     */
+    renew(ttl?: number): boolean;
+
+    /**
+     * Release the lease held by this instance
+     *
+     * @return false if the lease expired and was taken over by someone else
+     */
+    unlock(): boolean;
+
+    /**
+     * Check whether this instance still holds the lease
+     *
+     * @return true if the lease is held by this instance and didn't expire
+     */
+    held(): boolean;
+
+    /**
+     * Check whether a fencing token belongs to the current, unexpired lease
+     *
+     * @param token the fencing token
+     * @return true if the token is current
+     */
+    is_current(token: bigint): boolean;
+
+    /**
+     * Delete the lease_mutex
+     */
+    destroy(): void;
+}
+
+/**
+ * A named data region in shared memory protected by a seqlock.
+ * Readers copy the data without locking and never block writers or
+ * each other, writers only wait for other writers.
+ */
+export class shared_seqlock {
+    /**
+     * Create a new shared_seqlock instance
+     *
+     * @param name the name of the region
+     * @param size the size of the region in bytes, must match the size it was created with
+     */
+    constructor(name: string, size: number);
+
+    /**
+     * Copy the whole region into a new buffer
+     *
+     * @return the copied data
+     */
+    read(): Buffer;
+
+    /**
+     * Copy a part of the region into an existing array without allocating.
+     * Copies as many bytes as the array is long.
+     *
+     * @param target the array to copy the data to
+     * @param offset the offset in the region to copy the data from
+     * @return the sequence number of the copied data
+     */
+    read_into(target: NodeJS.TypedArray, offset?: number): number;
+
+    /**
+     * Copy data into the region. Blocks while another writer is writing.
+     *
+     * @param data the data to copy
+     * @param offset the offset in the region to copy the data to
+     */
+    write(data: NodeJS.TypedArray, offset?: number): void;
+
+    /**
+     * Get the current sequence number. It increases with every write,
+     * a copy is outdated if its sequence number differs.
+     *
+     * @return the sequence number
+     */
+    sequence(): number;
+
+    /**
+     * Get the size of the region
+     *
+     * @return the size in bytes
+     */
+    size(): number;
+
+    /**
+     * Delete the shared_seqlock
+     */
+    destroy(): void;
+}
+
+/**
+ * A named buffer in shared memory which can be grown. Its memory
+ * is exposed as an ArrayBuffer without copying, accesses must be
+ * synchronized using the mutex which comes with the buffer.
+ */
+export class shared_buffer {
+    /**
+     * The mutex guarding the buffer. It has the same name as the buffer.
+     */
+    readonly mutex: shared_mutex;
+
+    /**
+     * Create a new shared_buffer instance. Grows the buffer,
+     * if it already exists and is smaller than the given size.
+     *
+     * @param name the name of the buffer
+     * @param size the size of the buffer in bytes
+     * @param options the options of the mutex
+     */
+    constructor(name: string, size: number, options?: shared_mutex_options);
+
+    /**
+     * Get an ArrayBuffer backed by the shared memory. If another process grew
+     * the buffer, the new ArrayBuffer is larger, older ones keep their size.
+     *
+     * @return the ArrayBuffer
+     */
+    buffer(): ArrayBuffer;
+
+    /**
+     * Get the size of the buffer
+     *
+     * @return the size in bytes
+     */
+    size(): number;
+
+    /**
+     * Grow the buffer. Does nothing if it is already at least as large.
+     * Buffers can't be shrunk and can't be grown on windows.
+     *
+     * @param size the new size in bytes
+     */
+    grow(size: number): void;
+
+    /**
+     * Delete the shared_buffer and its mutex
+     */
+    destroy(): void;
+}
+
+/**
+ * Options for creating a shared ring
+ */
+export interface shared_ring_options {
+    /**
+     * The number of message slots, must be a power of two. Defaults to 1024.
+     */
+    capacity?: number;
+
+    /**
+     * The max size of a message in bytes. Defaults to 256.
+     */
+    slot_size?: number;
+
+    /**
+     * 'mpmc' allows any number of producers and consumers, 'spsc' is faster,
+     * but only one producer and one consumer may use the ring at a time.
+     * Defaults to 'mpmc'.
+     */
+    mode?: 'mpmc' | 'spsc';
+}
+
+/**
+ * A lock-free queue of fixed size messages in shared memory.
+ * Messages are copied into the ring and out of it once.
+ */
+export class shared_ring {
+    /**
+     * Create a new shared_ring instance. The options
+     * must match the ones the ring was created with.
+     *
+     * @param name the name of the ring
+     * @param options the ring options
+     */
+    constructor(name: string, options?: shared_ring_options);
+
+    /**
+     * Try pushing a message without blocking
+     *
+     * @param message the message
+     * @return false, if the ring is full
+     */
+    try_push(message: NodeJS.TypedArray): boolean;
+
+    /**
+     * Push as many of the messages as fit into the ring, in order
+     *
+     * @param messages the messages
+     * @return the number of messages pushed
+     */
+    try_push_batch(messages: NodeJS.TypedArray[]): number;
+
+    /**
+     * Push a message, waiting while the ring is full. Blocking call.
+     *
+     * @param message the message
+     */
+    push_blocking(message: NodeJS.TypedArray): void;
+
+    /**
+     * Push a message, waiting while the ring is full. Async call.
+     *
+     * @param message the message
+     * @param options the wait options
+     * @return the promise resolved once the message was pushed
+     */
+    push(message: NodeJS.TypedArray, options?: lock_options): Promise<void>;
+
+    /**
+     * Try popping a message without blocking
+     *
+     * @return the message or null, if the ring is empty
+     */
+    try_pop(): Buffer | null;
+
+    /**
+     * Pop up to max messages without blocking
+     *
+     * @param max the max number of messages to pop
+     * @return the messages, in order
+     */
+    try_pop_batch(max: number): Buffer[];
+
+    /**
+     * Pop a message, waiting while the ring is empty. Blocking call.
+     *
+     * @return the message
+     */
+    pop_blocking(): Buffer;
+
+    /**
+     * Pop a message, waiting while the ring is empty. Async call.
+     *
+     * @param options the wait options
+     * @return the promise resolved with the message
+     */
+    pop(options?: lock_options): Promise<Buffer>;
+
+    /**
+     * Get the number of messages in the ring
+     *
+     * @return the number of messages
+     */
+    size(): number;
+
+    /**
+     * Get the number of message slots
+     *
+     * @return the capacity
+     */
+    capacity(): number;
+
+    /**
+     * Delete the shared_ring
+     */
+    destroy(): void;
+}
+
+/**
+ * A named reusable barrier. Every participant arrives once per phase,
+ * all waiters are released once the last participant arrived.
+ */
+export class shared_barrier {
+    /**
+     * Open or create a barrier. All processes must pass the same number of participants.
+     *
+     * @param name the name of the barrier
+     * @param count the number of participants, between 1 and 65535
+     */
+    constructor(name: string, count: number);
+
+    /**
+     * Arrive at the barrier and wait until all participants arrived. Blocking call.
+     * May freeze your node.js instance. The arrival is withdrawn if the timeout was reached.
+     *
+     * @param timeout the max time to wait for in milliseconds
+     * @return false if the timeout was reached
+     */
+    wait_blocking(timeout?: number): boolean;
+
+    /**
+     * Arrive at the barrier and wait until all participants arrived.
+     * The arrival is withdrawn if the wait times out or is aborted.
+     *
+     * @param options the wait options
+     * @return the promise to be resolved once all participants arrived
+     */
+    wait(options?: lock_options): Promise<void>;
+
+    /**
+     * Get the number of participants
+     *
+     * @return the number of participants which must arrive to complete a phase
+     */
+    count(): number;
+
+    /**
+     * Get the number of participants which arrived in the current phase
+     *
+     * @return the number of arrived participants
+     */
+    arrived(): number;
+
+    /**
+     * Delete the barrier
+     */
+    destroy(): void;
+}
+
+/**
+ * A named single use latch. Opens once its counter reached zero.
+ */
+export class shared_latch {
+    /**
+     * Open or create a latch
+     *
+     * @param name the name of the latch
+     * @param count the initial counter value, only used by the process creating the latch
+     */
+    constructor(name: string, count: number);
+
+    /**
+     * Decrement the counter. Throws if it would drop below zero.
+     *
+     * @param n the value to decrement the counter by, defaults to 1
+     */
+    count_down(n?: number): void;
+
+    /**
+     * Check whether the counter reached zero
+     *
+     * @return true if the latch is open
+     */
+    try_wait(): boolean;
+
+    /**
+     * Wait until the counter reaches zero. Blocking call.
+     * May freeze your node.js instance.
+     *
+     * @param timeout the max time to wait for in milliseconds
+     * @return false if the timeout was reached
+     */
+    wait_blocking(timeout?: number): boolean;
+
+    /**
+     * Wait until the counter reaches zero
+     *
+     * @param options the wait options
+     * @return the promise to be resolved once the latch is open
+     */
+    wait(options?: lock_options): Promise<void>;
+
+    /**
+     * Get the current counter value
+     *
+     * @return the number of count downs still required to open the latch
+     */
+    count(): number;
+
+    /**
+     * Delete the latch
+     */
+    destroy(): void;
 }
@@ -1,6 +1,48 @@
 const native_addon = require('./bin/shared_mutex');
 
+/**
+ * Lock a mutex, call a function and unlock the mutex once the returned promise settled
+ *
+ * @param {Function} lock the function locking the mutex
+ * @param {Function} unlock the function unlocking the mutex
+ * @param {Function} fn the function to call with the lock result
+ * @return {Promise<*>} the value returned by the function
+ */
+async function with_lock(lock, unlock, fn) {
+    // lock() resolves right away without a thread hop if the mutex is free
+    const result = await lock();
+    try {
+        return await fn(result);
+    } finally {
+        unlock();
+    }
+}
+
+native_addon.shared_mutex.prototype.with_lock = function (fn, options) {
+    return with_lock(() => this.lock(options), () => this.unlock(), fn);
+};
+
+native_addon.shared_mutex.prototype.with_lock_shared = function (fn, options) {
+    return with_lock(() => this.lock_shared(options), () => this.unlock_shared(), fn);
+};
+
+native_addon.shared_mutex.with_lock_all = function (mutexes, fn, options) {
+    return with_lock(() => native_addon.shared_mutex.lock_all(mutexes, options),
+        () => native_addon.shared_mutex.unlock_all(mutexes), fn);
+};
+
 module.exports = {
     process_mutex: native_addon.process_mutex,
-    shared_mutex: native_addon.shared_mutex
-};
\ No newline at end of file
+    shared_mutex: native_addon.shared_mutex,
+    lock_table: native_addon.lock_table,
+    shared_semaphore: native_addon.shared_semaphore,
+    shared_condition_variable: native_addon.shared_condition_variable,
+    shared_event: native_addon.shared_event,
+    cohort_mutex: native_addon.cohort_mutex,
+    lease_mutex: native_addon.lease_mutex,
+    shared_seqlock: native_addon.shared_seqlock,
+    shared_buffer: native_addon.shared_buffer,
+    shared_ring: native_addon.shared_ring,
+    shared_barrier: native_addon.shared_barrier,
+    shared_latch: native_addon.shared_latch
+};
@@ -1,16 +1,42 @@
 #include <napi.h>
 #include <vector>
 
+#include "addon_data.hpp"
 #include "node_shared_mutex.hpp"
+#include "node_lock_table.hpp"
+#include "node_shared_semaphore.hpp"
+#include "node_shared_condition_variable.hpp"
+#include "node_shared_event.hpp"
+#include "node_cohort_mutex.hpp"
+#include "node_lease_mutex.hpp"
+#include "node_shared_seqlock.hpp"
+#include "node_shared_buffer.hpp"
+#include "node_shared_ring.hpp"
+#include "node_shared_barrier.hpp"
+#include "node_shared_latch.hpp"
 #include "process_mutex.hpp"
 
 /**
  * Export all functions
  */
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    // The constructors are stored per environment, so the module works in worker threads
+    env.SetInstanceData<addon_data>(new addon_data());
+
     // Export the functions
     node_shared_mutex::init(env, exports);
     process_mutex::init(env, exports);
+    node_lock_table::init(env, exports);
+    node_shared_semaphore::init(env, exports);
+    node_shared_condition_variable::init(env, exports);
+    node_shared_event::init(env, exports);
+    node_cohort_mutex::init(env, exports);
+    node_lease_mutex::init(env, exports);
+    node_shared_seqlock::init(env, exports);
+    node_shared_buffer::init(env, exports);
+    node_shared_ring::init(env, exports);
+    node_shared_barrier::init(env, exports);
+    node_shared_latch::init(env, exports);
 
     return exports;
 }
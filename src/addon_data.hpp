@@ -0,0 +1,18 @@
+#ifndef SHARED_MUTEX_ADDON_DATA_HPP
+#define SHARED_MUTEX_ADDON_DATA_HPP
+
+#include <napi.h>
+
+/**
+ * The data of the addon in a single environment, like the main thread or a
+ * worker thread. Set once when the module is initialized in the environment
+ * and deleted by node once the environment shuts down.
+ */
+struct addon_data {
+    // The constructor of the shared_mutex class
+    Napi::FunctionReference shared_mutex_constructor;
+    // The constructor of the process_mutex class
+    Napi::FunctionReference process_mutex_constructor;
+};
+
+#endif //SHARED_MUTEX_ADDON_DATA_HPP
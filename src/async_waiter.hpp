@@ -0,0 +1,409 @@
+#ifndef SHARED_MUTEX_ASYNC_WAITER_HPP
+#define SHARED_MUTEX_ASYNC_WAITER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platform.hpp"
+#include "futex.hpp"
+
+/**
+ * The ways a wait request can finish
+ */
+enum class wait_status {
+    // The request completed
+    completed,
+    // The deadline of the request was reached
+    timed_out,
+    // The request was cancelled
+    cancelled,
+    // The request threw an exception
+    failed
+};
+
+/**
+ * A request waiting for a shared object without blocking a thread.
+ * Requests are submitted to the async_waiter, which waits for all
+ * pending requests on a single thread.
+ */
+class wait_request {
+public:
+    /**
+     * Create a wait request
+     *
+     * @param deadline the time point to stop waiting at, futex::clock::time_point::max() to wait forever
+     */
+    explicit wait_request(futex::clock::time_point deadline = futex::clock::time_point::max())
+            : _deadline(deadline), _cancelled(false), _waited(false) {}
+
+    /**
+     * No copy constructor
+     */
+    wait_request(const wait_request &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    wait_request &operator=(const wait_request &) = delete;
+
+    /**
+     * Cancel the request. The request will finish
+     * with wait_status::cancelled, unless it already completed.
+     * May be called from any thread.
+     */
+    inline void cancel();
+
+    /**
+     * Check whether the request was cancelled
+     *
+     * @return true if the request was cancelled
+     */
+    [[nodiscard]] bool cancelled() const noexcept {
+        return _cancelled.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Get the deadline of the request
+     *
+     * @return the time point to stop waiting at
+     */
+    [[nodiscard]] futex::clock::time_point deadline() const noexcept {
+        return _deadline;
+    }
+
+    /**
+     * Delete the request
+     */
+    virtual ~wait_request() = default;
+
+protected:
+    friend class async_waiter;
+
+    /**
+     * Try to complete the request without blocking.
+     * Called on the waiter thread.
+     *
+     * @param waited whether the request waited on a target set by prepare_wait() before
+     * @return true, if the request completed
+     */
+    [[nodiscard]] virtual bool try_complete(bool waited) = 0;
+
+    /**
+     * Prepare waiting for the request to be completable.
+     * Called on the waiter thread, if try_complete() returned false.
+     *
+     * @param target set to the futex word to wait on
+     * @return whether to wait on the target, retry immediately or poll the request
+     */
+    [[nodiscard]] virtual wait_preparation prepare_wait(futex_target &target) {
+        (void) target;
+        return wait_preparation::unsupported;
+    }
+
+    /**
+     * Stop waiting after prepare_wait() returned a target.
+     * Called on the waiter thread, if the request timed out or was cancelled.
+     */
+    virtual void abandon_wait() {}
+
+    /**
+     * Called exactly once on the waiter thread when the request finished
+     *
+     * @param status how the request finished
+     * @param error the error message, if the request failed
+     */
+    virtual void finish(wait_status status, const std::string &error) = 0;
+
+private:
+    // The time point to stop waiting at
+    const futex::clock::time_point _deadline;
+    // Whether the request was cancelled
+    std::atomic<bool> _cancelled;
+    // Whether the request waited on a futex target
+    bool _waited;
+};
+
+/**
+ * Waits for all pending wait requests of this process on a single thread.
+ * Requests with futex targets are waited for using futex_waitv(2), all
+ * other requests are polled with an increasing interval. Local changes,
+ * like new requests, cancellations or released mutexes, wake up the
+ * waiter thread immediately.
+ */
+class async_waiter {
+public:
+    /**
+     * Get the waiter of this process
+     *
+     * @return the async_waiter instance
+     */
+    static async_waiter &instance() {
+        static async_waiter waiter;
+        return waiter;
+    }
+
+    /**
+     * Submit a request. The request's finish() method
+     * will be called on the waiter thread once it finished.
+     *
+     * @param request the request to submit
+     */
+    void submit(std::shared_ptr<wait_request> request) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_thread.joinable()) {
+                _thread = std::thread(&async_waiter::run, this);
+            }
+
+            _submitted.push_back(std::move(request));
+            _pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        notify();
+    }
+
+    /**
+     * Wake up the waiter thread to check all pending requests again.
+     * Should be called after releasing a shared object in this process.
+     */
+    void notify() {
+        _sequence.fetch_add(1, std::memory_order_release);
+#ifdef OS_LINUX
+        futex::wake(_sequence);
+#else
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+        }
+        _notification.notify_all();
+#endif //OS_LINUX
+    }
+
+    /**
+     * Wake up the waiter thread if there are any pending requests
+     */
+    void notify_if_waiting() {
+        if (_pending.load(std::memory_order_relaxed) > 0) {
+            notify();
+        }
+    }
+
+    /**
+     * Get the number of pending requests
+     *
+     * @return the number of requests which did not finish yet
+     */
+    [[nodiscard]] size_t pending() const noexcept {
+        return _pending.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Stop the waiter thread. Pending requests are not finished.
+     */
+    ~async_waiter() {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _stopped = true;
+        }
+
+        notify();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+private:
+    // The initial polling interval
+    static constexpr std::chrono::microseconds min_poll_interval{20};
+    // The max polling interval
+    static constexpr std::chrono::milliseconds max_poll_interval{2};
+
+    /**
+     * Create the waiter. The thread is started with the first request.
+     */
+    async_waiter() : _sequence(0), _pending(0), _stopped(false) {}
+
+    /**
+     * The waiter thread
+     */
+    void run() {
+        std::vector<std::shared_ptr<wait_request>> active;
+        std::vector<futex_target> targets;
+        std::chrono::microseconds poll_interval = min_poll_interval;
+
+        for (;;) {
+            // Any notification after this will change the sequence
+            const uint32_t sequence = _sequence.load(std::memory_order_acquire);
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_stopped) return;
+
+                std::move(_submitted.begin(), _submitted.end(), std::back_inserter(active));
+                _submitted.clear();
+            }
+
+            if (active.empty()) {
+                wait_for_notification(sequence, futex::clock::time_point::max());
+                continue;
+            }
+
+            const auto now = futex::clock::now();
+            auto deadline = futex::clock::time_point::max();
+            bool poll = false, retry = false, progress = false;
+            targets.clear();
+
+            for (size_t i = 0; i < active.size();) {
+                wait_request &request = *active[i];
+                if (!process(request, now)) {
+                    // The request finished, remove it
+                    std::swap(active[i], active.back());
+                    active.pop_back();
+                    _pending.fetch_sub(1, std::memory_order_relaxed);
+                    progress = true;
+                    continue;
+                }
+
+                deadline = std::min(deadline, request.deadline());
+                futex_target target;
+                switch (request.prepare_wait(target)) {
+                    case wait_preparation::unsupported:
+                        poll = true;
+                        break;
+                    case wait_preparation::retry:
+                        retry = true;
+                        break;
+                    case wait_preparation::wait:
+                        request._waited = true;
+                        deadline = std::min(deadline, target.recheck);
+                        retry |= !add_target(targets, target);
+                        break;
+                }
+
+                i++;
+            }
+
+            if (progress) poll_interval = min_poll_interval;
+            if (active.empty() || retry) continue;
+
+            // Wait on all targets and the notification word at once, poll if that's not possible
+            targets.push_back(futex_target{&_sequence, sequence});
+            if (!poll && futex::wait_any(targets.data(), targets.size(), deadline)) {
+                continue;
+            }
+
+            deadline = std::min(deadline, futex::clock::now() + poll_interval);
+            poll_interval = std::min<std::chrono::microseconds>(poll_interval * 2, max_poll_interval);
+            wait_for_notification(sequence, deadline);
+        }
+    }
+
+    /**
+     * Process a request
+     *
+     * @param request the request to process
+     * @param now the current time
+     * @return false if the request finished
+     */
+    static bool process(wait_request &request, futex::clock::time_point now) {
+        wait_status status;
+        std::string error;
+
+        try {
+            if (request.cancelled()) {
+                status = wait_status::cancelled;
+            } else if (request.try_complete(request._waited)) {
+                status = wait_status::completed;
+            } else if (now >= request.deadline()) {
+                status = wait_status::timed_out;
+            } else {
+                return true;
+            }
+
+            if (status != wait_status::completed && request._waited) {
+                request.abandon_wait();
+            }
+        } catch (const std::exception &e) {
+            status = wait_status::failed;
+            error = e.what();
+        } catch (...) {
+            status = wait_status::failed;
+            error = "Unknown error";
+        }
+
+        request.finish(status, error);
+        return false;
+    }
+
+    /**
+     * Add a target to the targets to wait on, if it isn't in the list yet
+     *
+     * @param targets the targets to wait on
+     * @param target the target to add
+     * @return false if the target is in the list with a different expected value
+     */
+    static bool add_target(std::vector<futex_target> &targets, const futex_target &target) {
+        for (const futex_target &t : targets) {
+            if (t.word == target.word) {
+                return t.expected == target.expected;
+            }
+        }
+
+        targets.push_back(target);
+        return true;
+    }
+
+    /**
+     * Wait until notify() is called or the deadline is reached
+     *
+     * @param sequence the value of the sequence before checking for changes
+     * @param deadline the time point to stop waiting at
+     */
+    void wait_for_notification(uint32_t sequence, futex::clock::time_point deadline) {
+#ifdef OS_LINUX
+        futex::wait_until(_sequence, sequence, deadline);
+#else
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto notified = [&] {
+            return _stopped || _sequence.load(std::memory_order_acquire) != sequence;
+        };
+
+        if (deadline == futex::clock::time_point::max()) {
+            _notification.wait(lock, notified);
+        } else {
+            _notification.wait_until(lock, deadline, notified);
+        }
+#endif //OS_LINUX
+    }
+
+    // The notification word, incremented by notify()
+    std::atomic<uint32_t> _sequence;
+    // The number of requests which did not finish yet
+    std::atomic<size_t> _pending;
+    // The mutex guarding the submitted requests
+    std::mutex _mutex;
+#ifndef OS_LINUX
+    // The condition variable notified by notify()
+    std::condition_variable _notification;
+#endif //OS_LINUX
+    // The requests submitted since the waiter thread last checked
+    std::vector<std::shared_ptr<wait_request>> _submitted;
+    // Whether the waiter is being destroyed
+    bool _stopped;
+    // The waiter thread
+    std::thread _thread;
+};
+
+void wait_request::cancel() {
+    _cancelled.store(true, std::memory_order_release);
+    async_waiter::instance().notify();
+}
+
+#endif //SHARED_MUTEX_ASYNC_WAITER_HPP
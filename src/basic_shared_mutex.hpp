@@ -0,0 +1,351 @@
+#ifndef SHARED_MUTEX_BASIC_SHARED_MUTEX_HPP
+#define SHARED_MUTEX_BASIC_SHARED_MUTEX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "wait_policy.hpp"
+#include "mutex_stats.hpp"
+#include "shared_mutex.hpp"
+
+/**
+ * A shared mutex whose backend and policies are chosen at compile time.
+ * Nothing is called through a virtual function, the uncontended lock and
+ * unlock operations inline to the atomic operations of the backend.
+ * Satisfies the Lockable and TimedLockable requirements, so it can be used
+ * with std::lock_guard, std::unique_lock and std::lock. Backends which
+ * support shared ownership also satisfy the SharedTimedLockable requirements.
+ *
+ * Instances of the same name share the mutex, no matter whether they were
+ * created by this template or by shared_mutex::createShared_mutex(), as
+ * long as they use the same backend. Unlike shared_mutex, the instances
+ * always open the mutex if it already exists.
+ *
+ * @tparam Backend the lock word algorithm, futex_mutex_backend or fair_mutex_backend
+ * @tparam WaitPolicy how to wait for a contended mutex, wait_policy or park_wait_policy
+ * @tparam StatsPolicy where to record the statistics, mutex_stats_recorder or no_mutex_stats
+ */
+template<class Backend, class WaitPolicy = wait_policy, class StatsPolicy = mutex_stats_recorder>
+class basic_shared_mutex {
+public:
+    // The lock word algorithm
+    using backend_type = Backend;
+    // How to wait for a contended mutex
+    using wait_policy_type = WaitPolicy;
+    // Where to record the statistics
+    using stats_policy_type = StatsPolicy;
+
+    /**
+     * Open or create a mutex. The backend option is ignored, the backend is the template parameter.
+     *
+     * @param name the mutex name
+     * @param options the mutex options
+     */
+    explicit basic_shared_mutex(const std::string &name, const shared_mutex_options &options = {})
+            : _name(name), _backend(name, true, options), _wait_policy(make_wait_policy(options.waiting)),
+              _locked(false), _shared_locks(0), _locked_at(0) {
+        _stats.open(name, options.stats, options.trace);
+    }
+
+    /**
+     * No copy constructor
+     */
+    basic_shared_mutex(const basic_shared_mutex &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    basic_shared_mutex &operator=(const basic_shared_mutex &) = delete;
+
+    /**
+     * Lock the mutex
+     */
+    void lock() {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    /**
+     * Try locking the mutex
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock() {
+        if (try_acquire(false)) return true;
+
+        _stats.try_lock_failed();
+        return false;
+    }
+
+    /**
+     * Try locking the mutex, waiting for the ownership for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return true, if the ownership could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking the mutex, waiting for the ownership until the given time point at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    template<class Clock, class Duration>
+    [[nodiscard]] bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) {
+        return timed_lock(futex::to_deadline(deadline));
+    }
+
+    /**
+     * Unlock the mutex
+     */
+    void unlock() {
+        if (_stats.recording() || _stats.tracing()) {
+            const futex::clock::duration locked_at(_locked_at.load(std::memory_order_relaxed));
+            _stats.released(futex::clock::now() - futex::clock::time_point(locked_at));
+        }
+
+        // Clear the ownership first, another thread may acquire the mutex right after releasing it
+        _locked = false;
+        _backend.unlock();
+    }
+
+    /**
+     * Lock the mutex in shared mode. Multiple owners may hold the mutex in shared mode at the same time.
+     */
+    void lock_shared() {
+        (void) timed_lock_shared(futex::clock::time_point::max());
+    }
+
+    /**
+     * Try locking the mutex in shared mode
+     *
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock_shared() {
+        static_assert(Backend::supports_shared, "The backend doesn't support shared ownership");
+        if (try_acquire(true)) return true;
+
+        _stats.try_lock_failed();
+        return false;
+    }
+
+    /**
+     * Try locking the mutex without waiting. Unlike try_lock(),
+     * failures are not counted in the statistics.
+     *
+     * @param shared whether to lock the mutex in shared mode
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_acquire(bool shared) {
+        if constexpr (Backend::supports_shared) {
+            if (shared) {
+                if (!_backend.try_lock_shared()) return false;
+
+                record_locked_shared();
+                return true;
+            }
+        } else if (shared) {
+            throw shared_mutex_exception("The backend doesn't support shared ownership");
+        }
+
+        if (!_backend.try_lock()) return false;
+
+        record_locked();
+        return true;
+    }
+
+    /**
+     * Try locking the mutex in shared mode, waiting for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return true, if the shared ownership could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock_shared(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking the mutex in shared mode, waiting until the given time point at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the shared ownership could be acquired
+     */
+    template<class Clock, class Duration>
+    [[nodiscard]] bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline) {
+        return timed_lock_shared(futex::to_deadline(deadline));
+    }
+
+    /**
+     * Unlock the mutex from shared mode
+     */
+    void unlock_shared() {
+        static_assert(Backend::supports_shared, "The backend doesn't support shared ownership");
+        uint32_t held = _shared_locks.load(std::memory_order_relaxed);
+        while (held > 0 && !_shared_locks.compare_exchange_weak(held, held - 1, std::memory_order_relaxed)) {}
+
+        _backend.unlock_shared();
+    }
+
+    /**
+     * Lock the mutex, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) {
+        if (!_backend.try_lock()) {
+            typename StatsPolicy::wait_scope wait(&_stats);
+            if (!_backend.lock_slow(_wait_policy, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        record_locked();
+        return true;
+    }
+
+    /**
+     * Lock the mutex in shared mode, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] bool timed_lock_shared(futex::clock::time_point deadline) {
+        static_assert(Backend::supports_shared, "The backend doesn't support shared ownership");
+        if (!_backend.try_lock_shared()) {
+            typename StatsPolicy::wait_scope wait(&_stats);
+            if (!_backend.lock_shared_slow(_wait_policy, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        record_locked_shared();
+        return true;
+    }
+
+    /**
+     * Check whether this instance owns the mutex exclusively
+     *
+     * @return true if this instance locked the mutex
+     */
+    [[nodiscard]] bool locked() const noexcept {
+        return _locked;
+    }
+
+    /**
+     * Get the number of contended acquisitions which
+     * succeeded while spinning, yielding and waiting in the kernel
+     *
+     * @return the wait phase statistics
+     */
+    [[nodiscard]] wait_phase_stats wait_stats() const noexcept {
+        return _wait_policy.stats();
+    }
+
+    /**
+     * Get the contention statistics of the mutex, summed up over all processes using it
+     *
+     * @return the contention statistics, all zero if the stats policy or the options record nothing
+     */
+    [[nodiscard]] mutex_stats stats() const noexcept {
+        return _stats.snapshot();
+    }
+
+    /**
+     * Get the mutex name
+     *
+     * @return the name of the mutex
+     */
+    [[nodiscard]] const std::string &name() const noexcept {
+        return _name;
+    }
+
+    /**
+     * Delete the instance. Releases the locks still held by this instance,
+     * the shared memory segment is deleted once the last instance using it is destroyed.
+     */
+    ~basic_shared_mutex() {
+        if (_locked) unlock();
+
+        if constexpr (Backend::supports_shared) {
+            while (_shared_locks.load() > 0) unlock_shared();
+        }
+    }
+
+private:
+    /**
+     * Create the wait policy. Policies without options are default constructed.
+     *
+     * @param options the wait policy options
+     * @return the wait policy
+     */
+    static WaitPolicy make_wait_policy(const wait_policy_options &options) {
+        if constexpr (std::is_constructible_v<WaitPolicy, const wait_policy_options &>) {
+            return WaitPolicy(options);
+        } else {
+            (void) options;
+            return WaitPolicy();
+        }
+    }
+
+    /**
+     * Record that the mutex was locked exclusively
+     */
+    void record_locked() noexcept {
+        _locked = true;
+        _stats.acquired();
+        if (_stats.recording()) {
+            _locked_at.store(futex::clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Record that the mutex was locked in shared mode
+     */
+    void record_locked_shared() noexcept {
+        _shared_locks.fetch_add(1, std::memory_order_relaxed);
+        _stats.acquired(true);
+    }
+
+    // The mutex name
+    const std::string _name;
+    // The lock word algorithm
+    Backend _backend;
+    // How to wait for the mutex if it is contended
+    WaitPolicy _wait_policy;
+    // The contention statistics
+    StatsPolicy _stats;
+    // Whether this instance owns the mutex exclusively. Set by the thread which acquired
+    // the mutex and cleared by the unlocking thread before releasing it.
+    std::atomic<bool> _locked;
+    // The number of shared locks held by this instance, changed by all threads using this instance
+    std::atomic<uint32_t> _shared_locks;
+    // The clock ticks the mutex was locked exclusively at, set by the thread which acquired the mutex
+    std::atomic<futex::clock::rep> _locked_at;
+};
+
+#ifdef OS_LINUX
+
+/**
+ * A futex based mutex which never spins and records no statistics.
+ * Uncontended operations are a single atomic operation.
+ */
+using static_futex_mutex = basic_shared_mutex<futex_mutex_backend, park_wait_policy, no_mutex_stats>;
+
+#endif //OS_LINUX
+
+/**
+ * A fair ticket lock which never spins and records no statistics
+ */
+using static_fair_mutex = basic_shared_mutex<fair_mutex_backend, park_wait_policy, no_mutex_stats>;
+
+#endif //SHARED_MUTEX_BASIC_SHARED_MUTEX_HPP
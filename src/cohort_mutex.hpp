@@ -0,0 +1,400 @@
+#ifndef SHARED_MUTEX_COHORT_MUTEX_HPP
+#define SHARED_MUTEX_COHORT_MUTEX_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "handle_registry.hpp"
+#include "shared_mutex.hpp"
+
+/**
+ * Options for creating a cohort_mutex
+ */
+struct cohort_mutex_options {
+    // The options of the cross-process mutex
+    shared_mutex_options global;
+    // The max number of times the cross-process mutex is passed on
+    // to a waiter in this process before it is released
+    uint32_t max_handoffs = 64;
+};
+
+/**
+ * The number of cross-process acquisitions and local handoffs of a cohort
+ */
+struct cohort_stats {
+    // The number of times this process acquired the cross-process mutex
+    uint64_t global_acquisitions = 0;
+    // The number of times the cross-process mutex was passed on to another waiter in this process
+    uint64_t local_handoffs = 0;
+};
+
+/**
+ * A two-level lock. All instances of a cohort_mutex in a process, including
+ * the ones in other threads, share a cohort. Threads of a cohort first
+ * acquire an in-process lock, only its owner acquires the cross-process
+ * shared_mutex. While other threads of the cohort are waiting, the owner
+ * keeps the shared_mutex and only releases the in-process lock, up to
+ * max_handoffs times in a row. Other processes may use a plain shared_mutex
+ * with the same name and backend.
+ */
+class cohort_mutex {
+public:
+    /**
+     * Open the cohort of a mutex in this process or create it
+     *
+     * @param name the name of the mutex
+     * @param options the mutex options, only used by the first instance in this process
+     */
+    explicit cohort_mutex(const std::string &name, const cohort_mutex_options &options = {}) : _locked(false) {
+        _cohort = handle_registry<cohort>::instance().acquire(name, true, [&] {
+            return std::make_unique<cohort>(name, options);
+        });
+    }
+
+    /**
+     * No copy constructor
+     */
+    cohort_mutex(const cohort_mutex &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    cohort_mutex &operator=(const cohort_mutex &) = delete;
+
+    /**
+     * Lock the mutex. Blocking call.
+     */
+    void lock() {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    /**
+     * Lock the mutex, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) {
+        if (!try_lock_local(false) && !lock_local_slow(deadline)) return false;
+
+        if (!_cohort->global_held) {
+            bool acquired;
+            try {
+                acquired = _cohort->global->timed_lock(deadline);
+            } catch (...) {
+                unlock_local();
+                throw;
+            }
+
+            if (!acquired) {
+                unlock_local();
+                return false;
+            }
+
+            acquired_global();
+        }
+
+        _locked = true;
+        return true;
+    }
+
+    /**
+     * Try locking the mutex, waiting for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return true, if the ownership could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking the mutex
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock() {
+        if (!try_lock_local(false)) return false;
+
+        if (!try_lock_global(false)) {
+            unlock_local();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Unlock the mutex. Passes the cross-process mutex on
+     * to the next thread of this process, if one is waiting.
+     */
+    void unlock() {
+        _locked = false;
+        release_global(false);
+        unlock_local();
+    }
+
+    /**
+     * Try acquiring the in-process lock without blocking
+     *
+     * @param waited whether the caller waited on the target set by prepare_local_wait() before
+     * @return true, if the in-process lock could be acquired
+     */
+    [[nodiscard]] bool try_lock_local(bool waited) noexcept {
+        // After waiting, we don't know if there are other waiters, keep the contended state
+        uint32_t state = unlocked;
+        return _cohort->word.compare_exchange_strong(state, waited ? contended : locked, std::memory_order_acquire,
+                                                     std::memory_order_relaxed);
+    }
+
+    /**
+     * Prepare waiting for the in-process lock. Registers the caller
+     * as a waiter, leave_local_wait() must be called once it stopped waiting.
+     *
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the in-process lock word
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_local_wait(bool &registered, futex_target &target) noexcept {
+        if (!registered) {
+            _cohort->waiters.fetch_add(1, std::memory_order_seq_cst);
+            registered = true;
+        }
+
+        uint32_t state = _cohort->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state == unlocked) {
+                return wait_preparation::retry;
+            } else if (state == contended ||
+                       _cohort->word.compare_exchange_weak(state, contended, std::memory_order_relaxed)) {
+                target.word = &_cohort->word;
+                target.expected = contended;
+                return wait_preparation::wait;
+            }
+        }
+    }
+
+    /**
+     * Stop waiting for the in-process lock
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     * @param acquired whether the caller acquired the in-process lock
+     */
+    void leave_local_wait(bool &registered, bool acquired) noexcept {
+        if (!registered) return;
+
+        _cohort->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        registered = false;
+        if (acquired) return;
+
+        // The cross-process mutex may have been kept for this waiter, release it if nobody else takes it
+        if (try_lock_local(false)) {
+            try {
+                release_global(true);
+            } catch (...) {
+                // The cross-process mutex could not be unlocked, there is nothing else to do
+            }
+
+            unlock_local();
+        } else {
+            // This waiter may have consumed the wake up of another waiter, pass it on
+            futex::wake(_cohort->word, 1);
+        }
+    }
+
+    /**
+     * Acquire the cross-process mutex after the in-process lock was acquired.
+     * Does nothing if the cohort already owns the cross-process mutex.
+     *
+     * @param waited whether the caller waited on the target set by prepare_global_wait() before
+     * @return true, if this instance now owns the mutex
+     */
+    [[nodiscard]] bool try_lock_global(bool waited) {
+        if (!_cohort->global_held) {
+            shared_mutex &global = *_cohort->global;
+            if (!(waited ? global.try_lock_after_wait(false) : global.try_acquire(false))) return false;
+
+            acquired_global();
+        }
+
+        _locked = true;
+        return true;
+    }
+
+    /**
+     * Prepare waiting for the cross-process mutex
+     *
+     * @param target set to the futex word to wait on
+     * @return whether to wait on the target, retry immediately or poll
+     */
+    [[nodiscard]] wait_preparation prepare_global_wait(futex_target &target) {
+        return _cohort->global->prepare_wait(false, target);
+    }
+
+    /**
+     * Stop waiting for the cross-process mutex after prepare_global_wait() was called
+     */
+    void abandon_global_wait() {
+        _cohort->global->abandon_wait(false);
+    }
+
+    /**
+     * Release the in-process lock
+     */
+    void unlock_local() noexcept {
+        if (_cohort->word.exchange(unlocked, std::memory_order_release) == contended) {
+            futex::wake(_cohort->word, 1);
+        }
+    }
+
+    /**
+     * Get the number of cross-process acquisitions and local handoffs of the cohort in this process
+     *
+     * @return the cohort statistics
+     */
+    [[nodiscard]] cohort_stats stats() const noexcept {
+        cohort_stats stats;
+        stats.global_acquisitions = _cohort->global_acquisitions.load(std::memory_order_relaxed);
+        stats.local_handoffs = _cohort->local_handoffs.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    /**
+     * Get the cross-process mutex
+     *
+     * @return the shared_mutex of the cohort
+     */
+    [[nodiscard]] shared_mutex &global() const noexcept {
+        return *_cohort->global;
+    }
+
+    /**
+     * Delete the instance. Unlocks the mutex, if this instance owns it.
+     */
+    ~cohort_mutex() {
+        if (_locked) unlock();
+    }
+
+private:
+    // The in-process lock is not locked
+    static constexpr uint32_t unlocked = 0;
+    // The in-process lock is locked without waiters
+    static constexpr uint32_t locked = 1;
+    // The in-process lock is locked and there may be waiters
+    static constexpr uint32_t contended = 2;
+
+    /**
+     * The state shared by all instances of a mutex in this process
+     */
+    class cohort {
+    public:
+        /**
+         * Create a cohort
+         *
+         * @param name the name of the mutex
+         * @param options the mutex options
+         */
+        cohort(const std::string &name, const cohort_mutex_options &options)
+                : global(shared_mutex::createShared_mutex(name, true, options.global)),
+                  max_handoffs(options.max_handoffs), word(unlocked), waiters(0), global_held(false),
+                  handoffs(0), global_acquisitions(0), local_handoffs(0) {
+            // The cross-process mutex is passed on between threads
+            if (global->thread_owned()) {
+                throw shared_mutex_exception("Cohort mutexes can't use a mutex owned by threads");
+            }
+        }
+
+        /**
+         * Nothing to remove, the cross-process mutex removes its own name
+         */
+        void unlink() noexcept {}
+
+        // The cross-process mutex
+        const std::unique_ptr<shared_mutex> global;
+        // The max number of handoffs in a row
+        const uint32_t max_handoffs;
+        // The in-process lock word
+        std::atomic<uint32_t> word;
+        // The number of threads and operations waiting for the in-process lock
+        std::atomic<uint32_t> waiters;
+        // Whether the cohort owns the cross-process mutex, guarded by the in-process lock
+        bool global_held;
+        // The number of handoffs since the cross-process mutex was acquired, guarded by the in-process lock
+        uint32_t handoffs;
+        // The number of cross-process acquisitions
+        std::atomic<uint64_t> global_acquisitions;
+        // The number of local handoffs
+        std::atomic<uint64_t> local_handoffs;
+    };
+
+    /**
+     * Wait for the in-process lock
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the in-process lock could be acquired
+     */
+    bool lock_local_slow(futex::clock::time_point deadline) {
+        bool registered = false;
+        for (;;) {
+            futex_target target;
+            if (prepare_local_wait(registered, target) == wait_preparation::wait &&
+                !futex::wait_until(_cohort->word, contended, deadline)) {
+                const bool acquired = try_lock_local(true);
+                leave_local_wait(registered, acquired);
+                return acquired;
+            }
+
+            if (try_lock_local(true)) {
+                leave_local_wait(registered, true);
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Record that the cohort acquired the cross-process mutex. The in-process lock must be held.
+     */
+    void acquired_global() noexcept {
+        _cohort->global_held = true;
+        _cohort->handoffs = 0;
+        _cohort->global_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Release the cross-process mutex, unless another thread of this
+     * process is waiting for it. The in-process lock must be held.
+     *
+     * @param abandoned whether the cross-process mutex is released because a waiter gave up
+     */
+    void release_global(bool abandoned) {
+        if (!_cohort->global_held) return;
+
+        if (_cohort->waiters.load(std::memory_order_seq_cst) > 0 && _cohort->handoffs < _cohort->max_handoffs) {
+            // Keep the cross-process mutex for the next waiter in this process
+            if (!abandoned) {
+                _cohort->handoffs++;
+                _cohort->local_handoffs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            return;
+        }
+
+        _cohort->global_held = false;
+        _cohort->handoffs = 0;
+        _cohort->global->unlock();
+    }
+
+    // The cohort of this mutex in this process
+    std::shared_ptr<cohort> _cohort;
+    // Whether this instance owns the mutex
+    bool _locked;
+};
+
+#endif //SHARED_MUTEX_COHORT_MUTEX_HPP
@@ -0,0 +1,280 @@
+#ifndef SHARED_MUTEX_FUTEX_HPP
+#define SHARED_MUTEX_FUTEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <climits>
+#include <thread>
+#include <type_traits>
+
+#include "platform.hpp"
+
+#ifdef OS_LINUX
+#   include <linux/futex.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   include <ctime>
+#   include <cerrno>
+#endif
+
+#if defined(OS_LINUX) && !defined(SYS_futex_waitv)
+#   define SYS_futex_waitv 449
+#endif
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "std::atomic<uint32_t> must be a plain lock-free 32 bit word to be placed in shared memory");
+
+/**
+ * A futex word to wait on
+ */
+struct futex_target {
+    // The word to wait on
+    std::atomic<uint32_t> *word = nullptr;
+    // The value the word is expected to contain
+    uint32_t expected = 0;
+    // The time point to check the state of the word again at, even if it wasn't woken up
+    std::chrono::steady_clock::time_point recheck = std::chrono::steady_clock::time_point::max();
+};
+
+/**
+ * The result of preparing to wait for an object without blocking a thread
+ */
+enum class wait_preparation {
+    // The object has no futex word to wait on, it must be polled
+    unsupported,
+    // The object changed its state, waiting should be retried immediately
+    retry,
+    // Wait on the futex target
+    wait
+};
+
+/**
+ * Wait and wake operations on a 32 bit word in shared memory.
+ * Uses futex(2) on linux. Other systems do not have a
+ * cross-process futex, waits will sleep for a short time instead.
+ */
+class futex {
+public:
+    // The clock used for timeouts
+    using clock = std::chrono::steady_clock;
+
+    // A bitset matching every waiter
+    static constexpr uint32_t match_any = 0xffffffffu;
+
+    /**
+     * Get the deadline of a timeout starting now. The addition saturates, timeouts
+     * too large to be represented wait forever. NaN timeouts don't wait at all.
+     *
+     * @param timeout the max time to wait for
+     * @return the deadline, clock::time_point::max() if the timeout is too large
+     */
+    template<class Rep, class Period>
+    static clock::time_point deadline_after(const std::chrono::duration<Rep, Period> &timeout) {
+        const clock::time_point now = clock::now();
+        const clock::duration duration = saturate(timeout);
+        if (duration <= clock::duration::zero()) return now;
+        if (duration >= clock::time_point::max() - now) return clock::time_point::max();
+
+        return now + duration;
+    }
+
+    /**
+     * Convert a time point of any clock to a deadline of the futex clock.
+     * Saturates at clock::time_point::max(), like deadline_after().
+     *
+     * @param time the time point to convert
+     * @return the deadline
+     */
+    template<class Clock, class Duration>
+    static clock::time_point to_deadline(const std::chrono::time_point<Clock, Duration> &time) {
+        if constexpr (std::is_same_v<Clock, clock>) {
+            return clock::time_point(saturate(time.time_since_epoch()));
+        } else {
+            if (time == std::chrono::time_point<Clock, Duration>::max()) return clock::time_point::max();
+
+            // Subtract in floating point, the difference may not be representable in either duration
+            using wide = std::chrono::duration<long double, clock::period>;
+            return deadline_after(wide(time.time_since_epoch()) - wide(Clock::now().time_since_epoch()));
+        }
+    }
+
+    /**
+     * Wait until the word is woken up, as long as it still contains the expected value.
+     * May return spuriously, callers must re-check their condition.
+     *
+     * @param word the word to wait on
+     * @param expected the value the word is expected to contain
+     * @param bitset the bitset of this waiter, only wakes with an intersecting bitset will wake it up
+     */
+    static void wait(std::atomic<uint32_t> &word, uint32_t expected, uint32_t bitset = match_any) {
+#ifdef OS_LINUX
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_BITSET, expected, nullptr, nullptr,
+                bitset);
+#else
+        (void) bitset;
+        if (word.load(std::memory_order_relaxed) == expected) {
+            std::this_thread::sleep_for(poll_interval);
+        }
+#endif //OS_LINUX
+    }
+
+    /**
+     * Wait until the word is woken up or the deadline is reached,
+     * as long as it still contains the expected value.
+     * May return spuriously, callers must re-check their condition.
+     *
+     * @param word the word to wait on
+     * @param expected the value the word is expected to contain
+     * @param deadline the time point to wait until, clock::time_point::max() to wait without a timeout
+     * @param bitset the bitset of this waiter, only wakes with an intersecting bitset will wake it up
+     * @return false if the deadline has been reached
+     */
+    static bool wait_until(std::atomic<uint32_t> &word, uint32_t expected, clock::time_point deadline,
+                           uint32_t bitset = match_any) {
+        // The max time point is used to wait without a timeout
+        if (deadline == clock::time_point::max()) {
+            wait(word, expected, bitset);
+            return true;
+        }
+
+#ifdef OS_LINUX
+        // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout, which is what steady_clock uses
+        const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+        if (since_epoch.count() <= 0) return clock::now() < deadline;
+
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+
+        if (syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_BITSET, expected, &ts, nullptr,
+                    bitset) == -1 && errno == ETIMEDOUT) {
+            return false;
+        }
+
+        return true;
+#else
+        (void) bitset;
+        const auto now = clock::now();
+        if (now >= deadline) return false;
+
+        if (word.load(std::memory_order_relaxed) == expected) {
+            std::this_thread::sleep_for(std::min<clock::duration>(poll_interval, deadline - now));
+        }
+
+        return clock::now() < deadline;
+#endif //OS_LINUX
+    }
+
+    /**
+     * Wait until any of the words is woken up or the deadline is reached,
+     * as long as all words still contain their expected values.
+     * Uses futex_waitv(2), which is available since linux 5.16.
+     * May return spuriously, callers must re-check their conditions.
+     *
+     * @param targets the words to wait on
+     * @param count the number of words, at most max_wait_any
+     * @param deadline the time point to wait until, clock::time_point::max() to wait without a timeout
+     * @return false if waiting on multiple words is not supported
+     */
+    static bool wait_any(const futex_target *targets, size_t count, clock::time_point deadline) {
+#ifdef OS_LINUX
+        static std::atomic<bool> supported(true);
+        if (count > max_wait_any || !supported.load(std::memory_order_relaxed)) return false;
+
+        // The layout of struct futex_waitv
+        struct waitv {
+            uint64_t val;
+            uint64_t uaddr;
+            uint32_t flags;
+            uint32_t reserved;
+        } waiters[max_wait_any];
+
+        for (size_t i = 0; i < count; i++) {
+            waiters[i].val = targets[i].expected;
+            waiters[i].uaddr = reinterpret_cast<uintptr_t>(targets[i].word);
+            waiters[i].flags = futex2_size_u32;
+            waiters[i].reserved = 0;
+        }
+
+        timespec ts{};
+        if (deadline != clock::time_point::max()) {
+            const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    deadline.time_since_epoch());
+            if (since_epoch.count() <= 0) return true;
+
+            ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+        }
+
+        if (syscall(SYS_futex_waitv, waiters, count, 0, deadline == clock::time_point::max() ? nullptr : &ts,
+                    CLOCK_MONOTONIC) == -1 && errno == ENOSYS) {
+            supported.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+#else
+        (void) targets;
+        (void) count;
+        (void) deadline;
+        return false;
+#endif //OS_LINUX
+    }
+
+    /**
+     * Wake up waiters on a word
+     *
+     * @param word the word to wake up
+     * @param count the max number of waiters to wake up
+     * @param bitset only waiters with an intersecting bitset are woken up
+     * @return the number of woken up waiters, if known
+     */
+    static int wake(std::atomic<uint32_t> &word, int count = INT_MAX, uint32_t bitset = match_any) {
+#ifdef OS_LINUX
+        const long res = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_BITSET, count, nullptr,
+                                 nullptr, bitset);
+        return res < 0 ? 0 : static_cast<int>(res);
+#else
+        (void) word;
+        (void) count;
+        (void) bitset;
+        return 0;
+#endif //OS_LINUX
+    }
+
+    // The max number of words wait_any() can wait on
+    static constexpr size_t max_wait_any = 128;
+
+private:
+    /**
+     * Convert a duration to the clock duration, rounding up and clamping to its range
+     *
+     * @param duration the duration to convert
+     * @return the converted duration, zero if it is NaN
+     */
+    template<class Rep, class Period>
+    static clock::duration saturate(const std::chrono::duration<Rep, Period> &duration) {
+        const std::chrono::duration<long double, clock::period> value(duration);
+        if (value != value) return clock::duration::zero();
+        if (value >= std::chrono::duration<long double, clock::period>(clock::duration::max())) {
+            return clock::duration::max();
+        }
+        if (value <= std::chrono::duration<long double, clock::period>(clock::duration::min())) {
+            return clock::duration::min();
+        }
+
+        return std::chrono::ceil<clock::duration>(value);
+    }
+
+#ifdef OS_LINUX
+    // FUTEX2_SIZE_U32, the futex_waitv flag for 32 bit words
+    static constexpr uint32_t futex2_size_u32 = 0x02;
+#else
+    // The time to sleep per wait if there is no futex available
+    static constexpr std::chrono::microseconds poll_interval{200};
+#endif //OS_LINUX
+};
+
+#endif //SHARED_MUTEX_FUTEX_HPP
@@ -0,0 +1,145 @@
+#ifndef SHARED_MUTEX_HANDLE_REGISTRY_HPP
+#define SHARED_MUTEX_HANDLE_REGISTRY_HPP
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * A hash map split into shards with their own lock,
+ * so threads using different keys rarely contend
+ *
+ * @tparam Value the type of the values
+ */
+template<class Value>
+class sharded_map {
+public:
+    /**
+     * Call a function with the entries of the shard a key belongs to.
+     * The shard is locked while the function runs.
+     *
+     * @param key the key
+     * @param fn the function to call with the entries of the shard
+     * @return the return value of the function
+     */
+    template<class Fn>
+    decltype(auto) with_shard(const std::string &key, Fn &&fn) {
+        shard &s = _shards[std::hash<std::string>()(key) % shard_count];
+        std::unique_lock<std::mutex> lock(s.mutex);
+        return fn(s.entries);
+    }
+
+private:
+    // The number of shards
+    static constexpr size_t shard_count = 16;
+
+    /**
+     * A part of the map
+     */
+    struct shard {
+        // The mutex guarding the entries
+        std::mutex mutex;
+        // The entries of the shard
+        std::unordered_map<std::string, Value> entries;
+    };
+
+    // The shards
+    std::array<shard, shard_count> _shards;
+};
+
+/**
+ * Caches the handles of named OS objects, like semaphores or shared
+ * memory segments, so every name is only opened once per process.
+ * Handles are refcounted, the object is closed and its name removed
+ * once the last reference in this process goes away.
+ *
+ * The handle type must have a noexcept unlink() method removing the name.
+ *
+ * @tparam T the type of the handles
+ */
+template<class T>
+class handle_registry {
+public:
+    /**
+     * Get the registry of this process
+     *
+     * @return the registry instance
+     */
+    static handle_registry &instance() {
+        // Never destroyed, handles may still be released during static destruction
+        static auto *registry = new handle_registry();
+        return *registry;
+    }
+
+    /**
+     * Get the open handle of a name or open a new one
+     *
+     * @param name the name of the object
+     * @param reuse whether to reuse a handle which is already open, if false a new handle is always opened
+     * @param open the function opening the handle, returning a std::unique_ptr<T>
+     * @return the handle
+     */
+    template<class Open>
+    std::shared_ptr<T> acquire(const std::string &name, bool reuse, Open &&open) {
+        return _entries.with_shard(name, [&](std::unordered_map<std::string, entry> &entries) {
+            auto it = entries.find(name);
+            if (reuse && it != entries.end()) {
+                if (std::shared_ptr<T> handle = it->second.handle.lock()) {
+                    return handle;
+                }
+            }
+
+            std::unique_ptr<T> opened = open();
+            std::shared_ptr<T> handle(opened.get(), [name](T *h) {
+                handle_registry::instance().release(name, h);
+            });
+            opened.release();
+
+            if (it == entries.end() || it->second.handle.expired()) {
+                entries[name] = entry{handle.get(), handle};
+            }
+
+            return handle;
+        });
+    }
+
+private:
+    /**
+     * A cached handle
+     */
+    struct entry {
+        // The handle, used to identify it once it expired
+        T *raw;
+        // The reference to the handle
+        std::weak_ptr<T> handle;
+    };
+
+    /**
+     * Release a handle once its last reference went away.
+     * Removes the name, unless a newer handle to the name is open.
+     *
+     * @param name the name of the object
+     * @param handle the handle to release
+     */
+    void release(const std::string &name, T *handle) noexcept {
+        _entries.with_shard(name, [&](std::unordered_map<std::string, entry> &entries) {
+            // The name must be removed before it may be opened again
+            auto it = entries.find(name);
+            if (it == entries.end() || it->second.raw == handle) {
+                if (it != entries.end()) entries.erase(it);
+                handle->unlink();
+            }
+        });
+
+        delete handle;
+    }
+
+    // The cached handles
+    sharded_map<entry> _entries;
+};
+
+#endif //SHARED_MUTEX_HANDLE_REGISTRY_HPP
@@ -0,0 +1,658 @@
+#ifndef SHARED_MUTEX_INSTANCE_LOCK_HPP
+#define SHARED_MUTEX_INSTANCE_LOCK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_mutex_exception.hpp"
+
+#ifdef OS_UNIX
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <poll.h>
+#   include <sys/file.h>
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#   ifndef PERM
+#       define PERM 0600
+#   endif
+#endif //OS_UNIX
+
+/**
+ * A lock making sure only one instance of a program is running. The lock is
+ * an flock()ed file, which the kernel releases once the owning process exits
+ * or crashes. The lock file itself is never deleted, a file left behind by a
+ * crashed instance is simply locked again by the next one.
+ *
+ * The owner may receive the arguments of instances started while it is
+ * running. It listens on a unix socket, which is only bound while the lock
+ * is held, so a crashed owner never leaves a socket blocking the next one.
+ * Both the lock file and the socket are private to the user, connections of
+ * other users are dropped. Only available on unix systems.
+ */
+class instance_lock {
+public:
+    // The max size of the arguments forwarded by another instance in bytes
+    static constexpr uint32_t max_message_size = 1u << 20u;
+
+    /**
+     * Acquire the lock of an instance
+     *
+     * @param name the name of the program
+     * @param receive_args whether to receive the arguments forwarded by other instances
+     */
+    instance_lock(const std::string &name, bool receive_args) : _name(name), _sequence(0), _receiving(false) {
+#ifdef OS_UNIX
+        check_name(name);
+        _lock_fd = open_lock_file(name);
+
+        // flock() locks belong to the open file description, so this also fails within the same process
+        if (flock(_lock_fd, LOCK_EX | LOCK_NB) != 0) {
+            close(_lock_fd);
+            throw shared_mutex_exception("A mutex with the name '" + name + "' is already owned by another program");
+        }
+
+        if (receive_args) {
+            try {
+                listen_for_args();
+            } catch (...) {
+                close(_lock_fd);
+                throw;
+            }
+        }
+#else
+        (void) receive_args;
+        throw shared_mutex_exception("The lock_file backend is only supported on unix systems");
+#endif //OS_UNIX
+    }
+
+    /**
+     * No copy constructor
+     */
+    instance_lock(const instance_lock &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    instance_lock &operator=(const instance_lock &) = delete;
+
+    /**
+     * Forward arguments to the running instance of a program
+     *
+     * @param name the name of the program
+     * @param args the arguments to forward
+     * @param timeout the max time to wait for the running instance to receive the arguments
+     * @return false, if no instance is running or it doesn't receive arguments
+     */
+    static bool forward(const std::string &name, const std::vector<std::string> &args,
+                        std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+#ifdef OS_UNIX
+        check_name(name);
+        const std::string message = encode(args);
+
+        sockaddr_un address{};
+        const socklen_t length = socket_address(name, address);
+        const int fd = open_socket();
+        if (fd < 0) {
+            throw shared_mutex_exception(std::string("Could not create a socket: ") + std::strerror(errno));
+        }
+
+        set_timeout(fd, timeout);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), length) != 0) {
+            const int error = errno;
+            close(fd);
+            if (error == ECONNREFUSED || error == ENOENT) return false;
+
+            throw shared_mutex_exception("Could not connect to the instance of '" + name + "': " +
+                                         std::strerror(error));
+        }
+
+        // Never hand the arguments to a program of another user
+        if (!same_user(fd)) {
+            close(fd);
+            return false;
+        }
+
+        // The running instance acknowledges the arguments with a single byte
+        char ack = 0;
+        const bool received = write_all(fd, message.data(), message.size()) && read_all(fd, &ack, 1);
+        close(fd);
+        return received;
+#else
+        (void) name;
+        (void) args;
+        (void) timeout;
+        throw shared_mutex_exception("The lock_file backend is only supported on unix systems");
+#endif //OS_UNIX
+    }
+
+    /**
+     * Take the arguments forwarded by another instance without blocking
+     *
+     * @param args set to the forwarded arguments
+     * @return false, if no arguments were forwarded since the last call
+     */
+    [[nodiscard]] bool try_receive(std::vector<std::string> &args) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_received.empty()) return false;
+
+        args = std::move(_received.front());
+        _received.pop_front();
+        return true;
+    }
+
+    /**
+     * Wait for another instance to forward its arguments. Blocking call.
+     *
+     * @return the forwarded arguments
+     */
+    std::vector<std::string> receive() {
+        std::vector<std::string> args;
+        futex_target target;
+        while (!try_receive(args)) {
+            check_receiving();
+            if (prepare_wait(target) == wait_preparation::wait) {
+                futex::wait(*target.word, target.expected);
+            }
+        }
+
+        return args;
+    }
+
+    /**
+     * Prepare waiting for forwarded arguments after try_receive() returned false
+     *
+     * @param target set to the word incremented every time arguments are received
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) noexcept {
+        target.word = &_sequence;
+        target.expected = _sequence.load(std::memory_order_acquire);
+        if (!receiving()) return wait_preparation::retry;
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _received.empty() ? wait_preparation::wait : wait_preparation::retry;
+    }
+
+    /**
+     * Check whether this instance receives the arguments forwarded by other instances
+     *
+     * @return true, if arguments are received
+     */
+    [[nodiscard]] bool receiving() const noexcept {
+        return _receiving.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Throw an exception if this instance doesn't receive forwarded arguments
+     */
+    void check_receiving() const {
+        if (!receiving()) {
+            throw shared_mutex_exception("The instance lock of '" + _name + "' doesn't receive arguments");
+        }
+    }
+
+    /**
+     * Put arguments taken by try_receive() back, if they can't be handled anymore
+     *
+     * @param args the arguments
+     */
+    void requeue(std::vector<std::string> args) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _received.push_front(std::move(args));
+        }
+
+        notify();
+    }
+
+    /**
+     * Release the lock and stop receiving arguments. The lock file is kept.
+     * Threads waiting in receive() are woken up and throw an exception.
+     */
+    void release() noexcept {
+#ifdef OS_UNIX
+        if (_lock_fd < 0) return;
+
+        if (_listener.joinable()) {
+            _receiving.store(false, std::memory_order_release);
+            const char stop = 0;
+            (void) !write(_stop_fds[1], &stop, 1);
+            _listener.join();
+
+            close(_listen_fd);
+            close(_stop_fds[0]);
+            close(_stop_fds[1]);
+#   ifndef OS_LINUX
+            unlink(socket_path(_name).c_str());
+#   endif //OS_LINUX
+            notify();
+        }
+
+        close(_lock_fd);
+        _lock_fd = -1;
+#endif //OS_UNIX
+    }
+
+    /**
+     * Release the lock
+     */
+    ~instance_lock() {
+        release();
+    }
+
+private:
+#ifdef OS_UNIX
+    // The time a connected instance has to send its arguments
+    static constexpr std::chrono::milliseconds receive_timeout{1000};
+
+    /**
+     * Check the name of a program, which is used as a file name
+     *
+     * @param name the name to check
+     */
+    static void check_name(const std::string &name) {
+        if (name.empty() || name.find('/') != std::string::npos) {
+            throw shared_mutex_exception("The name of an instance lock must not be empty or contain a '/'");
+        }
+    }
+
+    /**
+     * Get the directory lock files are stored in. Prefers the runtime directory,
+     * which is only accessible by the user, over the shared temporary directory.
+     *
+     * @return the value of XDG_RUNTIME_DIR, TMPDIR or /tmp
+     */
+    static std::string directory() {
+        const char *dir = std::getenv("XDG_RUNTIME_DIR");
+        if (dir == nullptr || *dir == '\0') dir = std::getenv("TMPDIR");
+
+        std::string res = dir != nullptr && *dir != '\0' ? dir : "/tmp";
+        if (res.back() != '/') res += '/';
+        return res;
+    }
+
+    /**
+     * Get the path of the lock file of a program
+     *
+     * @param name the name of the program
+     * @return the path
+     */
+    static std::string lock_path(const std::string &name) {
+        return directory() + "shared_mutex." + name + ".lock";
+    }
+
+    /**
+     * Open the lock file of a program. Doesn't follow symbolic links and only
+     * accepts a regular file owned by the user, so other users can't redirect
+     * the lock to another file or hold it in advance.
+     *
+     * @param name the name of the program
+     * @return the file descriptor of the lock file
+     */
+    static int open_lock_file(const std::string &name) {
+        const int fd = open(lock_path(name).c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, PERM);
+        if (fd < 0) {
+            throw shared_mutex_exception("Could not open the lock file of '" + name + "': " + std::strerror(errno));
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0) {
+            const int error = errno;
+            close(fd);
+            throw shared_mutex_exception("Could not open the lock file of '" + name + "': " + std::strerror(error));
+        }
+
+        if (!S_ISREG(info.st_mode) || info.st_uid != geteuid()) {
+            close(fd);
+            throw shared_mutex_exception("The lock file of '" + name +
+                                         "' is not a regular file owned by the current user");
+        }
+
+        return fd;
+    }
+
+    /**
+     * Get the path of the socket of a program
+     *
+     * @param name the name of the program
+     * @return the path
+     */
+    static std::string socket_path(const std::string &name) {
+        return directory() + "shared_mutex." + name + ".sock";
+    }
+
+    /**
+     * Get the address of the socket of a program. Uses the abstract namespace on
+     * linux, which disappears with the socket, and a path next to the lock file elsewhere.
+     * The abstract namespace is shared by all users, so the name contains the user id.
+     *
+     * @param name the name of the program
+     * @param address set to the address
+     * @return the length of the address
+     */
+    static socklen_t socket_address(const std::string &name, sockaddr_un &address) {
+        address.sun_family = AF_UNIX;
+#ifdef OS_LINUX
+        const std::string path = std::string(1, '\0') + "shared_mutex." + std::to_string(geteuid()) + '.' + name;
+#else
+        const std::string path = socket_path(name) + '\0';
+#endif //OS_LINUX
+        if (path.size() > sizeof(address.sun_path)) {
+            throw shared_mutex_exception("The name '" + name + "' is too long for the socket of an instance lock");
+        }
+
+        std::memcpy(address.sun_path, path.data(), path.size());
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+    }
+
+    /**
+     * Create a unix stream socket which isn't inherited by child processes
+     *
+     * @return the socket or -1 if it could not be created
+     */
+    static int open_socket() noexcept {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0) {
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+            // Systems without MSG_NOSIGNAL don't raise SIGPIPE for this socket
+            const int enable = 1;
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif //SO_NOSIGPIPE
+        }
+
+        return fd;
+    }
+
+    /**
+     * Check whether the other end of a connected socket runs as the same user
+     *
+     * @param fd the socket
+     * @return false, if the peer belongs to another user or could not be identified
+     */
+    static bool same_user(int fd) noexcept {
+#ifdef OS_LINUX
+        ucred credentials{};
+        socklen_t length = sizeof(credentials);
+        return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 &&
+               credentials.uid == geteuid();
+#else
+        uid_t uid;
+        gid_t gid;
+        return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#endif //OS_LINUX
+    }
+
+    /**
+     * Set the send and receive timeouts of a socket
+     *
+     * @param fd the socket
+     * @param timeout the timeout
+     */
+    static void set_timeout(int fd, std::chrono::milliseconds timeout) noexcept {
+        timeval tv{};
+        tv.tv_sec = static_cast<decltype(tv.tv_sec)>(timeout.count() / 1000);
+        tv.tv_usec = static_cast<decltype(tv.tv_usec)>((timeout.count() % 1000) * 1000);
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    /**
+     * Encode arguments as a message. Each argument is prefixed with its length,
+     * the message is prefixed with the number of arguments and the total size.
+     *
+     * @param args the arguments
+     * @return the message
+     */
+    static std::string encode(const std::vector<std::string> &args) {
+        std::string body;
+        append(body, static_cast<uint32_t>(args.size()));
+        for (const std::string &arg : args) {
+            if (arg.size() > max_message_size - body.size()) {
+                throw shared_mutex_exception("The forwarded arguments must not exceed " +
+                                             std::to_string(max_message_size) + " bytes");
+            }
+
+            append(body, static_cast<uint32_t>(arg.size()));
+            body += arg;
+        }
+
+        std::string message;
+        append(message, static_cast<uint32_t>(body.size()));
+        return message + body;
+    }
+
+    /**
+     * Decode the body of a message
+     *
+     * @param body the body
+     * @param args set to the arguments
+     * @return false, if the body is malformed
+     */
+    static bool decode(const std::string &body, std::vector<std::string> &args) {
+        size_t pos = 0;
+        uint32_t count;
+        if (!take(body, pos, count)) return false;
+
+        args.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t length;
+            if (!take(body, pos, length) || length > body.size() - pos) return false;
+
+            args.emplace_back(body, pos, length);
+            pos += length;
+        }
+
+        return pos == body.size();
+    }
+
+    /**
+     * Append a number to a message
+     *
+     * @param message the message
+     * @param value the number
+     */
+    static void append(std::string &message, uint32_t value) {
+        message.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    /**
+     * Take a number from a message
+     *
+     * @param message the message
+     * @param pos the position of the number, advanced past it
+     * @param value set to the number
+     * @return false, if the message is too short
+     */
+    static bool take(const std::string &message, size_t &pos, uint32_t &value) noexcept {
+        if (message.size() - pos < sizeof(value)) return false;
+
+        std::memcpy(&value, message.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    /**
+     * Write all bytes to a socket
+     *
+     * @param fd the socket
+     * @param data the data to write
+     * @param size the number of bytes to write
+     * @return false, if the socket failed or timed out
+     */
+    static bool write_all(int fd, const char *data, size_t size) noexcept {
+        while (size > 0) {
+            const ssize_t res = send(fd, data, size, send_flags);
+            if (res < 0 && errno == EINTR) continue;
+            if (res <= 0) return false;
+
+            data += res;
+            size -= static_cast<size_t>(res);
+        }
+
+        return true;
+    }
+
+    /**
+     * Read an exact number of bytes from a socket
+     *
+     * @param fd the socket
+     * @param data the buffer to read into
+     * @param size the number of bytes to read
+     * @return false, if the socket was closed, failed or timed out
+     */
+    static bool read_all(int fd, char *data, size_t size) noexcept {
+        while (size > 0) {
+            const ssize_t res = recv(fd, data, size, 0);
+            if (res < 0 && errno == EINTR) continue;
+            if (res <= 0) return false;
+
+            data += res;
+            size -= static_cast<size_t>(res);
+        }
+
+        return true;
+    }
+
+    /**
+     * Bind the socket and start the thread receiving forwarded arguments
+     */
+    void listen_for_args() {
+        sockaddr_un address{};
+        const socklen_t length = socket_address(_name, address);
+
+        if (pipe(_stop_fds) != 0) {
+            throw shared_mutex_exception(std::string("Could not create a pipe: ") + std::strerror(errno));
+        }
+
+        fcntl(_stop_fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(_stop_fds[1], F_SETFD, FD_CLOEXEC);
+        _listen_fd = open_socket();
+#ifndef OS_LINUX
+        // The lock is held, so a socket file left behind belongs to a crashed instance
+        unlink(socket_path(_name).c_str());
+#endif //OS_LINUX
+        if (_listen_fd < 0 || bind(_listen_fd, reinterpret_cast<sockaddr *>(&address), length) != 0 ||
+            listen(_listen_fd, SOMAXCONN) != 0) {
+            const int error = errno;
+            if (_listen_fd >= 0) close(_listen_fd);
+            close(_stop_fds[0]);
+            close(_stop_fds[1]);
+            throw shared_mutex_exception("Could not listen for the arguments of other instances of '" + _name +
+                                         "': " + std::strerror(error));
+        }
+
+        _receiving.store(true, std::memory_order_release);
+        _listener = std::thread(&instance_lock::run, this);
+    }
+
+    /**
+     * The thread accepting the connections of other instances
+     */
+    void run() {
+        pollfd fds[2] = {{_listen_fd, POLLIN, 0}, {_stop_fds[0], POLLIN, 0}};
+        for (;;) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+
+            if (fds[1].revents != 0) return;
+            if ((fds[0].revents & POLLIN) == 0) continue;
+
+            const int fd = accept(_listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+
+            // Drop the connections of other users
+            if (!same_user(fd)) {
+                close(fd);
+                continue;
+            }
+
+            set_timeout(fd, receive_timeout);
+            std::vector<std::string> args;
+            if (receive_message(fd, args)) {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _received.push_back(std::move(args));
+                }
+
+                notify();
+
+                const char ack = 1;
+                (void) write_all(fd, &ack, 1);
+            }
+
+            close(fd);
+        }
+    }
+
+    /**
+     * Read the message of a connected instance
+     *
+     * @param fd the connection
+     * @param args set to the arguments
+     * @return false, if the message is malformed or could not be read
+     */
+    static bool receive_message(int fd, std::vector<std::string> &args) {
+        uint32_t size;
+        if (!read_all(fd, reinterpret_cast<char *>(&size), sizeof(size)) || size > max_message_size) {
+            return false;
+        }
+
+        std::string body(size, '\0');
+        return read_all(fd, &body[0], size) && decode(body, args);
+    }
+
+#   ifdef MSG_NOSIGNAL
+    // Don't raise SIGPIPE if the other side closed the connection
+    static constexpr int send_flags = MSG_NOSIGNAL;
+#   else
+    static constexpr int send_flags = 0;
+#   endif //MSG_NOSIGNAL
+
+    // The locked file
+    int _lock_fd = -1;
+    // The socket other instances connect to
+    int _listen_fd = -1;
+    // The pipe used to stop the listener thread
+    int _stop_fds[2] = {-1, -1};
+#endif //OS_UNIX
+
+    /**
+     * Wake up the threads waiting for arguments
+     */
+    void notify() noexcept {
+        _sequence.fetch_add(1, std::memory_order_release);
+        futex::wake(_sequence);
+    }
+
+    // The name of the program
+    const std::string _name;
+    // Incremented every time arguments are received and once the lock is released
+    std::atomic<uint32_t> _sequence;
+    // Whether arguments are received
+    std::atomic<bool> _receiving;
+    // The mutex guarding the received arguments
+    std::mutex _mutex;
+    // The arguments received, but not taken yet
+    std::deque<std::vector<std::string>> _received;
+    // The thread receiving forwarded arguments
+    std::thread _listener;
+};
+
+#endif //SHARED_MUTEX_INSTANCE_LOCK_HPP
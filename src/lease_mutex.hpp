@@ -0,0 +1,340 @@
+#ifndef SHARED_MUTEX_LEASE_MUTEX_HPP
+#define SHARED_MUTEX_LEASE_MUTEX_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * A named mutex in a shared memory segment which is only held for a limited
+ * time. A lease expires unless its holder renews it, an expired lease may be
+ * taken over by any waiter, so a holder which hangs can't block the others forever.
+ *
+ * Every acquisition is assigned a fencing token, a 64-bit counter increasing
+ * with every lease. A holder which lost its lease still holds a token smaller
+ * than the one of the current holder, so resources which remember the highest
+ * token they've seen can reject its stale writes.
+ *
+ * Expiry times are stored as time points of the steady clock, which is
+ * shared by all processes on a machine.
+ */
+class lease_mutex {
+public:
+    /**
+     * Open or create a lease mutex
+     *
+     * @param name the name of the mutex
+     */
+    explicit lease_mutex(std::string name) : _name(std::move(name)), _token(0), _expires(free) {
+        _memory = shared_memory::open_shared(_name + ".lease", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(lease_kind, _name, [] {});
+    }
+
+    /**
+     * No copy constructor
+     */
+    lease_mutex(const lease_mutex &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    lease_mutex &operator=(const lease_mutex &) = delete;
+
+    /**
+     * Acquire a lease. Blocking call.
+     *
+     * @param ttl the time until the lease expires unless it is renewed
+     * @return the fencing token of the lease
+     */
+    uint64_t lock(futex::clock::duration ttl) {
+        (void) timed_lock(ttl, futex::clock::time_point::max());
+        return _token;
+    }
+
+    /**
+     * Acquire a lease, waiting until the deadline at most
+     *
+     * @param ttl the time until the lease expires unless it is renewed
+     * @param deadline the time point to stop waiting at
+     * @return true, if the lease could be acquired
+     */
+    [[nodiscard]] bool timed_lock(futex::clock::duration ttl, futex::clock::time_point deadline) {
+        if (try_lock(ttl)) return true;
+
+        bool registered = false;
+        for (;;) {
+            futex_target target;
+            if (prepare_wait(registered, target) == wait_preparation::wait) {
+                // Wake up once the lease expires to take it over
+                if (!futex::wait_until(*target.word, target.expected, std::min(deadline, target.recheck)) &&
+                    futex::clock::now() >= deadline) {
+                    const bool acquired = try_lock(ttl);
+                    leave_wait(registered, acquired);
+                    return acquired;
+                }
+            }
+
+            if (try_lock(ttl)) {
+                leave_wait(registered, true);
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Acquire a lease, waiting for at most the given duration
+     *
+     * @param ttl the time until the lease expires unless it is renewed
+     * @param timeout the max time to wait for
+     * @return true, if the lease could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_for(futex::clock::duration ttl, const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock(ttl, futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try acquiring a lease without blocking. Takes over the lease of another holder, if it expired.
+     *
+     * @param ttl the time until the lease expires unless it is renewed
+     * @return true, if the lease could be acquired
+     */
+    [[nodiscard]] bool try_lock(futex::clock::duration ttl) {
+        check_ttl(ttl);
+
+        const uint64_t now = now_ns();
+        uint64_t lease = _data->lease.load(std::memory_order_acquire);
+        if (lease == handing_over || (lease != free && lease > now)) return false;
+        if (!_data->lease.compare_exchange_strong(lease, handing_over, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // The lease is owned by this instance, nobody else may issue a token until the expiry is published
+        _token = _data->token.fetch_add(1, std::memory_order_relaxed) + 1;
+        _expires = expiry(now, ttl);
+        _data->lease.store(_expires, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Extend the lease held by this instance. Succeeds even if the
+     * lease already expired, as long as nobody else took it over.
+     *
+     * @param ttl the time until the lease expires from now on
+     * @return false, if this instance doesn't hold the lease anymore
+     */
+    [[nodiscard]] bool renew(futex::clock::duration ttl) {
+        check_ttl(ttl);
+        if (_expires == free) return false;
+
+        const uint64_t renewed = expiry(now_ns(), ttl);
+        uint64_t expected = _expires;
+        if (!_data->lease.compare_exchange_strong(expected, renewed, std::memory_order_relaxed)) {
+            _expires = free;
+            return false;
+        }
+
+        _expires = renewed;
+        return true;
+    }
+
+    /**
+     * Release the lease held by this instance
+     *
+     * @return false, if the lease was taken over by another holder after it expired
+     */
+    bool unlock() {
+        if (_expires == free) {
+            throw shared_mutex_exception("The lease of '" + _name + "' is not held by this instance");
+        }
+
+        uint64_t expected = _expires;
+        _expires = free;
+        if (!_data->lease.compare_exchange_strong(expected, free, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // Waiters check the sequence before sleeping on it
+        _data->sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (_data->waiters.load(std::memory_order_seq_cst) > 0) {
+            futex::wake(_data->sequence, 1);
+        }
+
+        return true;
+    }
+
+    /**
+     * Prepare waiting for the lease after try_lock() failed. Registers the caller
+     * as a waiter, leave_wait() must be called once it stopped waiting.
+     *
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the release sequence, rechecked once the current lease expires
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(bool &registered, futex_target &target) noexcept {
+        if (!registered) {
+            _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+            registered = true;
+        }
+
+        const uint32_t sequence = _data->sequence.load(std::memory_order_seq_cst);
+        const uint64_t lease = _data->lease.load(std::memory_order_seq_cst);
+        const uint64_t now = now_ns();
+        if (lease == free || (lease != handing_over && lease <= now)) return wait_preparation::retry;
+
+        target.word = &_data->sequence;
+        target.expected = sequence;
+        if (lease == handing_over) {
+            // Another instance is publishing its expiry, which takes a few instructions
+            target.recheck = futex::clock::now() + std::chrono::milliseconds(1);
+        } else {
+            target.recheck = futex::clock::time_point(std::chrono::duration_cast<futex::clock::duration>(
+                    std::chrono::nanoseconds(lease)));
+        }
+
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Stop waiting for the lease after prepare_wait() was called
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     * @param acquired whether the caller acquired the lease
+     */
+    void leave_wait(bool &registered, bool acquired) noexcept {
+        if (!registered) return;
+
+        _data->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        registered = false;
+
+        // This waiter may have consumed the wake up of another waiter, pass it on
+        if (!acquired && _data->lease.load(std::memory_order_relaxed) == free) {
+            futex::wake(_data->sequence, 1);
+        }
+    }
+
+    /**
+     * Get the fencing token of the lease acquired last by this instance
+     *
+     * @return the token, zero if this instance never acquired a lease
+     */
+    [[nodiscard]] uint64_t token() const noexcept {
+        return _token;
+    }
+
+    /**
+     * Check whether this instance still holds the lease
+     *
+     * @return true, if the lease is held by this instance and didn't expire
+     */
+    [[nodiscard]] bool held() const noexcept {
+        return _expires != free && _data->lease.load(std::memory_order_acquire) == _expires &&
+               _expires > now_ns();
+    }
+
+    /**
+     * Check whether a fencing token belongs to the current, unexpired lease.
+     * The result may be outdated as soon as it is returned, resources must
+     * compare the tokens themselves to reject stale writes reliably.
+     *
+     * @param token the fencing token to check
+     * @return true, if the token was issued last and its lease is held and didn't expire
+     */
+    [[nodiscard]] bool is_current(uint64_t token) const noexcept {
+        const uint64_t lease = _data->lease.load(std::memory_order_acquire);
+        return lease != free && lease != handing_over && lease > now_ns() &&
+               _data->token.load(std::memory_order_relaxed) == token;
+    }
+
+    /**
+     * Delete the instance. Releases the lease, if this instance still holds it.
+     * The shared memory segment is deleted once the last instance using it is destroyed.
+     */
+    ~lease_mutex() {
+        if (_expires != free) (void) unlock();
+    }
+
+private:
+    // The lease is not held
+    static constexpr uint64_t free = 0;
+    // The lease is being assigned to a new holder
+    static constexpr uint64_t handing_over = 1;
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The expiry of the current lease in nanoseconds of the steady clock, or free or handing_over
+        std::atomic<uint64_t> lease;
+        // The fencing token of the lease issued last
+        std::atomic<uint64_t> token;
+        // Incremented every time a lease is released, waiters sleep on it
+        std::atomic<uint32_t> sequence;
+        // The number of threads and operations waiting for the lease
+        std::atomic<uint32_t> waiters;
+    };
+
+    /**
+     * Check the time to live passed to an operation
+     *
+     * @param ttl the time to live
+     */
+    void check_ttl(futex::clock::duration ttl) const {
+        if (ttl <= futex::clock::duration::zero()) {
+            throw shared_mutex_exception("The time to live of a lease must be greater than zero");
+        }
+    }
+
+    /**
+     * Get the current time of the steady clock
+     *
+     * @return the nanoseconds since the epoch of the steady clock
+     */
+    static uint64_t now_ns() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                futex::clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * Get the expiry of a lease. Every new lease expires later than all expired ones,
+     * so a holder which lost its lease can't release or renew the lease of another holder.
+     *
+     * @param now the current time in nanoseconds
+     * @param ttl the time to live of the lease
+     * @return the expiry in nanoseconds, never free or handing_over
+     */
+    static uint64_t expiry(uint64_t now, futex::clock::duration ttl) noexcept {
+        const auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count());
+        // Expiries must be representable as steady clock time points
+        const auto max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        const uint64_t expires = nanos > max - now ? max : now + nanos;
+        return std::max<uint64_t>(expires, handing_over + 1);
+    }
+
+    // The name of the mutex
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // The fencing token of the lease acquired last by this instance
+    uint64_t _token;
+    // The expiry of the lease held by this instance, free if it doesn't hold it
+    uint64_t _expires;
+};
+
+#endif //SHARED_MUTEX_LEASE_MUTEX_HPP
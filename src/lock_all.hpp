@@ -0,0 +1,98 @@
+#ifndef SHARED_MUTEX_LOCK_ALL_HPP
+#define SHARED_MUTEX_LOCK_ALL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "futex.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * Lock multiple mutexes at once, waiting until the deadline at most. Uses the
+ * same algorithm as std::lock, which avoids deadlocks no matter in which order
+ * other callers lock the mutexes: block on one mutex, try locking the others
+ * and release all of them if one is contended. The next round blocks on the
+ * contended mutex, so no process holds one mutex while waiting for another one.
+ *
+ * Works with shared_mutex and basic_shared_mutex instances. Other
+ * instances of the same mutexes may be used to lock them one by one.
+ *
+ * @tparam Mutex the mutex type, must provide name(), timed_lock(), try_acquire() and unlock()
+ * @param mutexes the mutexes to lock, each mutex name must be passed at most once
+ * @param deadline the time point to stop waiting at
+ * @return true if all mutexes were locked, false if the deadline was reached and none is locked
+ */
+template<class Mutex>
+[[nodiscard]] bool timed_lock_all(const std::vector<Mutex *> &mutexes, futex::clock::time_point deadline) {
+    for (size_t i = 0; i < mutexes.size(); i++) {
+        for (size_t j = i + 1; j < mutexes.size(); j++) {
+            // Two instances of the same mutex would deadlock, too
+            if (mutexes[i]->name() == mutexes[j]->name()) {
+                throw shared_mutex_exception("The same mutex must not be locked twice");
+            }
+        }
+    }
+
+    if (mutexes.empty()) return true;
+
+    const size_t size = mutexes.size();
+    size_t first = 0;
+    for (bool retry = false;; retry = true) {
+        // The blocking lock may keep succeeding immediately while a probe fails, stop retrying past the deadline
+        if (retry && futex::clock::now() >= deadline) return false;
+        if (!mutexes[first]->timed_lock(deadline)) return false;
+
+        // Probing is part of the algorithm, failed probes are not counted in the statistics
+        size_t n = 1;
+        while (n < size && mutexes[(first + n) % size]->try_acquire(false)) n++;
+        if (n == size) return true;
+
+        // Release everything locked in this round in reverse order, then block on the contended mutex
+        for (size_t k = n; k-- > 0;) {
+            mutexes[(first + k) % size]->unlock();
+        }
+
+        first = (first + n) % size;
+    }
+}
+
+/**
+ * Lock multiple mutexes at once, waiting for at most the given duration
+ *
+ * @tparam Mutex the mutex type
+ * @param mutexes the mutexes to lock, each mutex name must be passed at most once
+ * @param timeout the max time to wait for
+ * @return true if all mutexes were locked, false if the timeout was reached and none is locked
+ */
+template<class Mutex, class Rep, class Period>
+[[nodiscard]] bool try_lock_all_for(const std::vector<Mutex *> &mutexes,
+                                    const std::chrono::duration<Rep, Period> &timeout) {
+    return timed_lock_all(mutexes, futex::deadline_after(timeout));
+}
+
+/**
+ * Lock multiple mutexes at once. Blocking call.
+ *
+ * @tparam Mutex the mutex type
+ * @param mutexes the mutexes to lock, each mutex name must be passed at most once
+ */
+template<class Mutex>
+void lock_all(const std::vector<Mutex *> &mutexes) {
+    (void) timed_lock_all(mutexes, futex::clock::time_point::max());
+}
+
+/**
+ * Unlock mutexes locked by lock_all(), in reverse order
+ *
+ * @tparam Mutex the mutex type
+ * @param mutexes the mutexes to unlock
+ */
+template<class Mutex>
+void unlock_all(const std::vector<Mutex *> &mutexes) {
+    for (size_t i = mutexes.size(); i-- > 0;) {
+        mutexes[i]->unlock();
+    }
+}
+
+#endif //SHARED_MUTEX_LOCK_ALL_HPP
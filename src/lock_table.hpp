@@ -0,0 +1,551 @@
+#ifndef SHARED_MUTEX_LOCK_TABLE_HPP
+#define SHARED_MUTEX_LOCK_TABLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+#include "wait_policy.hpp"
+
+/**
+ * Options for creating a lock_table
+ */
+struct lock_table_options {
+    // The number of lock slots the keys are hashed onto
+    uint32_t slots = 1024;
+    // Whether keys hashed onto a slot used by another key move to a free
+    // slot nearby instead of sharing it, so different keys never block each other
+    bool detect_collisions = false;
+    // How to wait for a contended slot
+    wait_policy_options waiting;
+};
+
+/**
+ * A table of exclusive locks identified by arbitrary string keys,
+ * stored in a single shared memory segment. Keys are hashed onto
+ * a fixed number of slots, each slot has its own cache line.
+ *
+ * Without collision detection, keys hashed onto the same slot share
+ * its lock. With collision detection, a slot is claimed by the key
+ * using it, other keys probe the following slots for a free one.
+ * If all slots near a key are claimed, locking the key waits until
+ * one of them is free.
+ *
+ * All processes using a table must use the same options.
+ */
+class lock_table {
+public:
+    // The max number of slots of a table
+    static constexpr uint32_t max_slots = 1u << 20u;
+
+    /**
+     * The slot a key is locked on
+     */
+    struct entry {
+        // The hash of the key
+        uint64_t hash = 0;
+        // The index of the slot
+        uint32_t slot = 0;
+        // Whether the key claimed or joined the slot
+        bool joined = false;
+    };
+
+    /**
+     * Open or create a lock table
+     *
+     * @param name the name of the table
+     * @param options the table options
+     */
+    explicit lock_table(std::string name, const lock_table_options &options = {})
+            : _name(std::move(name)), _wait_policy(options.waiting) {
+        if (options.slots == 0 || options.slots > max_slots) {
+            throw shared_mutex_exception(
+                    "The number of slots must be between 1 and " + std::to_string(max_slots));
+        }
+
+        _memory = shared_memory::open_shared(_name + ".table", sizeof(header) + options.slots * sizeof(slot), true);
+        _header = _memory->as<header>();
+        _slots = reinterpret_cast<slot *>(static_cast<char *>(_memory->data()) + sizeof(header));
+
+        _header->segment.initialize(lock_table_kind, _name, [&] {
+            _header->slot_count = options.slots;
+            _header->detect_collisions = options.detect_collisions ? 1 : 0;
+        });
+
+        if (_header->slot_count != options.slots ||
+            _header->detect_collisions != (options.detect_collisions ? 1u : 0u)) {
+            throw shared_mutex_exception(
+                    "A lock table with the name '" + _name + "' already exists with a different configuration");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    lock_table(const lock_table &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    lock_table &operator=(const lock_table &) = delete;
+
+    /**
+     * Lock a key. Blocking call.
+     *
+     * @param key the key to lock
+     */
+    void lock(const std::string &key) {
+        (void) timed_lock(key, futex::clock::time_point::max());
+    }
+
+    /**
+     * Lock a key, waiting until the deadline at most
+     *
+     * @param key the key to lock
+     * @param deadline the time point to stop waiting at
+     * @return true, if the lock could be acquired
+     */
+    [[nodiscard]] bool timed_lock(const std::string &key, futex::clock::time_point deadline) {
+        entry e;
+        e.hash = hash(key);
+        if (!join_until(e, deadline)) return false;
+
+        if (!acquire(e) && !lock_slow(e, deadline)) {
+            leave(e);
+            return false;
+        }
+
+        record_held(key, e);
+        return true;
+    }
+
+    /**
+     * Try locking a key, waiting for at most the given duration
+     *
+     * @param key the key to lock
+     * @param timeout the max time to wait for
+     * @return true, if the lock could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_for(const std::string &key, const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock(key, futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking a key
+     *
+     * @param key the key to lock
+     * @return true, if the lock could be acquired
+     */
+    [[nodiscard]] bool try_lock(const std::string &key) {
+        entry e;
+        if (try_lock(key, e, false)) return true;
+
+        leave(e);
+        return false;
+    }
+
+    /**
+     * Try locking a key without blocking. Used by waiters which keep
+     * their entry between attempts, the entry must be passed to
+     * leave() if the key is never locked.
+     *
+     * @param key the key to lock
+     * @param e the entry of the key, updated once the key joined a slot
+     * @param waited whether the caller waited on the target set by prepare_wait() before
+     * @return true, if the lock could be acquired
+     */
+    [[nodiscard]] bool try_lock(const std::string &key, entry &e, bool waited) {
+        if (!e.joined) {
+            e.hash = hash(key);
+            if (!join(e)) return false;
+        }
+
+        // After waiting, we don't know if there are other waiters, keep the contended state
+        uint32_t state = unlocked;
+        const bool locked_slot = waited ? _slots[e.slot].word.compare_exchange_strong(
+                state, contended, std::memory_order_acquire, std::memory_order_relaxed) : acquire(e);
+        if (locked_slot) record_held(key, e);
+
+        return locked_slot;
+    }
+
+    /**
+     * Unlock a key
+     *
+     * @param key the key to unlock
+     */
+    void unlock(const std::string &key) {
+        entry e;
+        {
+            std::unique_lock<std::mutex> lock(_held_mutex);
+            auto it = _held.find(key);
+            if (it == _held.end()) {
+                throw shared_mutex_exception("The key '" + key + "' is not locked by this lock table");
+            }
+
+            e = it->second;
+            _held.erase(it);
+        }
+
+        release(e);
+    }
+
+    /**
+     * Prepare waiting for the slot of a key after try_lock() failed
+     *
+     * @param e the entry of the key
+     * @param target set to the lock word of the slot
+     * @return whether to wait on the target, retry immediately or poll
+     */
+    [[nodiscard]] wait_preparation prepare_wait(const entry &e, futex_target &target) {
+        // Keys which couldn't claim a slot wait for any slot to be freed
+        if (!e.joined) return wait_preparation::unsupported;
+
+        std::atomic<uint32_t> &word = _slots[e.slot].word;
+        uint32_t state = word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state == unlocked) {
+                return wait_preparation::retry;
+            } else if (state == contended ||
+                       word.compare_exchange_weak(state, contended, std::memory_order_relaxed)) {
+                target.word = &word;
+                target.expected = contended;
+                return wait_preparation::wait;
+            }
+        }
+    }
+
+    /**
+     * Stop waiting for the slot of a key after prepare_wait() was called
+     *
+     * @param e the entry of the key
+     */
+    void abandon_wait(const entry &e) {
+        // This waiter may have consumed the wake up of another waiter, pass it on
+        if (e.joined) futex::wake(_slots[e.slot].word, 1);
+    }
+
+    /**
+     * Release the slot of a key which was never locked
+     *
+     * @param e the entry of the key
+     */
+    void leave(entry &e) noexcept {
+        if (!e.joined) return;
+
+        e.joined = false;
+        if (!_header->detect_collisions) return;
+
+        slot &home = _slots[e.hash % _header->slot_count];
+        spin_guard guard(home.meta);
+        slot &s = _slots[e.slot];
+        if (s.refs.fetch_sub(1, std::memory_order_relaxed) == 1) {
+            s.key.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Get the slot a key is hashed onto, before probing for a free slot
+     *
+     * @param key the key
+     * @return the index of the slot
+     */
+    [[nodiscard]] uint32_t home_slot(const std::string &key) const noexcept {
+        return static_cast<uint32_t>(hash(key) % _header->slot_count);
+    }
+
+    /**
+     * Get the number of slots
+     *
+     * @return the number of slots
+     */
+    [[nodiscard]] uint32_t slot_count() const noexcept {
+        return _header->slot_count;
+    }
+
+    /**
+     * Check whether keys sharing a slot are detected
+     *
+     * @return true if collision detection is enabled
+     */
+    [[nodiscard]] bool detects_collisions() const noexcept {
+        return _header->detect_collisions != 0;
+    }
+
+    /**
+     * Get the number of contended acquisitions per wait phase
+     *
+     * @return the wait phase statistics
+     */
+    [[nodiscard]] wait_phase_stats wait_stats() const noexcept {
+        return _wait_policy.stats();
+    }
+
+    /**
+     * Hash a key. The hash is the same in every process.
+     *
+     * @param key the key to hash
+     * @return the hash, never zero
+     */
+    [[nodiscard]] static uint64_t hash(const std::string &key) noexcept {
+        // FNV-1a, followed by the splitmix64 finalizer to spread the bits for the modulo
+        uint64_t h = 14695981039346656037ull;
+        for (const char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+
+        h ^= h >> 30u;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27u;
+        h *= 0x94d049bb133111ebull;
+        h ^= h >> 31u;
+
+        // Zero marks free slots
+        return h == 0 ? 1 : h;
+    }
+
+    /**
+     * Delete the lock table. Unlocks all keys locked by this instance.
+     * The shared memory segment is deleted once the last instance using it is destroyed.
+     */
+    ~lock_table() {
+        for (auto &held : _held) {
+            release(held.second);
+        }
+    }
+
+private:
+    // The size of a cache line
+    static constexpr size_t cache_line = 64;
+    // The max number of slots probed for a free slot
+    static constexpr uint32_t max_probes = 8;
+    // No slot
+    static constexpr uint32_t npos = 0xffffffffu;
+    // The slot is not locked
+    static constexpr uint32_t unlocked = 0;
+    // The slot is locked without waiters
+    static constexpr uint32_t locked = 1;
+    // The slot is locked and there may be waiters
+    static constexpr uint32_t contended = 2;
+    // The interval to check for a free slot in, if all slots near a key are claimed
+    static constexpr std::chrono::microseconds claim_interval{200};
+
+    /**
+     * The header at the start of the shared memory segment
+     */
+    struct alignas(cache_line) header {
+        // The segment header
+        segment_header segment;
+        // The number of slots
+        uint32_t slot_count;
+        // Whether collision detection is enabled
+        uint32_t detect_collisions;
+    };
+
+    /**
+     * A lock slot, padded to a cache line so
+     * locking one slot doesn't slow down others
+     */
+    struct alignas(cache_line) slot {
+        // The lock word
+        std::atomic<uint32_t> word;
+        // The spin lock guarding the claims of the keys hashed onto this slot
+        std::atomic<uint32_t> meta;
+        // The hash of the key which claimed the slot, zero if the slot is free
+        std::atomic<uint64_t> key;
+        // The number of threads and operations using the claimed slot
+        std::atomic<uint32_t> refs;
+    };
+
+    /**
+     * Holds the claim spin lock of a slot. The lock is only held
+     * for a few instructions, so contending threads just spin.
+     */
+    class spin_guard {
+    public:
+        /**
+         * Lock the spin lock
+         *
+         * @param word the spin lock word
+         */
+        explicit spin_guard(std::atomic<uint32_t> &word) noexcept: _word(word) {
+            for (uint32_t spins = 0; _word.exchange(1, std::memory_order_acquire) != 0; spins++) {
+                if (spins < 64) {
+                    cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        spin_guard(const spin_guard &) = delete;
+
+        spin_guard &operator=(const spin_guard &) = delete;
+
+        /**
+         * Unlock the spin lock
+         */
+        ~spin_guard() {
+            _word.store(0, std::memory_order_release);
+        }
+
+    private:
+        // The spin lock word
+        std::atomic<uint32_t> &_word;
+    };
+
+    /**
+     * Find the slot of a key. Without collision detection, this is the
+     * slot the key is hashed onto. Otherwise, the key joins the slot it
+     * already claimed or claims a free one. All claims of the keys hashed
+     * onto a slot are serialized by its spin lock, so a key never claims
+     * two slots at once.
+     *
+     * @param e the entry of the key, hash must be set
+     * @return false if all slots the key may use are claimed by other keys
+     */
+    bool join(entry &e) {
+        const uint32_t count = _header->slot_count;
+        const auto home = static_cast<uint32_t>(e.hash % count);
+        if (!_header->detect_collisions) {
+            e.slot = home;
+            e.joined = true;
+            return true;
+        }
+
+        const uint32_t probes = std::min(max_probes, count);
+        spin_guard guard(_slots[home].meta);
+        for (;;) {
+            uint32_t free = npos;
+            for (uint32_t i = 0; i < probes; i++) {
+                const uint32_t index = (home + i) % count;
+                const uint64_t key = _slots[index].key.load(std::memory_order_acquire);
+                if (key == e.hash) {
+                    _slots[index].refs.fetch_add(1, std::memory_order_relaxed);
+                    e.slot = index;
+                    e.joined = true;
+                    return true;
+                } else if (key == 0 && free == npos) {
+                    free = index;
+                }
+            }
+
+            if (free == npos) return false;
+
+            // Keys hashed onto other slots may claim the free slot at the same time
+            uint64_t expected = 0;
+            if (_slots[free].key.compare_exchange_strong(expected, e.hash, std::memory_order_acq_rel)) {
+                _slots[free].refs.store(1, std::memory_order_relaxed);
+                e.slot = free;
+                e.joined = true;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Find the slot of a key, waiting for a free slot until the deadline at most
+     *
+     * @param e the entry of the key, hash must be set
+     * @param deadline the time point to stop waiting at
+     * @return true, if the key joined a slot
+     */
+    bool join_until(entry &e, futex::clock::time_point deadline) {
+        while (!join(e)) {
+            const auto now = futex::clock::now();
+            if (now >= deadline) return false;
+
+            std::this_thread::sleep_for(std::min<futex::clock::duration>(claim_interval, deadline - now));
+        }
+
+        return true;
+    }
+
+    /**
+     * Try locking the slot of a key
+     *
+     * @param e the entry of the key
+     * @return true, if the lock could be acquired
+     */
+    bool acquire(const entry &e) noexcept {
+        uint32_t state = unlocked;
+        return _slots[e.slot].word.compare_exchange_strong(state, locked, std::memory_order_acquire,
+                                                           std::memory_order_relaxed);
+    }
+
+    /**
+     * Wait until the slot of a key is unlocked
+     *
+     * @param e the entry of the key
+     * @param deadline the time point to stop waiting at
+     * @return true, if the lock could be acquired
+     */
+    bool lock_slow(const entry &e, futex::clock::time_point deadline) {
+        if (_wait_policy.spin([&] { return acquire(e); }, deadline)) return true;
+
+        std::atomic<uint32_t> &word = _slots[e.slot].word;
+        while (word.exchange(contended, std::memory_order_acquire) != unlocked) {
+            if (!futex::wait_until(word, contended, deadline)) {
+                // This waiter may have consumed the wake up of another waiter, pass it on
+                futex::wake(word, 1);
+                return false;
+            }
+        }
+
+        _wait_policy.parked();
+        return true;
+    }
+
+    /**
+     * Remember a locked key, so it can be unlocked by name
+     *
+     * @param key the key
+     * @param e the entry of the key
+     */
+    void record_held(const std::string &key, const entry &e) {
+        std::unique_lock<std::mutex> lock(_held_mutex);
+        _held.emplace(key, e);
+    }
+
+    /**
+     * Unlock the slot of a key and leave it
+     *
+     * @param e the entry of the key
+     */
+    void release(entry &e) noexcept {
+        std::atomic<uint32_t> &word = _slots[e.slot].word;
+        if (word.exchange(unlocked, std::memory_order_release) == contended) {
+            futex::wake(word, 1);
+        }
+
+        leave(e);
+    }
+
+    // The name of the table
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The header in the shared memory segment
+    header *_header = nullptr;
+    // The slots in the shared memory segment
+    slot *_slots = nullptr;
+    // The policy for waiting for contended slots
+    wait_policy _wait_policy;
+    // The mutex guarding the locked keys
+    std::mutex _held_mutex;
+    // The keys locked by this instance and their entries
+    std::unordered_map<std::string, entry> _held;
+};
+
+#endif //SHARED_MUTEX_LOCK_TABLE_HPP
@@ -0,0 +1,490 @@
+#ifndef SHARED_MUTEX_LOCK_TRACE_HPP
+#define SHARED_MUTEX_LOCK_TRACE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+#include "wait_policy.hpp"
+
+#ifdef OS_WINDOWS
+#   include <Windows.h>
+#else
+#   include <pthread.h>
+#   include <unistd.h>
+#   ifdef OS_LINUX
+#       include <sys/syscall.h>
+#   endif //OS_LINUX
+#endif //OS_WINDOWS
+
+/**
+ * A ring of lock events in a shared memory segment used by all
+ * processes on this machine. Mutexes created with tracing enabled
+ * record when threads start waiting for them, acquire, release or fail
+ * to try_lock() them. Recording claims a slot with a single atomic
+ * increment and never blocks, the oldest events are overwritten once
+ * the ring is full. The events can be exported as Chrome trace_event
+ * JSON, which can be loaded into Perfetto or chrome://tracing.
+ *
+ * Mutex names are stored once in a table in the segment, events only
+ * store their index. Names longer than max_name_length are truncated.
+ */
+class lock_trace {
+public:
+    // The number of events the ring holds
+    static constexpr uint32_t capacity = 1u << 16u;
+    // The number of mutex names the ring can store
+    static constexpr uint32_t max_names = 1024;
+    // The max length of a stored mutex name
+    static constexpr size_t max_name_length = 59;
+
+    /**
+     * The kind of a lock event
+     */
+    enum class event_type : uint32_t {
+        // A thread started waiting for the mutex
+        wait_start = 1,
+        // The mutex was acquired exclusively
+        acquired = 2,
+        // The mutex was acquired in shared mode
+        acquired_shared = 3,
+        // The exclusively held mutex was released
+        released = 4,
+        // A try_lock() call failed
+        try_lock_failed = 5
+    };
+
+    /**
+     * A recorded lock event
+     */
+    struct event {
+        // The steady clock time of the event in nanoseconds
+        uint64_t time_ns = 0;
+        // The id of the recording process
+        uint32_t pid = 0;
+        // The id of the recording thread
+        uint32_t tid = 0;
+        // The id of the mutex name, zero if the name table was full
+        uint32_t name_id = 0;
+        // The kind of the event
+        event_type type = event_type::acquired;
+    };
+
+    /**
+     * Get the trace ring of this machine, opening or creating it on first use.
+     * The segment is never removed by this library, call remove() to delete it.
+     *
+     * @return the trace ring
+     */
+    static lock_trace &instance() {
+        // Never destroyed, mutexes may still record events during static destruction
+        static auto *trace = new lock_trace();
+        return *trace;
+    }
+
+    /**
+     * Remove the name of the trace segment. Processes which
+     * already opened it keep recording into the old segment.
+     */
+    static void remove() noexcept {
+        try {
+            shared_memory(segment_name, sizeof(header), true).unlink();
+        } catch (...) {
+            // The segment could not be opened, there is nothing to remove
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    lock_trace(const lock_trace &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    lock_trace &operator=(const lock_trace &) = delete;
+
+    /**
+     * Get the id of a mutex name, storing the name in the table if it isn't stored yet
+     *
+     * @param name the mutex name
+     * @return the id of the name, zero if the table is full
+     */
+    [[nodiscard]] uint32_t name_id(const std::string &name) noexcept {
+        const std::string stored = name.substr(0, max_name_length);
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : stored) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+
+        for (uint32_t probe = 0; probe < max_names; probe++) {
+            const auto index = static_cast<uint32_t>((hash + probe) % max_names);
+            name_entry &entry = _names[index];
+
+            uint32_t state = entry.state.load(std::memory_order_acquire);
+            if (state == empty && entry.state.compare_exchange_strong(state, writing, std::memory_order_acquire)) {
+                std::memcpy(entry.name, stored.c_str(), stored.size() + 1);
+                entry.state.store(ready, std::memory_order_release);
+                return index + 1;
+            }
+
+            // Another process is storing a name in this entry, which takes a few instructions
+            while (state == writing) {
+                cpu_relax();
+                state = entry.state.load(std::memory_order_acquire);
+            }
+
+            if (stored == entry.name) return index + 1;
+        }
+
+        return 0;
+    }
+
+    /**
+     * Get a stored mutex name
+     *
+     * @param id the id of the name
+     * @return the name, empty if the id is unknown
+     */
+    [[nodiscard]] std::string name(uint32_t id) const {
+        if (id == 0 || id > max_names) return std::string();
+
+        const name_entry &entry = _names[id - 1];
+        if (entry.state.load(std::memory_order_acquire) != ready) return std::string();
+
+        return std::string(entry.name, strnlen(entry.name, max_name_length));
+    }
+
+    /**
+     * Record an event of the calling thread
+     *
+     * @param type the kind of the event
+     * @param name_id the id of the mutex name
+     */
+    void record(event_type type, uint32_t name_id) noexcept {
+        const uint64_t index = _header->head.fetch_add(1, std::memory_order_relaxed);
+        slot &s = _slots[index % capacity];
+        const identity &self = current_identity();
+
+        // Readers skip the slot while the sequence is odd or belongs to another index
+        s.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.time.store(now_ns(), std::memory_order_relaxed);
+        s.thread.store((static_cast<uint64_t>(self.pid) << 32u) | self.tid, std::memory_order_relaxed);
+        s.info.store((static_cast<uint64_t>(name_id) << 32u) | static_cast<uint32_t>(type),
+                     std::memory_order_relaxed);
+        s.sequence.store(index * 2 + 2, std::memory_order_release);
+    }
+
+    /**
+     * Copy the events currently in the ring. Events which are
+     * written or overwritten while copying them are skipped.
+     *
+     * @return the events, oldest first
+     */
+    [[nodiscard]] std::vector<event> events() const {
+        const uint64_t head = _header->head.load(std::memory_order_acquire);
+        const uint64_t first = head > capacity ? head - capacity : 0;
+
+        std::vector<event> result;
+        result.reserve(static_cast<size_t>(head - first));
+        for (uint64_t index = first; index < head; index++) {
+            const slot &s = _slots[index % capacity];
+            if (s.sequence.load(std::memory_order_acquire) != index * 2 + 2) continue;
+
+            event e;
+            e.time_ns = s.time.load(std::memory_order_relaxed);
+            const uint64_t thread = s.thread.load(std::memory_order_relaxed);
+            const uint64_t info = s.info.load(std::memory_order_relaxed);
+
+            // The event must be read before the sequence is checked again
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.sequence.load(std::memory_order_relaxed) != index * 2 + 2) continue;
+
+            e.pid = static_cast<uint32_t>(thread >> 32u);
+            e.tid = static_cast<uint32_t>(thread);
+            e.name_id = static_cast<uint32_t>(info >> 32u);
+            e.type = static_cast<event_type>(static_cast<uint32_t>(info));
+            result.push_back(e);
+        }
+
+        // Events are claimed in order, but their timestamps are taken afterwards
+        std::stable_sort(result.begin(), result.end(), [](const event &a, const event &b) {
+            return a.time_ns < b.time_ns;
+        });
+
+        return result;
+    }
+
+    /**
+     * Export the events in the ring as Chrome trace_event JSON.
+     * Waits and exclusive holds become complete events on the track of the
+     * thread which waited for or acquired the mutex, shared acquisitions and
+     * failed try_lock() calls become instant events. Holds which were not
+     * released yet end at the newest event.
+     *
+     * @return the JSON document
+     */
+    [[nodiscard]] std::string chrome_json() const {
+        const std::vector<event> recorded = events();
+
+        std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        const auto append = [&](const char *phase, const char *category, const event &e, uint64_t duration_ns) {
+            json += first ? "\n" : ",\n";
+            first = false;
+            json += R"({"name":")" + escape(display_name(e.name_id)) + R"(","cat":")" + category +
+                    R"(","ph":")" + phase + R"(","ts":)" + micros(e.time_ns) + ",\"pid\":" +
+                    std::to_string(e.pid) + ",\"tid\":" + std::to_string(e.tid);
+            if (phase[0] == 'X') {
+                json += ",\"dur\":" + micros(duration_ns);
+            } else {
+                json += R"(,"s":"t")";
+            }
+
+            json += "}";
+        };
+
+        // The pending waits by thread and mutex, the pending holds by mutex
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, event> waits;
+        std::map<uint32_t, event> holds;
+        for (const event &e : recorded) {
+            const auto thread_key = std::make_tuple(e.pid, e.tid, e.name_id);
+            switch (e.type) {
+                case event_type::wait_start:
+                    waits[thread_key] = e;
+                    break;
+                case event_type::acquired:
+                case event_type::acquired_shared: {
+                    auto it = waits.find(thread_key);
+                    if (it != waits.end()) {
+                        append("X", "wait", it->second, e.time_ns - it->second.time_ns);
+                        waits.erase(it);
+                    }
+
+                    if (e.type == event_type::acquired) {
+                        holds[e.name_id] = e;
+                    } else {
+                        append("i", "acquired_shared", e, 0);
+                    }
+                    break;
+                }
+                case event_type::released: {
+                    // The mutex may be released by another thread than the one which acquired it
+                    auto it = holds.find(e.name_id);
+                    if (it != holds.end()) {
+                        append("X", "hold", it->second, e.time_ns - it->second.time_ns);
+                        holds.erase(it);
+                    }
+                    break;
+                }
+                case event_type::try_lock_failed:
+                    append("i", "try_lock_failed", e, 0);
+                    break;
+            }
+        }
+
+        const uint64_t newest = recorded.empty() ? 0 : recorded.back().time_ns;
+        for (const auto &hold : holds) {
+            append("X", "hold", hold.second, newest - hold.second.time_ns);
+        }
+
+        json += "\n]}\n";
+        return json;
+    }
+
+private:
+    // The name of the shared memory segment
+    static constexpr const char *segment_name = "shared_mutex_trace";
+    // The name entry is empty
+    static constexpr uint32_t empty = 0;
+    // A name is being stored in the entry
+    static constexpr uint32_t writing = 1;
+    // The entry stores a name
+    static constexpr uint32_t ready = 2;
+
+    /**
+     * The header at the start of the shared memory segment
+     */
+    struct header {
+        // The segment header
+        segment_header segment;
+        // The index of the next event, events are claimed by incrementing it
+        alignas(64) std::atomic<uint64_t> head;
+    };
+
+    /**
+     * An entry of the name table
+     */
+    struct name_entry {
+        // Whether the entry is empty, being written or stores a name
+        std::atomic<uint32_t> state;
+        // The null-terminated name
+        char name[max_name_length + 1];
+    };
+
+    /**
+     * A slot storing an event
+     */
+    struct slot {
+        // Twice the index of the event plus one while it is written, plus two once it was written
+        std::atomic<uint64_t> sequence;
+        // The time of the event in nanoseconds
+        std::atomic<uint64_t> time;
+        // The process id in the upper and the thread id in the lower 32 bits
+        std::atomic<uint64_t> thread;
+        // The name id in the upper and the event type in the lower 32 bits
+        std::atomic<uint64_t> info;
+    };
+
+    /**
+     * The ids of the calling thread
+     */
+    struct identity {
+        // The process id
+        uint32_t pid = 0;
+        // The thread id
+        uint32_t tid = 0;
+    };
+
+    /**
+     * Open or create the trace segment
+     */
+    lock_trace() {
+        const size_t size = sizeof(header) + max_names * sizeof(name_entry) + capacity * sizeof(slot);
+        _memory = std::make_shared<shared_memory>(segment_name, size, true);
+        _header = _memory->as<header>();
+        _names = reinterpret_cast<name_entry *>(static_cast<char *>(_memory->data()) + sizeof(header));
+        _slots = reinterpret_cast<slot *>(reinterpret_cast<char *>(_names) + max_names * sizeof(name_entry));
+        _header->segment.initialize(trace_kind, segment_name, [] {});
+    }
+
+    /**
+     * Get the ids of the calling thread, cached per thread
+     *
+     * @return the process and thread id
+     */
+    static const identity &current_identity() noexcept {
+        identity &self = cached_identity();
+        if (self.pid != 0) return self;
+
+#ifdef OS_WINDOWS
+        self.tid = static_cast<uint32_t>(GetCurrentThreadId());
+        self.pid = static_cast<uint32_t>(GetCurrentProcessId());
+#else
+        static const bool registered = [] {
+            // The thread calling fork() continues in a new process with a new thread id
+            pthread_atfork(nullptr, nullptr, [] {
+                cached_identity().pid = 0;
+            });
+
+            return true;
+        }();
+        (void) registered;
+
+#   ifdef OS_LINUX
+        self.tid = static_cast<uint32_t>(syscall(SYS_gettid));
+#   else
+        uint64_t tid = 0;
+        pthread_threadid_np(nullptr, &tid);
+        self.tid = static_cast<uint32_t>(tid);
+#   endif //OS_LINUX
+        self.pid = static_cast<uint32_t>(getpid());
+#endif //OS_WINDOWS
+
+        return self;
+    }
+
+    /**
+     * Get the cached ids of the calling thread
+     *
+     * @return the cached ids, the process id is zero if they weren't retrieved yet
+     */
+    static identity &cached_identity() noexcept {
+        thread_local identity self;
+        return self;
+    }
+
+    /**
+     * Get the current time of the steady clock
+     *
+     * @return the nanoseconds since the epoch of the steady clock
+     */
+    static uint64_t now_ns() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                futex::clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * Format nanoseconds as the microseconds used by the trace format
+     *
+     * @param ns the nanoseconds
+     * @return the formatted microseconds
+     */
+    static std::string micros(uint64_t ns) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                      static_cast<unsigned long long>(ns % 1000));
+        return buffer;
+    }
+
+    /**
+     * Get the name an event is displayed with
+     *
+     * @param id the id of the mutex name
+     * @return the name
+     */
+    [[nodiscard]] std::string display_name(uint32_t id) const {
+        const std::string stored = name(id);
+        return stored.empty() ? "(unknown mutex)" : stored;
+    }
+
+    /**
+     * Escape a string for a JSON string literal
+     *
+     * @param value the string to escape
+     * @return the escaped string
+     */
+    static std::string escape(const std::string &value) {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (const char c : value) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned int>(c));
+                escaped += buffer;
+            } else {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The header in the shared memory segment
+    header *_header = nullptr;
+    // The name table
+    name_entry *_names = nullptr;
+    // The event slots
+    slot *_slots = nullptr;
+};
+
+#endif //SHARED_MUTEX_LOCK_TRACE_HPP
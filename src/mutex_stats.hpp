@@ -0,0 +1,369 @@
+#ifndef SHARED_MUTEX_MUTEX_STATS_HPP
+#define SHARED_MUTEX_MUTEX_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "lock_trace.hpp"
+
+// Define SHARED_MUTEX_NO_STATS to compile out the contention statistics and lock tracing
+
+/**
+ * The contention statistics of a mutex, summed up over all processes using it
+ */
+struct mutex_stats {
+    // The number of buckets of the hold time histogram
+    static constexpr size_t hold_buckets = 20;
+
+    // Whether the instance the statistics were read from records them
+    bool enabled = false;
+    // The number of times the mutex was acquired
+    uint64_t acquisitions = 0;
+    // The number of acquisitions which had to wait for the mutex
+    uint64_t contended = 0;
+    // The number of try_lock() calls which failed
+    uint64_t try_lock_failures = 0;
+    // The total time contended acquisitions waited for, in nanoseconds
+    uint64_t total_wait_ns = 0;
+    // The longest time a contended acquisition waited for, in nanoseconds
+    uint64_t max_wait_ns = 0;
+    // The number of threads and async operations currently waiting for the mutex
+    uint32_t waiters = 0;
+    // How long the mutex was held exclusively. Bucket 0 counts holds shorter
+    // than 1µs, bucket i counts holds of [2^(i-1), 2^i) µs, the last bucket all longer holds.
+    std::array<uint64_t, hold_buckets> hold_histogram{};
+};
+
+/**
+ * Records the contention statistics of a mutex in a shared memory segment.
+ * All counters are relaxed atomics. The statistics are opt-in, recording does
+ * nothing unless they were enabled, the segment could be opened and
+ * SHARED_MUTEX_NO_STATS is not defined. If tracing is enabled, every lock
+ * event is also recorded in the lock_trace ring.
+ */
+class mutex_stats_recorder {
+public:
+    // Whether the statistics are compiled in
+#ifdef SHARED_MUTEX_NO_STATS
+    static constexpr bool enabled = false;
+#else
+    static constexpr bool enabled = true;
+#endif //SHARED_MUTEX_NO_STATS
+
+    /**
+     * Tracks a thread or async operation waiting for the mutex
+     */
+    class wait_scope {
+    public:
+        /**
+         * Start waiting
+         *
+         * @param recorder the recorder to record the wait in
+         */
+        explicit wait_scope(mutex_stats_recorder *recorder) noexcept: _recorder(recorder), _start(), _acquired(false) {
+            _recorder->trace(lock_trace::event_type::wait_start);
+            if (_recorder->recording()) {
+                _start = futex::clock::now();
+                _recorder->_data->waiters.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Move constructor
+         *
+         * @param rhs the scope to move
+         */
+        wait_scope(wait_scope &&rhs) noexcept: _recorder(rhs._recorder), _start(rhs._start),
+                                              _acquired(rhs._acquired) {
+            rhs._recorder = nullptr;
+        }
+
+        wait_scope(const wait_scope &) = delete;
+
+        wait_scope &operator=(const wait_scope &) = delete;
+
+        wait_scope &operator=(wait_scope &&) = delete;
+
+        /**
+         * Record that the wait acquired the mutex
+         */
+        void acquired() noexcept {
+            _acquired = true;
+        }
+
+        /**
+         * Stop waiting. Records the wait time, if the mutex was acquired.
+         */
+        ~wait_scope() {
+            if (!_recorder || !_recorder->recording()) return;
+
+            data *d = _recorder->_data;
+            d->waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (!_acquired) return;
+
+            const auto waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    futex::clock::now() - _start).count());
+            d->contended.fetch_add(1, std::memory_order_relaxed);
+            d->total_wait_ns.fetch_add(waited, std::memory_order_relaxed);
+
+            uint64_t max = d->max_wait_ns.load(std::memory_order_relaxed);
+            while (waited > max && !d->max_wait_ns.compare_exchange_weak(max, waited, std::memory_order_relaxed)) {}
+        }
+
+    private:
+        // The recorder to record the wait in
+        mutex_stats_recorder *_recorder;
+        // The time the wait started at
+        futex::clock::time_point _start;
+        // Whether the wait acquired the mutex
+        bool _acquired;
+    };
+
+    /**
+     * Create a recorder which doesn't record anything until open() is called
+     */
+    mutex_stats_recorder() noexcept: _data(nullptr), _trace(nullptr), _trace_name(0) {}
+
+    mutex_stats_recorder(const mutex_stats_recorder &) = delete;
+
+    mutex_stats_recorder &operator=(const mutex_stats_recorder &) = delete;
+
+    /**
+     * Open the statistics segment of a mutex. The statistics and the trace
+     * are best effort, if a segment can't be opened nothing is recorded in it.
+     *
+     * @param name the name of the mutex
+     * @param stats whether to record the contention statistics in a shared memory segment.
+     *              Always enabled if the SHARED_MUTEX_STATS environment variable is set.
+     * @param trace whether to record the lock events in the lock_trace ring.
+     *              Always enabled if the SHARED_MUTEX_TRACE environment variable is set.
+     */
+    void open(const std::string &name, bool stats = false, bool trace = false) noexcept {
+#ifndef SHARED_MUTEX_NO_STATS
+        if (stats || std::getenv("SHARED_MUTEX_STATS") != nullptr) {
+            try {
+                _memory = shared_memory::open_shared(name + ".stats", sizeof(data), true);
+                _memory->as<data>()->header.initialize(stats_kind, name, [] {});
+                _data = _memory->as<data>();
+            } catch (...) {
+                _memory.reset();
+            }
+        }
+
+        if (trace || std::getenv("SHARED_MUTEX_TRACE") != nullptr) {
+            try {
+                _trace = &lock_trace::instance();
+                _trace_name = _trace->name_id(name);
+            } catch (...) {
+                _trace = nullptr;
+            }
+        }
+#else
+        (void) name;
+        (void) stats;
+        (void) trace;
+#endif //SHARED_MUTEX_NO_STATS
+    }
+
+    /**
+     * Record that the mutex was acquired
+     *
+     * @param shared whether the mutex was acquired in shared mode
+     */
+    void acquired(bool shared = false) noexcept {
+        trace(shared ? lock_trace::event_type::acquired_shared : lock_trace::event_type::acquired);
+        if (recording()) _data->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Record that the mutex was released after being held exclusively
+     *
+     * @param held how long the mutex was held for
+     */
+    void released(futex::clock::duration held) noexcept {
+        trace(lock_trace::event_type::released);
+        if (!recording()) return;
+
+        auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(held).count());
+        size_t bucket = 0;
+        while (micros > 0 && bucket < mutex_stats::hold_buckets - 1) {
+            micros >>= 1u;
+            bucket++;
+        }
+
+        _data->hold_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Record a failed try_lock() call
+     */
+    void try_lock_failed() noexcept {
+        trace(lock_trace::event_type::try_lock_failed);
+        if (recording()) _data->try_lock_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Whether the statistics are recorded
+     *
+     * @return true if the statistics segment is open
+     */
+    [[nodiscard]] bool recording() const noexcept {
+        return enabled && _data != nullptr;
+    }
+
+    /**
+     * Whether the lock events are traced
+     *
+     * @return true if the lock events are recorded in the lock_trace ring
+     */
+    [[nodiscard]] bool tracing() const noexcept {
+        return enabled && _trace != nullptr;
+    }
+
+    /**
+     * Get the current statistics
+     *
+     * @return the statistics, all zero and not enabled if nothing is recorded
+     */
+    [[nodiscard]] mutex_stats snapshot() const noexcept {
+        mutex_stats stats;
+        if (!recording()) return stats;
+
+        stats.enabled = true;
+        stats.acquisitions = _data->acquisitions.load(std::memory_order_relaxed);
+        stats.contended = _data->contended.load(std::memory_order_relaxed);
+        stats.try_lock_failures = _data->try_lock_failures.load(std::memory_order_relaxed);
+        stats.total_wait_ns = _data->total_wait_ns.load(std::memory_order_relaxed);
+        stats.max_wait_ns = _data->max_wait_ns.load(std::memory_order_relaxed);
+        stats.waiters = _data->waiters.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < mutex_stats::hold_buckets; i++) {
+            stats.hold_histogram[i] = _data->hold_histogram[i].load(std::memory_order_relaxed);
+        }
+
+        return stats;
+    }
+
+private:
+    /**
+     * The counters stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The number of threads and async operations currently waiting
+        std::atomic<uint32_t> waiters;
+        // The number of acquisitions
+        std::atomic<uint64_t> acquisitions;
+        // The number of contended acquisitions
+        std::atomic<uint64_t> contended;
+        // The number of failed try_lock() calls
+        std::atomic<uint64_t> try_lock_failures;
+        // The total wait time of contended acquisitions in nanoseconds
+        std::atomic<uint64_t> total_wait_ns;
+        // The longest wait time in nanoseconds
+        std::atomic<uint64_t> max_wait_ns;
+        // The hold time histogram
+        std::atomic<uint64_t> hold_histogram[mutex_stats::hold_buckets];
+    };
+
+    /**
+     * Record a lock event in the trace, if tracing is enabled
+     *
+     * @param type the kind of the event
+     */
+    void trace(lock_trace::event_type type) noexcept {
+        if (tracing()) _trace->record(type, _trace_name);
+    }
+
+    // The statistics segment
+    std::shared_ptr<shared_memory> _memory;
+    // The counters in the statistics segment
+    data *_data;
+    // The trace ring, if the lock events are traced
+    lock_trace *_trace;
+    // The id of the mutex name in the trace ring
+    uint32_t _trace_name;
+};
+
+/**
+ * A stats policy for basic_shared_mutex which records nothing.
+ * Has the interface of mutex_stats_recorder, all calls compile to nothing.
+ */
+class no_mutex_stats {
+public:
+    // Nothing is ever recorded
+    static constexpr bool enabled = false;
+
+    /**
+     * A wait which is not tracked
+     */
+    class wait_scope {
+    public:
+        /**
+         * Start waiting
+         */
+        explicit constexpr wait_scope(no_mutex_stats *) noexcept {}
+
+        /**
+         * Record that the wait acquired the mutex
+         */
+        constexpr void acquired() noexcept {}
+    };
+
+    /**
+     * Open nothing
+     */
+    constexpr void open(const std::string &, bool = false, bool = false) noexcept {}
+
+    /**
+     * Record nothing
+     */
+    constexpr void acquired(bool = false) noexcept {}
+
+    /**
+     * Record nothing
+     */
+    constexpr void released(futex::clock::duration) noexcept {}
+
+    /**
+     * Record nothing
+     */
+    constexpr void try_lock_failed() noexcept {}
+
+    /**
+     * Whether the statistics are recorded
+     *
+     * @return false
+     */
+    [[nodiscard]] static constexpr bool recording() noexcept {
+        return false;
+    }
+
+    /**
+     * Whether the lock events are traced
+     *
+     * @return false
+     */
+    [[nodiscard]] static constexpr bool tracing() noexcept {
+        return false;
+    }
+
+    /**
+     * Get the current statistics
+     *
+     * @return all zero
+     */
+    [[nodiscard]] static mutex_stats snapshot() noexcept {
+        return {};
+    }
+};
+
+#endif //SHARED_MUTEX_MUTEX_STATS_HPP
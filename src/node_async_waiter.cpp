@@ -0,0 +1,208 @@
+#include "node_async_waiter.hpp"
+
+#include <cmath>
+#include <unordered_map>
+
+// The dispatchers of all environments
+static std::mutex dispatchers_mutex;
+static std::unordered_map<napi_env, std::shared_ptr<node_dispatcher>> dispatchers;
+
+std::shared_ptr<node_dispatcher> node_dispatcher::get(const Napi::Env &env) {
+    std::unique_lock<std::mutex> lock(dispatchers_mutex);
+    std::shared_ptr<node_dispatcher> &dispatcher = dispatchers[env];
+    if (!dispatcher) {
+        dispatcher = std::make_shared<node_dispatcher>(env);
+    }
+
+    return dispatcher;
+}
+
+node_dispatcher::node_dispatcher(const Napi::Env &env) : closed(false), pending(0) {
+    tsfn = Napi::ThreadSafeFunction::New(env, Napi::Function(), "shared_mutex", 0, 1);
+
+    // Don't keep the event loop alive while nothing is pending
+    tsfn.Unref(env);
+
+    // Cleanup hooks run in reverse order, so this runs before the thread safe function is finalized
+    napi_add_env_cleanup_hook(env, &node_dispatcher::cleanup, this);
+}
+
+bool node_dispatcher::dispatch(std::function<void(const Napi::Env &)> fn) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed) return false;
+
+    return tsfn.NonBlockingCall([fn = std::move(fn)](Napi::Env env, Napi::Function) {
+        fn(env);
+    }) == napi_ok;
+}
+
+void node_dispatcher::add_pending(const Napi::Env &env) {
+    if (pending++ == 0) {
+        tsfn.Ref(env);
+    }
+}
+
+void node_dispatcher::remove_pending(const Napi::Env &env) {
+    if (pending > 0 && --pending == 0) {
+        tsfn.Unref(env);
+    }
+}
+
+void node_dispatcher::cleanup(void *arg) {
+    auto *dispatcher = static_cast<node_dispatcher *>(arg);
+    {
+        std::unique_lock<std::mutex> lock(dispatcher->mtx);
+        dispatcher->closed = true;
+    }
+
+    // Keep the dispatcher alive, requests may still hold a pointer to it
+    std::unique_lock<std::mutex> lock(dispatchers_mutex);
+    for (auto it = dispatchers.begin(); it != dispatchers.end(); ++it) {
+        if (it->second.get() == dispatcher) {
+            dispatchers.erase(it);
+            break;
+        }
+    }
+}
+
+futex::clock::time_point convert_timeout(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsNumber()) {
+        throw Napi::TypeError::New(env, "The timeout must be of type number");
+    }
+
+    const double timeout = value.ToNumber().DoubleValue();
+    if (std::isnan(timeout)) {
+        throw Napi::RangeError::New(env, "The timeout must not be NaN");
+    }
+
+    return futex::deadline_after(std::chrono::duration<double, std::milli>(timeout));
+}
+
+wait_options convert_wait_options(const Napi::Env &env, const Napi::Value &value) {
+    wait_options options;
+    options.signal = env.Undefined();
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("timeout") && !obj.Get("timeout").IsUndefined()) {
+        options.deadline = convert_timeout(env, obj.Get("timeout"));
+    }
+
+    if (obj.Has("signal") && !obj.Get("signal").IsUndefined()) {
+        if (!obj.Get("signal").IsObject()) {
+            throw Napi::TypeError::New(env, "The signal must be an AbortSignal");
+        }
+
+        options.signal = obj.Get("signal");
+    }
+
+    return options;
+}
+
+Napi::Error abort_error(const Napi::Env &env, const std::string &operation) {
+    Napi::Error error = Napi::Error::New(env, "The " + operation + " operation was aborted");
+    error.Set("name", Napi::String::New(env, "AbortError"));
+    error.Set("code", Napi::String::New(env, "ABORT_ERR"));
+
+    return error;
+}
+
+struct node_wait_request::js_state {
+    // The deferred promise
+    Napi::Promise::Deferred deferred;
+    // The abort signal
+    Napi::ObjectReference signal;
+    // The abort listener
+    Napi::FunctionReference listener;
+};
+
+Napi::Promise node_wait_request::submit(const Napi::Env &env, const std::shared_ptr<node_wait_request> &request,
+                                        const Napi::Value &signal) {
+    auto *state = new js_state{Napi::Promise::Deferred::New(env), Napi::ObjectReference(),
+                               Napi::FunctionReference()};
+    const Napi::Promise promise = state->deferred.Promise();
+
+    if (signal.IsObject()) {
+        const Napi::Object obj = signal.ToObject();
+        if (obj.Get("aborted").ToBoolean().Value()) {
+            state->deferred.Reject(abort_error(env, request->operation()).Value());
+            delete state;
+            return promise;
+        }
+
+        // Cancel the request once the signal fires
+        std::weak_ptr<node_wait_request> weak = request;
+        state->listener = Napi::Persistent(Napi::Function::New(env, [weak](const Napi::CallbackInfo &) {
+            if (auto req = weak.lock()) {
+                req->cancel();
+            }
+        }));
+
+        state->signal = Napi::Persistent(obj);
+        obj.Get("addEventListener").As<Napi::Function>().Call(obj, {
+                Napi::String::New(env, "abort"), state->listener.Value()
+        });
+    }
+
+    request->js = state;
+    request->dispatcher = node_dispatcher::get(env);
+    request->dispatcher->add_pending(env);
+    async_waiter::instance().submit(request);
+
+    return promise;
+}
+
+Napi::Promise node_wait_request::resubmit(const Napi::Env &env, const std::shared_ptr<node_wait_request> &request) {
+    return submit(env, request, js->signal.IsEmpty() ? env.Undefined() : js->signal.Value());
+}
+
+void node_wait_request::finish(wait_status status, const std::string &error) {
+    std::shared_ptr<node_wait_request> self = shared_from_this();
+    const bool dispatched = dispatcher->dispatch([self, status, error](const Napi::Env &env) {
+        self->settle(env, status, error);
+    });
+
+    // The environment is shutting down, nobody will receive the result
+    if (!dispatched && status == wait_status::completed) {
+        discard();
+    }
+}
+
+void node_wait_request::settle(const Napi::Env &env, wait_status status, const std::string &error) {
+    Napi::HandleScope scope(env);
+    if (!js->signal.IsEmpty()) {
+        js->signal.Value().Get("removeEventListener").As<Napi::Function>().Call(js->signal.Value(), {
+                Napi::String::New(env, "abort"), js->listener.Value()
+        });
+    }
+
+    try {
+        switch (status) {
+            case wait_status::completed:
+                js->deferred.Resolve(result(env));
+                break;
+            case wait_status::timed_out: {
+                Napi::Error e = Napi::Error::New(env, "The " + operation() + " operation timed out");
+                e.Set("code", Napi::String::New(env, "ETIMEDOUT"));
+                js->deferred.Reject(e.Value());
+                break;
+            }
+            case wait_status::cancelled:
+                js->deferred.Reject(abort_error(env, operation()).Value());
+                break;
+            case wait_status::failed:
+                js->deferred.Reject(Napi::Error::New(env, error).Value());
+                break;
+        }
+    } catch (const Napi::Error &e) {
+        js->deferred.Reject(e.Value());
+    }
+
+    delete js;
+    js = nullptr;
+    dispatcher->remove_pending(env);
+}
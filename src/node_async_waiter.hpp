@@ -0,0 +1,194 @@
+#ifndef SHARED_MUTEX_NODE_ASYNC_WAITER_HPP
+#define SHARED_MUTEX_NODE_ASYNC_WAITER_HPP
+
+#include <napi.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "async_waiter.hpp"
+
+/**
+ * Calls functions on the JavaScript thread of an environment.
+ * Keeps the event loop alive while there are pending requests.
+ */
+class node_dispatcher {
+public:
+    /**
+     * Get the dispatcher of an environment.
+     * Must be called on the JavaScript thread.
+     *
+     * @param env the environment
+     * @return the dispatcher
+     */
+    static std::shared_ptr<node_dispatcher> get(const Napi::Env &env);
+
+    /**
+     * Call a function on the JavaScript thread. May be called from any thread.
+     *
+     * @param fn the function to call
+     * @return false if the environment is shutting down and the function will never be called
+     */
+    bool dispatch(std::function<void(const Napi::Env &)> fn);
+
+    /**
+     * Add a pending request. Keeps the event loop alive until
+     * all pending requests are removed. Must be called on the JavaScript thread.
+     *
+     * @param env the environment
+     */
+    void add_pending(const Napi::Env &env);
+
+    /**
+     * Remove a pending request. Must be called on the JavaScript thread.
+     *
+     * @param env the environment
+     */
+    void remove_pending(const Napi::Env &env);
+
+    /**
+     * Create a dispatcher
+     *
+     * @param env the environment
+     */
+    explicit node_dispatcher(const Napi::Env &env);
+
+private:
+    /**
+     * Stop dispatching calls, called when the environment is shutting down
+     *
+     * @param arg the dispatcher
+     */
+    static void cleanup(void *arg);
+
+    // The thread safe function calling the dispatched functions
+    Napi::ThreadSafeFunction tsfn;
+    // The mutex guarding closed
+    std::mutex mtx;
+    // Whether the environment is shutting down
+    bool closed;
+    // The number of pending requests
+    size_t pending;
+};
+
+/**
+ * The options of an async wait operation
+ */
+struct wait_options {
+    // The time point to stop waiting at
+    futex::clock::time_point deadline = futex::clock::time_point::max();
+    // The abort signal or undefined
+    Napi::Value signal;
+};
+
+/**
+ * Convert a timeout in milliseconds passed from javascript to a deadline.
+ * Negative timeouts don't wait, infinite or too large timeouts wait forever.
+ *
+ * @param env the environment
+ * @param value the timeout, must be a number
+ * @return the deadline
+ */
+futex::clock::time_point convert_timeout(const Napi::Env &env, const Napi::Value &value);
+
+/**
+ * Convert the options passed to an async wait operation
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+wait_options convert_wait_options(const Napi::Env &env, const Napi::Value &value);
+
+/**
+ * Create the error an operation rejects with if it was aborted
+ *
+ * @param env the environment
+ * @param operation the name of the operation
+ * @return the error
+ */
+Napi::Error abort_error(const Napi::Env &env, const std::string &operation);
+
+/**
+ * A wait request settling a promise once it finished
+ */
+class node_wait_request : public wait_request, public std::enable_shared_from_this<node_wait_request> {
+public:
+    /**
+     * Submit a request to the async waiter.
+     * Must be called on the JavaScript thread.
+     *
+     * @param env the environment
+     * @param request the request to submit
+     * @param signal the abort signal cancelling the request or undefined
+     * @return the promise settled once the request finished
+     */
+    static Napi::Promise submit(const Napi::Env &env, const std::shared_ptr<node_wait_request> &request,
+                                const Napi::Value &signal);
+
+protected:
+    /**
+     * Create a request
+     *
+     * @param deadline the time point to stop waiting at
+     */
+    explicit node_wait_request(futex::clock::time_point deadline) : wait_request(deadline), js(nullptr) {}
+
+    /**
+     * Create the value the promise resolves to.
+     * Called on the JavaScript thread.
+     *
+     * @param env the environment
+     * @return the result
+     */
+    [[nodiscard]] virtual Napi::Value result(const Napi::Env &env) = 0;
+
+    /**
+     * Submit a follow-up request with the abort signal of this request.
+     * May be called from result(), if the request can't produce its result
+     * yet. The promise of this request then settles with the follow-up.
+     *
+     * @param env the environment
+     * @param request the follow-up request
+     * @return the promise settled once the follow-up finished
+     */
+    [[nodiscard]] Napi::Promise resubmit(const Napi::Env &env, const std::shared_ptr<node_wait_request> &request);
+
+    /**
+     * Undo the request, if it completed but the promise
+     * can't be resolved anymore. Called on the waiter thread.
+     */
+    virtual void discard() {}
+
+    /**
+     * Get the name of the operation, used for error messages
+     *
+     * @return the operation name
+     */
+    [[nodiscard]] virtual std::string operation() const = 0;
+
+    void finish(wait_status status, const std::string &error) final;
+
+private:
+    /**
+     * The state of the request which may only be accessed on the JavaScript thread
+     */
+    struct js_state;
+
+    /**
+     * Settle the promise. Called on the JavaScript thread.
+     *
+     * @param env the environment
+     * @param status how the request finished
+     * @param error the error message, if the request failed
+     */
+    void settle(const Napi::Env &env, wait_status status, const std::string &error);
+
+    // The state only accessed on the JavaScript thread
+    js_state *js;
+    // The dispatcher settling the promise
+    std::shared_ptr<node_dispatcher> dispatcher;
+};
+
+#endif //SHARED_MUTEX_NODE_ASYNC_WAITER_HPP
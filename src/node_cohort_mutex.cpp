@@ -0,0 +1,191 @@
+#include "node_cohort_mutex.hpp"
+#include "node_shared_mutex.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The mutex is not initialized")
+
+/**
+ * A request locking a cohort mutex. Acquires the in-process
+ * lock first, then the cross-process mutex, if the cohort doesn't own it.
+ */
+class cohort_lock_request : public node_wait_request {
+public:
+    /**
+     * Create a lock request
+     *
+     * @param mutex the mutex to lock
+     * @param deadline the time point to stop waiting at
+     */
+    cohort_lock_request(std::shared_ptr<cohort_mutex> mutex, futex::clock::time_point deadline)
+            : node_wait_request(deadline), mutex(std::move(mutex)), registered(false), local(false),
+              global_waited(false), locked(false) {}
+
+    /**
+     * Release the in-process lock or stop waiting for it, if the mutex was never locked
+     */
+    ~cohort_lock_request() override {
+        if (locked) return;
+
+        if (local) {
+            mutex->unlock_local();
+        } else {
+            mutex->leave_local_wait(registered, false);
+        }
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool waited) override {
+        if (!local) {
+            if (!mutex->try_lock_local(waited)) return false;
+
+            mutex->leave_local_wait(registered, true);
+            local = true;
+        }
+
+        locked = mutex->try_lock_global(global_waited);
+        return locked;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        if (!local) return mutex->prepare_local_wait(registered, target);
+
+        const wait_preparation preparation = mutex->prepare_global_wait(target);
+        global_waited |= preparation == wait_preparation::wait;
+        return preparation;
+    }
+
+    void abandon_wait() override {
+        if (local && global_waited) mutex->abandon_global_wait();
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    void discard() override {
+        mutex->unlock();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "lock";
+    }
+
+private:
+    // The mutex to lock
+    std::shared_ptr<cohort_mutex> mutex;
+    // Whether the request is registered as a waiter for the in-process lock
+    bool registered;
+    // Whether the request acquired the in-process lock
+    bool local;
+    // Whether the request waited for the cross-process mutex
+    bool global_waited;
+    // Whether the request locked the mutex
+    bool locked;
+};
+
+void node_cohort_mutex::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "cohort_mutex", {
+            InstanceMethod("lock_blocking", &node_cohort_mutex::lockBlocking, napi_enumerable),
+            InstanceMethod("lock", &node_cohort_mutex::lock, napi_enumerable),
+            InstanceMethod("try_lock", &node_cohort_mutex::try_lock, napi_enumerable),
+            InstanceMethod("unlock", &node_cohort_mutex::unlock, napi_enumerable),
+            InstanceMethod("stats", &node_cohort_mutex::stats, napi_enumerable),
+            InstanceMethod("destroy", &node_cohort_mutex::destroy, napi_enumerable)
+    });
+
+    exports.Set("cohort_mutex", func);
+}
+
+/**
+ * Convert the options passed to the constructor
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+static cohort_mutex_options convert_options(const Napi::Env &env, const Napi::Value &value) {
+    cohort_mutex_options options;
+    options.global = convert_mutex_options(env, value);
+    if (value.IsObject() && value.ToObject().Has("max_handoffs") &&
+        !value.ToObject().Get("max_handoffs").IsUndefined()) {
+        const Napi::Value max_handoffs = value.ToObject().Get("max_handoffs");
+        if (!max_handoffs.IsNumber()) {
+            throw Napi::TypeError::New(env, "The max number of handoffs must be of type number");
+        }
+
+        options.max_handoffs = max_handoffs.ToNumber().Uint32Value();
+    }
+
+    return options;
+}
+
+node_cohort_mutex::node_cohort_mutex(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    const cohort_mutex_options options = convert_options(info.Env(), info[1]);
+
+    TRY
+        instance = std::make_shared<cohort_mutex>(name, options);
+    CATCH_EXCEPTIONS
+}
+
+void node_cohort_mutex::lockBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->lock();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_cohort_mutex::lock(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The mutex is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<cohort_lock_request>(instance, options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_cohort_mutex::try_lock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->try_lock());
+    CATCH_EXCEPTIONS
+}
+
+void node_cohort_mutex::unlock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->unlock();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_cohort_mutex::stats(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    const cohort_stats stats = instance->stats();
+    Napi::Object result = Napi::Object::New(info.Env());
+    result.Set("global_acquisitions", Napi::Number::New(info.Env(), static_cast<double>(stats.global_acquisitions)));
+    result.Set("local_handoffs", Napi::Number::New(info.Env(), static_cast<double>(stats.local_handoffs)));
+
+    return result;
+}
+
+void node_cohort_mutex::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+node_cohort_mutex::~node_cohort_mutex() = default;
@@ -0,0 +1,84 @@
+#ifndef SHARED_MUTEX_NODE_COHORT_MUTEX_HPP
+#define SHARED_MUTEX_NODE_COHORT_MUTEX_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "cohort_mutex.hpp"
+
+/**
+ * A node cohort_mutex wrapper class
+ */
+class node_cohort_mutex : public Napi::ObjectWrap<node_cohort_mutex> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a cohort_mutex wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_cohort_mutex(const Napi::CallbackInfo &info);
+
+    /**
+     * Lock the mutex. Blocking call.
+     *
+     * @param info the callback info
+     */
+    void lockBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Lock the mutex. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Try locking the mutex
+     *
+     * @param info the callback info
+     * @return true, if the mutex could be locked
+     */
+    Napi::Value try_lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Unlock the mutex
+     *
+     * @param info the callback info
+     */
+    void unlock(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of cross-process acquisitions and local handoffs
+     *
+     * @param info the callback info
+     * @return the cohort statistics
+     */
+    Napi::Value stats(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the mutex
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the mutex
+     */
+    ~node_cohort_mutex() override;
+
+private:
+    // The cohort_mutex instance
+    std::shared_ptr<cohort_mutex> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_COHORT_MUTEX_HPP
@@ -0,0 +1,218 @@
+#include "node_lease_mutex.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The mutex is not initialized")
+
+/**
+ * A request acquiring a lease. Takes the lease over once it expired.
+ */
+class lease_lock_request : public node_wait_request {
+public:
+    /**
+     * Create a lock request
+     *
+     * @param mutex the mutex to lock
+     * @param ttl the time to live of the lease
+     * @param deadline the time point to stop waiting at
+     */
+    lease_lock_request(std::shared_ptr<lease_mutex> mutex, futex::clock::duration ttl,
+                       futex::clock::time_point deadline)
+            : node_wait_request(deadline), mutex(std::move(mutex)), ttl(ttl), registered(false), token(0) {}
+
+    /**
+     * Stop waiting, if the request is still registered as a waiter
+     */
+    ~lease_lock_request() override {
+        mutex->leave_wait(registered, false);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (!mutex->try_lock(ttl)) return false;
+
+        token = mutex->token();
+        mutex->leave_wait(registered, true);
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return mutex->prepare_wait(registered, target);
+    }
+
+    void abandon_wait() override {
+        mutex->leave_wait(registered, false);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return Napi::BigInt::New(env, token);
+    }
+
+    void discard() override {
+        (void) mutex->unlock();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "lock";
+    }
+
+private:
+    // The mutex to lock
+    std::shared_ptr<lease_mutex> mutex;
+    // The time to live of the lease
+    futex::clock::duration ttl;
+    // Whether the request is registered as a waiter
+    bool registered;
+    // The fencing token of the acquired lease
+    uint64_t token;
+};
+
+void node_lease_mutex::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "lease_mutex", {
+            InstanceMethod("lock_blocking", &node_lease_mutex::lockBlocking, napi_enumerable),
+            InstanceMethod("lock", &node_lease_mutex::lock, napi_enumerable),
+            InstanceMethod("try_lock", &node_lease_mutex::try_lock, napi_enumerable),
+            InstanceMethod("renew", &node_lease_mutex::renew, napi_enumerable),
+            InstanceMethod("unlock", &node_lease_mutex::unlock, napi_enumerable),
+            InstanceMethod("held", &node_lease_mutex::held, napi_enumerable),
+            InstanceMethod("is_current", &node_lease_mutex::is_current, napi_enumerable),
+            InstanceMethod("destroy", &node_lease_mutex::destroy, napi_enumerable)
+    });
+
+    exports.Set("lease_mutex", func);
+}
+
+/**
+ * Convert a time to live in milliseconds
+ *
+ * @param env the environment
+ * @param value the time to live
+ * @return the converted time to live
+ */
+static futex::clock::duration convert_ttl(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsNumber()) {
+        throw Napi::TypeError::New(env, "The ttl must be of type number");
+    }
+
+    const double ttl = value.ToNumber().DoubleValue();
+    if (!(ttl > 0)) {
+        throw Napi::RangeError::New(env, "The ttl must be greater than zero");
+    }
+
+    // Limit the ttl to about 30 years, so it can be represented in nanoseconds
+    return std::chrono::ceil<futex::clock::duration>(std::chrono::duration<double, std::milli>(std::min(ttl, 1e12)));
+}
+
+node_lease_mutex::node_lease_mutex(const Napi::CallbackInfo &info) : ObjectWrap(info),
+                                                                     ttl(std::chrono::seconds(30)) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+
+    if (!info[1].IsUndefined() && !info[1].IsNull()) {
+        if (!info[1].IsObject()) {
+            throw Napi::TypeError::New(info.Env(), "The options must be of type object");
+        }
+
+        const Napi::Object obj = info[1].ToObject();
+        if (obj.Has("ttl") && !obj.Get("ttl").IsUndefined()) {
+            ttl = convert_ttl(info.Env(), obj.Get("ttl"));
+        }
+    }
+
+    TRY
+        instance = std::make_shared<lease_mutex>(name);
+    CATCH_EXCEPTIONS
+}
+
+futex::clock::duration node_lease_mutex::get_ttl(const Napi::Env &env, const Napi::Value &value) const {
+    if (value.IsUndefined()) return ttl;
+
+    return convert_ttl(env, value);
+}
+
+Napi::Value node_lease_mutex::lockBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const futex::clock::duration lease_ttl = get_ttl(info.Env(), info[0]);
+
+    TRY
+        return Napi::BigInt::New(info.Env(), instance->lock(lease_ttl));
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lease_mutex::lock(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    futex::clock::duration lease_ttl = ttl;
+    if (info[0].IsObject() && info[0].ToObject().Has("ttl")) {
+        lease_ttl = get_ttl(info.Env(), info[0].ToObject().Get("ttl"));
+    }
+
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The mutex is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<lease_lock_request>(instance, lease_ttl,
+                                                                                      options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_lease_mutex::try_lock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const futex::clock::duration lease_ttl = get_ttl(info.Env(), info[0]);
+
+    TRY
+        if (!instance->try_lock(lease_ttl)) return info.Env().Null();
+
+        return Napi::BigInt::New(info.Env(), instance->token());
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lease_mutex::renew(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const futex::clock::duration lease_ttl = get_ttl(info.Env(), info[0]);
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->renew(lease_ttl));
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lease_mutex::unlock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        const bool released = instance->unlock();
+        async_waiter::instance().notify_if_waiting();
+
+        return Napi::Boolean::New(info.Env(), released);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lease_mutex::held(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Boolean::New(info.Env(), instance->held());
+}
+
+Napi::Value node_lease_mutex::is_current(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    if (!info[0].IsBigInt()) {
+        throw Napi::TypeError::New(info.Env(), "The token must be of type bigint");
+    }
+
+    bool lossless;
+    const uint64_t token = info[0].As<Napi::BigInt>().Uint64Value(&lossless);
+
+    return Napi::Boolean::New(info.Env(), lossless && instance->is_current(token));
+}
+
+void node_lease_mutex::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_lease_mutex::~node_lease_mutex() = default;
@@ -0,0 +1,113 @@
+#ifndef SHARED_MUTEX_NODE_LEASE_MUTEX_HPP
+#define SHARED_MUTEX_NODE_LEASE_MUTEX_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "lease_mutex.hpp"
+
+/**
+ * A node lease_mutex wrapper class
+ */
+class node_lease_mutex : public Napi::ObjectWrap<node_lease_mutex> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a lease_mutex wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_lease_mutex(const Napi::CallbackInfo &info);
+
+    /**
+     * Acquire a lease. Blocking call.
+     *
+     * @param info the callback info
+     * @return the fencing token of the lease
+     */
+    Napi::Value lockBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Acquire a lease. Async call.
+     *
+     * @param info the callback info
+     * @return the promise resolving to the fencing token
+     */
+    Napi::Value lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Try acquiring a lease
+     *
+     * @param info the callback info
+     * @return the fencing token or null if the lease is held by someone else
+     */
+    Napi::Value try_lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Extend the lease held by this instance
+     *
+     * @param info the callback info
+     * @return false if the lease was lost
+     */
+    Napi::Value renew(const Napi::CallbackInfo &info);
+
+    /**
+     * Release the lease held by this instance
+     *
+     * @param info the callback info
+     * @return false if the lease was taken over after it expired
+     */
+    Napi::Value unlock(const Napi::CallbackInfo &info);
+
+    /**
+     * Check whether this instance still holds the lease
+     *
+     * @param info the callback info
+     * @return true if the lease is held and didn't expire
+     */
+    Napi::Value held(const Napi::CallbackInfo &info);
+
+    /**
+     * Check whether a fencing token belongs to the current lease
+     *
+     * @param info the callback info
+     * @return true if the token is current
+     */
+    Napi::Value is_current(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the mutex
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the mutex
+     */
+    ~node_lease_mutex() override;
+
+private:
+    /**
+     * Get the time to live passed to an operation
+     *
+     * @param env the environment
+     * @param value the time to live in milliseconds or undefined
+     * @return the time to live
+     */
+    futex::clock::duration get_ttl(const Napi::Env &env, const Napi::Value &value) const;
+
+    // The lease_mutex instance
+    std::shared_ptr<lease_mutex> instance;
+    // The time to live of leases if none is passed
+    futex::clock::duration ttl;
+};
+
+#endif //SHARED_MUTEX_NODE_LEASE_MUTEX_HPP
@@ -0,0 +1,193 @@
+#include "node_lock_table.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The lock table is not initialized")
+
+/**
+ * A request locking a key of a lock table
+ */
+class table_lock_request : public node_wait_request {
+public:
+    /**
+     * Create a lock request
+     *
+     * @param table the table to lock the key in
+     * @param key the key to lock
+     * @param deadline the time point to stop waiting at
+     */
+    table_lock_request(std::shared_ptr<lock_table> table, std::string key, futex::clock::time_point deadline)
+            : node_wait_request(deadline), table(std::move(table)), key(std::move(key)), entry(), locked(false) {}
+
+    /**
+     * Leave the slot of the key, if it was never locked
+     */
+    ~table_lock_request() override {
+        if (!locked) table->leave(entry);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool waited) override {
+        locked = table->try_lock(key, entry, waited);
+        return locked;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return table->prepare_wait(entry, target);
+    }
+
+    void abandon_wait() override {
+        table->abandon_wait(entry);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    void discard() override {
+        table->unlock(key);
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "lock";
+    }
+
+private:
+    // The table to lock the key in
+    std::shared_ptr<lock_table> table;
+    // The key to lock
+    std::string key;
+    // The slot of the key
+    lock_table::entry entry;
+    // Whether the key was locked
+    bool locked;
+};
+
+void node_lock_table::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "lock_table", {
+            InstanceMethod("lock_blocking", &node_lock_table::lockBlocking, napi_enumerable),
+            InstanceMethod("lock", &node_lock_table::lock, napi_enumerable),
+            InstanceMethod("try_lock", &node_lock_table::try_lock, napi_enumerable),
+            InstanceMethod("unlock", &node_lock_table::unlock, napi_enumerable),
+            InstanceMethod("home_slot", &node_lock_table::home_slot, napi_enumerable),
+            InstanceMethod("destroy", &node_lock_table::destroy, napi_enumerable)
+    });
+
+    exports.Set("lock_table", func);
+}
+
+/**
+ * Convert the options passed to the constructor
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+static lock_table_options convert_options(const Napi::Env &env, const Napi::Value &value) {
+    lock_table_options options;
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("slots") && !obj.Get("slots").IsUndefined()) {
+        if (!obj.Get("slots").IsNumber()) {
+            throw Napi::TypeError::New(env, "The number of slots must be of type number");
+        }
+
+        options.slots = obj.Get("slots").ToNumber().Uint32Value();
+    }
+
+    if (obj.Has("detect_collisions") && !obj.Get("detect_collisions").IsUndefined()) {
+        options.detect_collisions = obj.Get("detect_collisions").ToBoolean().Value();
+    }
+
+    return options;
+}
+
+/**
+ * Get the key passed to a method
+ *
+ * @param info the callback info
+ * @return the key
+ */
+static std::string get_key(const Napi::CallbackInfo &info) {
+    if (!info[0].IsString()) {
+        throw Napi::TypeError::New(info.Env(), "The key must be of type string");
+    }
+
+    return info[0].ToString().Utf8Value();
+}
+
+node_lock_table::node_lock_table(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    const lock_table_options options = convert_options(info.Env(), info[1]);
+
+    TRY
+        instance = std::make_shared<lock_table>(name, options);
+    CATCH_EXCEPTIONS
+}
+
+void node_lock_table::lockBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const std::string key = get_key(info);
+
+    TRY
+        instance->lock(key);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lock_table::lock(const Napi::CallbackInfo &info) {
+    const std::string key = get_key(info);
+    const wait_options options = convert_wait_options(info.Env(), info[1]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The lock table is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<table_lock_request>(instance, key,
+                                                                                      options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_lock_table::try_lock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const std::string key = get_key(info);
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->try_lock(key));
+    CATCH_EXCEPTIONS
+}
+
+void node_lock_table::unlock(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const std::string key = get_key(info);
+
+    TRY
+        instance->unlock(key);
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_lock_table::home_slot(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const std::string key = get_key(info);
+
+    return Napi::Number::New(info.Env(), instance->home_slot(key));
+}
+
+void node_lock_table::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+node_lock_table::~node_lock_table() = default;
@@ -0,0 +1,84 @@
+#ifndef SHARED_MUTEX_NODE_LOCK_TABLE_HPP
+#define SHARED_MUTEX_NODE_LOCK_TABLE_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "lock_table.hpp"
+
+/**
+ * A node lock_table wrapper class
+ */
+class node_lock_table : public Napi::ObjectWrap<node_lock_table> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a lock_table wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_lock_table(const Napi::CallbackInfo &info);
+
+    /**
+     * Lock a key. Blocking call.
+     *
+     * @param info the callback info
+     */
+    void lockBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Lock a key. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Try locking a key
+     *
+     * @param info the callback info
+     * @return true, if the key could be locked
+     */
+    Napi::Value try_lock(const Napi::CallbackInfo &info);
+
+    /**
+     * Unlock a key
+     *
+     * @param info the callback info
+     */
+    void unlock(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the slot a key is hashed onto
+     *
+     * @param info the callback info
+     * @return the index of the slot
+     */
+    Napi::Value home_slot(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the lock table
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the lock table
+     */
+    ~node_lock_table() override;
+
+private:
+    // The lock_table instance
+    std::shared_ptr<lock_table> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_LOCK_TABLE_HPP
@@ -0,0 +1,143 @@
+#include "node_shared_barrier.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The barrier is not initialized")
+
+/**
+ * A request waiting for the phase it arrived in to complete
+ */
+class barrier_wait_request : public node_wait_request {
+public:
+    /**
+     * Create a wait request. The arrival must have been made already.
+     *
+     * @param barrier the barrier to wait for
+     * @param token the phase the arrival was made in
+     * @param deadline the time point to stop waiting at
+     */
+    barrier_wait_request(std::shared_ptr<shared_barrier> barrier, uint32_t token, futex::clock::time_point deadline)
+            : node_wait_request(deadline), barrier(std::move(barrier)), token(token), arrived(true) {}
+
+    /**
+     * Withdraw the arrival, if the request was cancelled before it waited
+     */
+    ~barrier_wait_request() override {
+        abandon_wait();
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (!barrier->completed(token)) return false;
+
+        arrived = false;
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return barrier->prepare_wait(token, target);
+    }
+
+    void abandon_wait() override {
+        // The phase may have completed in the meantime, the arrival can't be withdrawn then
+        if (arrived) barrier->withdraw(token);
+        arrived = false;
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "wait";
+    }
+
+private:
+    // The barrier to wait for
+    std::shared_ptr<shared_barrier> barrier;
+    // The phase the arrival was made in
+    uint32_t token;
+    // Whether the arrival was neither completed nor withdrawn yet
+    bool arrived;
+};
+
+void node_shared_barrier::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_barrier", {
+            InstanceMethod("wait_blocking", &node_shared_barrier::waitBlocking, napi_enumerable),
+            InstanceMethod("wait", &node_shared_barrier::wait, napi_enumerable),
+            InstanceMethod("count", &node_shared_barrier::count, napi_enumerable),
+            InstanceMethod("arrived", &node_shared_barrier::arrived, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_barrier::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_barrier", func);
+}
+
+node_shared_barrier::node_shared_barrier(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string, napi_tools::number);
+    const std::string name = info[0].ToString().Utf8Value();
+    const uint32_t count = info[1].ToNumber().Uint32Value();
+
+    TRY
+        instance = std::make_shared<shared_barrier>(name, count);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_barrier::waitBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    auto deadline = futex::clock::time_point::max();
+    if (info[0].IsNumber()) {
+        deadline = convert_timeout(info.Env(), info[0]);
+    } else if (!info[0].IsUndefined()) {
+        throw Napi::TypeError::New(info.Env(), "The timeout must be of type number");
+    }
+
+    TRY
+        // Arriving may complete the phase other requests of this process wait for
+        const uint32_t token = instance->arrive();
+        async_waiter::instance().notify_if_waiting();
+
+        return Napi::Boolean::New(info.Env(), instance->timed_wait(token, deadline));
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_barrier::wait(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The barrier is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    // Arrive right away, so the arrival is visible before the promise is awaited
+    const uint32_t token = instance->arrive();
+    async_waiter::instance().notify_if_waiting();
+
+    return node_wait_request::submit(info.Env(), std::make_shared<barrier_wait_request>(instance, token,
+                                                                                        options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_shared_barrier::count(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->count());
+}
+
+Napi::Value node_shared_barrier::arrived(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->arrived());
+}
+
+void node_shared_barrier::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_barrier::~node_shared_barrier() = default;
@@ -0,0 +1,78 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_BARRIER_HPP
+#define SHARED_MUTEX_NODE_SHARED_BARRIER_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_barrier.hpp"
+
+/**
+ * A node shared_barrier wrapper class
+ */
+class node_shared_barrier : public Napi::ObjectWrap<node_shared_barrier> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_barrier wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_barrier(const Napi::CallbackInfo &info);
+
+    /**
+     * Arrive at the barrier and wait for all participants. Blocking call.
+     *
+     * @param info the callback info
+     * @return false if the timeout was reached
+     */
+    Napi::Value waitBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Arrive at the barrier and wait for all participants. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of participants
+     *
+     * @param info the callback info
+     * @return the number of participants
+     */
+    Napi::Value count(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of participants which arrived in the current phase
+     *
+     * @param info the callback info
+     * @return the number of arrived participants
+     */
+    Napi::Value arrived(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the barrier
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the barrier
+     */
+    ~node_shared_barrier() override;
+
+private:
+    // The shared_barrier instance
+    std::shared_ptr<shared_barrier> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_BARRIER_HPP
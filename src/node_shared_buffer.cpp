@@ -0,0 +1,95 @@
+#include "node_shared_buffer.hpp"
+#include "node_shared_mutex.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The buffer is not initialized")
+
+void node_shared_buffer::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_buffer", {
+            InstanceMethod("buffer", &node_shared_buffer::buffer, napi_enumerable),
+            InstanceMethod("size", &node_shared_buffer::size, napi_enumerable),
+            InstanceMethod("grow", &node_shared_buffer::grow, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_buffer::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_buffer", func);
+}
+
+/**
+ * Get the size passed to an operation
+ *
+ * @param env the environment
+ * @param value the size in bytes
+ * @return the size
+ */
+static size_t get_size(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsNumber()) {
+        throw Napi::TypeError::New(env, "The size must be of type number");
+    }
+
+    const double size = value.ToNumber().DoubleValue();
+    if (!(size >= 1) || size > static_cast<double>(shared_buffer::max_size)) {
+        throw Napi::RangeError::New(env, "The size must be between 1 and " +
+                                         std::to_string(shared_buffer::max_size) + " bytes");
+    }
+
+    return static_cast<size_t>(size);
+}
+
+node_shared_buffer::node_shared_buffer(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string, napi_tools::number);
+    const std::string name = info[0].ToString().Utf8Value();
+    const size_t size = get_size(info.Env(), info[1]);
+
+    // The mutex uses the name of the buffer, it has its own segments
+    const Napi::Object mutex = node_shared_mutex::create(info.Env(), info[0], info[2]);
+    Value().DefineProperty(Napi::PropertyDescriptor::Value("mutex", mutex, napi_enumerable));
+
+    TRY
+        instance = std::make_shared<shared_buffer>(name, size);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_buffer::buffer(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        std::shared_ptr<shared_memory> mapping = instance->mapping();
+        const size_t length = std::min(instance->size(), mapping->size());
+
+        // The ArrayBuffer keeps the mapping alive until it is garbage collected
+        auto *hint = new std::shared_ptr<shared_memory>(std::move(mapping));
+        return Napi::ArrayBuffer::New(info.Env(), (*hint)->data(), length, [](Napi::Env, void *,
+                                                                              std::shared_ptr<shared_memory> *h) {
+            delete h;
+        }, hint);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_buffer::size(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), static_cast<double>(instance->size()));
+}
+
+void node_shared_buffer::grow(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const size_t size = get_size(info.Env(), info[0]);
+
+    TRY
+        instance->grow(size);
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_buffer::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+
+    const Napi::Object mutex = Value().Get("mutex").ToObject();
+    mutex.Get("destroy").As<Napi::Function>().Call(mutex, {});
+}
+
+node_shared_buffer::~node_shared_buffer() = default;
@@ -0,0 +1,69 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_BUFFER_HPP
+#define SHARED_MUTEX_NODE_SHARED_BUFFER_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_buffer.hpp"
+
+/**
+ * A node shared_buffer wrapper class
+ */
+class node_shared_buffer : public Napi::ObjectWrap<node_shared_buffer> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_buffer wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_buffer(const Napi::CallbackInfo &info);
+
+    /**
+     * Get an ArrayBuffer backed by the shared memory
+     *
+     * @param info the callback info
+     * @return the ArrayBuffer
+     */
+    Napi::Value buffer(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the size of the buffer
+     *
+     * @param info the callback info
+     * @return the size in bytes
+     */
+    Napi::Value size(const Napi::CallbackInfo &info);
+
+    /**
+     * Grow the buffer
+     *
+     * @param info the callback info
+     */
+    void grow(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the buffer and its mutex
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the buffer
+     */
+    ~node_shared_buffer() override;
+
+private:
+    // The shared_buffer instance
+    std::shared_ptr<shared_buffer> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_BUFFER_HPP
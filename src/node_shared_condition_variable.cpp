@@ -0,0 +1,203 @@
+#include "node_shared_condition_variable.hpp"
+#include "node_shared_mutex.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The condition variable is not initialized")
+
+/**
+ * A request waiting for a notification, then locking the mutex again
+ */
+class condition_wait_request : public node_wait_request {
+public:
+    /**
+     * Create a wait request. The request must be registered
+     * as a waiter and the mutex unlocked before it is submitted.
+     *
+     * @param condition the condition variable to wait on
+     * @param mutex the mutex to lock once notified
+     * @param sequence the sequence number returned by begin_wait()
+     * @param wait_deadline the time point to stop waiting for a notification at
+     */
+    condition_wait_request(std::shared_ptr<shared_condition_variable> condition, std::shared_ptr<shared_mutex> mutex,
+                           uint32_t sequence, futex::clock::time_point wait_deadline)
+            : node_wait_request(futex::clock::time_point::max()), condition(std::move(condition)),
+              mutex(std::move(mutex)), sequence(sequence), wait_deadline(wait_deadline), waiting(true),
+              mutex_waited(false), notified(false) {}
+
+    /**
+     * Unregister the request, if it is still waiting for a notification
+     */
+    ~condition_wait_request() override {
+        if (waiting) condition->end_wait();
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (waiting) {
+            notified = condition->notified_since(sequence);
+            if (!notified && futex::clock::now() < wait_deadline) return false;
+
+            // The mutex is locked again after a timeout, too
+            condition->end_wait();
+            waiting = false;
+        }
+
+        return mutex_waited ? mutex->try_lock_after_wait(false) : mutex->try_acquire(false);
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        if (waiting) {
+            const wait_preparation preparation = condition->prepare_wait(sequence, target);
+            target.recheck = wait_deadline;
+            return preparation;
+        }
+
+        const wait_preparation preparation = mutex->prepare_wait(false, target);
+        mutex_waited |= preparation == wait_preparation::wait;
+        return preparation;
+    }
+
+    void abandon_wait() override {
+        if (mutex_waited) mutex->abandon_wait(false);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return Napi::Boolean::New(env, notified);
+    }
+
+    void discard() override {
+        mutex->unlock();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "wait";
+    }
+
+private:
+    // The condition variable to wait on
+    std::shared_ptr<shared_condition_variable> condition;
+    // The mutex to lock once notified
+    std::shared_ptr<shared_mutex> mutex;
+    // The sequence number returned by begin_wait()
+    const uint32_t sequence;
+    // The time point to stop waiting for a notification at
+    const futex::clock::time_point wait_deadline;
+    // Whether the request is waiting for a notification
+    bool waiting;
+    // Whether the request waited for the mutex
+    bool mutex_waited;
+    // Whether the condition variable was notified
+    bool notified;
+};
+
+void node_shared_condition_variable::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_condition_variable", {
+            InstanceMethod("wait_blocking", &node_shared_condition_variable::waitBlocking, napi_enumerable),
+            InstanceMethod("wait", &node_shared_condition_variable::wait, napi_enumerable),
+            InstanceMethod("notify_one", &node_shared_condition_variable::notify_one, napi_enumerable),
+            InstanceMethod("notify_all", &node_shared_condition_variable::notify_all, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_condition_variable::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_condition_variable", func);
+}
+
+/**
+ * Get the mutex passed to a wait operation, which must be locked
+ *
+ * @param env the environment
+ * @param value the shared_mutex object
+ * @return the mutex
+ */
+static std::shared_ptr<shared_mutex> locked_mutex(const Napi::Env &env, const Napi::Value &value) {
+    std::shared_ptr<shared_mutex> mutex = node_shared_mutex::unwrap(env, value);
+    if (!mutex->locked()) {
+        throw Napi::Error::New(env, "The mutex must be locked by this instance");
+    }
+
+    return mutex;
+}
+
+node_shared_condition_variable::node_shared_condition_variable(const Napi::CallbackInfo &info)
+        : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+
+    TRY
+        instance = std::make_shared<shared_condition_variable>(name);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_condition_variable::waitBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const std::shared_ptr<shared_mutex> mutex = locked_mutex(info.Env(), info[0]);
+
+    auto deadline = futex::clock::time_point::max();
+    if (info[1].IsNumber()) {
+        deadline = convert_timeout(info.Env(), info[1]);
+    } else if (!info[1].IsUndefined()) {
+        throw Napi::TypeError::New(info.Env(), "The timeout must be of type number");
+    }
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->timed_wait(*mutex, deadline));
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_condition_variable::wait(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[1]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The condition variable is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    const std::shared_ptr<shared_mutex> mutex = locked_mutex(info.Env(), info[0]);
+    if (mutex->thread_owned()) {
+        // The mutex would be locked again on the waiter thread, which can't unlock it
+        throw Napi::Error::New(info.Env(), "Mutexes owned by threads can only be used with wait_blocking()");
+    }
+
+    const uint32_t sequence = instance->begin_wait();
+
+    try {
+        mutex->unlock();
+    } catch (const std::exception &e) {
+        instance->end_wait();
+        throw Napi::Error::New(info.Env(), e.what());
+    }
+
+    async_waiter::instance().notify_if_waiting();
+    return node_wait_request::submit(info.Env(), std::make_shared<condition_wait_request>(
+            instance, mutex, sequence, options.deadline), options.signal);
+}
+
+void node_shared_condition_variable::notify_one(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->notify_one();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_condition_variable::notify_all(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->notify_all();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_condition_variable::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_condition_variable::~node_shared_condition_variable() = default;
@@ -0,0 +1,76 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_CONDITION_VARIABLE_HPP
+#define SHARED_MUTEX_NODE_SHARED_CONDITION_VARIABLE_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_condition_variable.hpp"
+
+/**
+ * A node shared_condition_variable wrapper class
+ */
+class node_shared_condition_variable : public Napi::ObjectWrap<node_shared_condition_variable> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_condition_variable wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_condition_variable(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait for a notification. Blocking call.
+     *
+     * @param info the callback info
+     * @return false if the timeout was reached
+     */
+    Napi::Value waitBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait for a notification. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Wake up one waiter
+     *
+     * @param info the callback info
+     */
+    void notify_one(const Napi::CallbackInfo &info);
+
+    /**
+     * Wake up all waiters
+     *
+     * @param info the callback info
+     */
+    void notify_all(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the condition variable
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the condition variable
+     */
+    ~node_shared_condition_variable() override;
+
+private:
+    // The shared_condition_variable instance
+    std::shared_ptr<shared_condition_variable> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_CONDITION_VARIABLE_HPP
@@ -0,0 +1,164 @@
+#include "node_shared_event.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The event is not initialized")
+
+/**
+ * A request waiting for an event to be set
+ */
+class event_wait_request : public node_wait_request {
+public:
+    /**
+     * Create a wait request
+     *
+     * @param event the event to wait for
+     * @param deadline the time point to stop waiting at
+     */
+    event_wait_request(std::shared_ptr<shared_event> event, futex::clock::time_point deadline)
+            : node_wait_request(deadline), event(std::move(event)), registered(false) {}
+
+    /**
+     * Stop waiting, if the request is still registered as a waiter
+     */
+    ~event_wait_request() override {
+        event->leave_wait(registered, false);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (!event->try_wait()) return false;
+
+        event->leave_wait(registered, true);
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return event->prepare_wait(registered, target);
+    }
+
+    void abandon_wait() override {
+        event->leave_wait(registered, false);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    void discard() override {
+        // Hand an auto reset event to the next waiter
+        if (!event->manual_reset()) event->set();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "wait";
+    }
+
+private:
+    // The event to wait for
+    std::shared_ptr<shared_event> event;
+    // Whether the request is registered as a waiter
+    bool registered;
+};
+
+void node_shared_event::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_event", {
+            InstanceMethod("set", &node_shared_event::set, napi_enumerable),
+            InstanceMethod("reset", &node_shared_event::reset, napi_enumerable),
+            InstanceMethod("try_wait", &node_shared_event::try_wait, napi_enumerable),
+            InstanceMethod("wait_blocking", &node_shared_event::waitBlocking, napi_enumerable),
+            InstanceMethod("wait", &node_shared_event::wait, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_event::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_event", func);
+}
+
+/**
+ * Convert the options passed to the constructor
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+static shared_event_options convert_options(const Napi::Env &env, const Napi::Value &value) {
+    shared_event_options options;
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("manual_reset") && !obj.Get("manual_reset").IsUndefined()) {
+        options.manual_reset = obj.Get("manual_reset").ToBoolean().Value();
+    }
+
+    if (obj.Has("initially_set") && !obj.Get("initially_set").IsUndefined()) {
+        options.initially_set = obj.Get("initially_set").ToBoolean().Value();
+    }
+
+    return options;
+}
+
+node_shared_event::node_shared_event(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    const shared_event_options options = convert_options(info.Env(), info[1]);
+
+    TRY
+        instance = std::make_shared<shared_event>(name, options);
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_event::set(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->set();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_event::reset(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    instance->reset();
+}
+
+Napi::Value node_shared_event::try_wait(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Boolean::New(info.Env(), instance->try_wait());
+}
+
+void node_shared_event::waitBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->wait();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_event::wait(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The event is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<event_wait_request>(instance, options.deadline),
+                                     options.signal);
+}
+
+void node_shared_event::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_event::~node_shared_event() = default;
@@ -0,0 +1,83 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_EVENT_HPP
+#define SHARED_MUTEX_NODE_SHARED_EVENT_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_event.hpp"
+
+/**
+ * A node shared_event wrapper class
+ */
+class node_shared_event : public Napi::ObjectWrap<node_shared_event> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_event wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_event(const Napi::CallbackInfo &info);
+
+    /**
+     * Set the event
+     *
+     * @param info the callback info
+     */
+    void set(const Napi::CallbackInfo &info);
+
+    /**
+     * Reset the event
+     *
+     * @param info the callback info
+     */
+    void reset(const Napi::CallbackInfo &info);
+
+    /**
+     * Check whether the event is set
+     *
+     * @param info the callback info
+     * @return true if the event was set
+     */
+    Napi::Value try_wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait until the event is set. Blocking call.
+     *
+     * @param info the callback info
+     */
+    void waitBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait until the event is set. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the event
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the event
+     */
+    ~node_shared_event() override;
+
+private:
+    // The shared_event instance
+    std::shared_ptr<shared_event> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_EVENT_HPP
@@ -0,0 +1,130 @@
+#include "node_shared_latch.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The latch is not initialized")
+
+/**
+ * A request waiting for the counter of a latch to reach zero
+ */
+class latch_wait_request : public node_wait_request {
+public:
+    /**
+     * Create a wait request
+     *
+     * @param latch the latch to wait for
+     * @param deadline the time point to stop waiting at
+     */
+    latch_wait_request(std::shared_ptr<shared_latch> latch, futex::clock::time_point deadline)
+            : node_wait_request(deadline), latch(std::move(latch)) {}
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        return latch->try_wait();
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return latch->prepare_wait(target);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "wait";
+    }
+
+private:
+    // The latch to wait for
+    std::shared_ptr<shared_latch> latch;
+};
+
+void node_shared_latch::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_latch", {
+            InstanceMethod("count_down", &node_shared_latch::count_down, napi_enumerable),
+            InstanceMethod("try_wait", &node_shared_latch::try_wait, napi_enumerable),
+            InstanceMethod("wait_blocking", &node_shared_latch::waitBlocking, napi_enumerable),
+            InstanceMethod("wait", &node_shared_latch::wait, napi_enumerable),
+            InstanceMethod("count", &node_shared_latch::count, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_latch::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_latch", func);
+}
+
+node_shared_latch::node_shared_latch(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string, napi_tools::number);
+    const std::string name = info[0].ToString().Utf8Value();
+    const uint32_t count = info[1].ToNumber().Uint32Value();
+
+    TRY
+        instance = std::make_shared<shared_latch>(name, count);
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_latch::count_down(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    uint32_t n = 1;
+    if (info[0].IsNumber()) {
+        n = info[0].ToNumber().Uint32Value();
+    } else if (!info[0].IsUndefined()) {
+        throw Napi::TypeError::New(info.Env(), "The count must be of type number");
+    }
+
+    TRY
+        instance->count_down(n);
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_latch::try_wait(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Boolean::New(info.Env(), instance->try_wait());
+}
+
+Napi::Value node_shared_latch::waitBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    auto deadline = futex::clock::time_point::max();
+    if (info[0].IsNumber()) {
+        deadline = convert_timeout(info.Env(), info[0]);
+    } else if (!info[0].IsUndefined()) {
+        throw Napi::TypeError::New(info.Env(), "The timeout must be of type number");
+    }
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->timed_wait(deadline));
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_latch::wait(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The latch is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<latch_wait_request>(instance, options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_shared_latch::count(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->count());
+}
+
+void node_shared_latch::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_latch::~node_shared_latch() = default;
@@ -0,0 +1,85 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_LATCH_HPP
+#define SHARED_MUTEX_NODE_SHARED_LATCH_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_latch.hpp"
+
+/**
+ * A node shared_latch wrapper class
+ */
+class node_shared_latch : public Napi::ObjectWrap<node_shared_latch> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_latch wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_latch(const Napi::CallbackInfo &info);
+
+    /**
+     * Decrement the counter
+     *
+     * @param info the callback info
+     */
+    void count_down(const Napi::CallbackInfo &info);
+
+    /**
+     * Check whether the counter reached zero
+     *
+     * @param info the callback info
+     * @return true if the latch is open
+     */
+    Napi::Value try_wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait until the counter reaches zero. Blocking call.
+     *
+     * @param info the callback info
+     * @return false if the timeout was reached
+     */
+    Napi::Value waitBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Wait until the counter reaches zero. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value wait(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the current counter value
+     *
+     * @param info the callback info
+     * @return the counter value
+     */
+    Napi::Value count(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the latch
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the latch
+     */
+    ~node_shared_latch() override;
+
+private:
+    // The shared_latch instance
+    std::shared_ptr<shared_latch> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_LATCH_HPP
@@ -1,49 +1,393 @@
 #include "node_shared_mutex.hpp"
+#include "addon_data.hpp"
+#include "node_async_waiter.hpp"
+#include "lock_all.hpp"
 #include <napi_tools.hpp>
+#include <optional>
+#include <vector>
 
 #define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The mutex is not initialized")
 
+/**
+ * Create the object a lock operation resolves to
+ *
+ * @param env the environment
+ * @param inconsistent whether the previous owner died while holding the mutex
+ * @return the lock result
+ */
+static Napi::Object lock_result(const Napi::Env &env, bool inconsistent) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("inconsistent", Napi::Boolean::New(env, inconsistent));
+
+    return result;
+}
+
+/**
+ * A request locking a mutex
+ */
+class lock_request : public node_wait_request {
+public:
+    /**
+     * Create a lock request
+     *
+     * @param mutex the mutex to lock
+     * @param shared whether to lock the mutex in shared mode
+     * @param deadline the time point to stop waiting at
+     */
+    lock_request(std::shared_ptr<shared_mutex> mutex, bool shared, futex::clock::time_point deadline)
+            : node_wait_request(deadline), mutex(std::move(mutex)), shared(shared), inconsistent(false) {}
+
+protected:
+    [[nodiscard]] bool try_complete(bool waited) override {
+        // Thread owned mutexes are locked on the JavaScript thread, which will unlock them
+        if (mutex->thread_owned()) return mutex->appears_unlocked();
+
+        const bool locked = waited ? mutex->try_lock_after_wait(shared) : mutex->try_acquire(shared);
+        if (locked) {
+            inconsistent = mutex->owner_died();
+            if (wait) {
+                wait->acquired();
+                wait.reset();
+            }
+        } else if (!wait) {
+            // The mutex is contended, count this request as waiting
+            wait.emplace(mutex->track_wait());
+        }
+
+        return locked;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return mutex->prepare_wait(shared, target);
+    }
+
+    void abandon_wait() override {
+        mutex->abandon_wait(shared);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        if (mutex->thread_owned()) {
+            // Another thread may have locked the mutex since it was released, wait for it again
+            if (!mutex->try_acquire(shared)) {
+                return resubmit(env, std::make_shared<lock_request>(mutex, shared, deadline()));
+            }
+
+            inconsistent = mutex->owner_died();
+        }
+
+        return lock_result(env, inconsistent);
+    }
+
+    void discard() override {
+        if (mutex->thread_owned()) return;
+
+        if (shared) {
+            mutex->unlock_shared();
+        } else {
+            mutex->unlock();
+        }
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "lock";
+    }
+
+private:
+    // The mutex to lock
+    std::shared_ptr<shared_mutex> mutex;
+    // Whether to lock the mutex in shared mode
+    bool shared;
+    // Whether the previous owner died while holding the mutex
+    bool inconsistent;
+    // The wait recorded in the mutex statistics, while the mutex is contended
+    std::optional<mutex_stats_recorder::wait_scope> wait;
+};
+
+/**
+ * A request locking multiple mutexes at once. Waits for one mutex and tries to lock
+ * the others on the waiter thread. If one of them is contended, all mutexes locked
+ * so far are released and the request waits for the contended one instead.
+ */
+class lock_all_request : public node_wait_request {
+public:
+    /**
+     * Create a lock request
+     *
+     * @param mutexes the mutexes to lock, each must be passed at most once
+     * @param first the index of the mutex to wait for
+     * @param deadline the time point to stop waiting at
+     */
+    lock_all_request(std::vector<std::shared_ptr<shared_mutex>> mutexes, size_t first,
+                     futex::clock::time_point deadline)
+            : node_wait_request(deadline), mutexes(std::move(mutexes)), held(this->mutexes.size(), false),
+              inconsistent(this->mutexes.size(), false), first(first), waiting(false) {}
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        shared_mutex &mutex = *mutexes[first];
+        // Thread owned mutexes are locked on the JavaScript thread, which will unlock them
+        if (mutex.thread_owned()) return mutex.appears_unlocked();
+
+        if (!(waiting ? mutex.try_lock_after_wait(false) : mutex.try_acquire(false))) return false;
+
+        waiting = false;
+        acquired(first);
+        for (size_t n = 1; n < mutexes.size(); n++) {
+            const size_t i = (first + n) % mutexes.size();
+            if (mutexes[i]->thread_owned()) continue;
+
+            if (!mutexes[i]->try_acquire(false)) {
+                // Never hold a mutex while waiting for another one
+                release_all();
+                first = i;
+                return false;
+            }
+
+            acquired(i);
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        waiting = true;
+        return mutexes[first]->prepare_wait(false, target);
+    }
+
+    void abandon_wait() override {
+        if (waiting) mutexes[first]->abandon_wait(false);
+        waiting = false;
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        // Lock the thread owned mutexes on the thread which will unlock them
+        for (size_t n = 0; n < mutexes.size(); n++) {
+            const size_t i = (first + n) % mutexes.size();
+            if (held[i]) continue;
+
+            if (!mutexes[i]->try_acquire(false)) {
+                release_all();
+                return resubmit(env, std::make_shared<lock_all_request>(mutexes, i, deadline()));
+            }
+
+            acquired(i);
+        }
+
+        Napi::Array results = Napi::Array::New(env, mutexes.size());
+        for (size_t i = 0; i < mutexes.size(); i++) {
+            results.Set(static_cast<uint32_t>(i), lock_result(env, inconsistent[i]));
+        }
+
+        return results;
+    }
+
+    void discard() override {
+        release_all();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "lock_all";
+    }
+
+private:
+    /**
+     * Record that a mutex was locked by this request
+     *
+     * @param i the index of the mutex
+     */
+    void acquired(size_t i) {
+        held[i] = true;
+        inconsistent[i] = mutexes[i]->owner_died();
+    }
+
+    /**
+     * Unlock all mutexes locked by this request, in reverse order
+     */
+    void release_all() {
+        for (size_t i = mutexes.size(); i-- > 0;) {
+            if (!held[i]) continue;
+
+            mutexes[i]->unlock();
+            held[i] = false;
+        }
+
+        // Other requests of this process may wait for the released mutexes
+        async_waiter::instance().notify_if_waiting();
+    }
+
+    // The mutexes to lock
+    std::vector<std::shared_ptr<shared_mutex>> mutexes;
+    // Whether each mutex is locked by this request
+    std::vector<bool> held;
+    // Whether the previous owner of each mutex died while holding it
+    std::vector<bool> inconsistent;
+    // The index of the mutex to wait for
+    size_t first;
+    // Whether prepare_wait() was called on the mutex to wait for since it was last locked
+    bool waiting;
+};
+
 void node_shared_mutex::init(Napi::Env env, Napi::Object &exports) {
     Napi::Function func = DefineClass(env, "shared_mutex", {
             InstanceMethod("lock_blocking", &node_shared_mutex::lockBlocking, napi_enumerable),
             InstanceMethod("lock", &node_shared_mutex::lock, napi_enumerable),
             InstanceMethod("try_lock", &node_shared_mutex::try_lock, napi_enumerable),
             InstanceMethod("unlock", &node_shared_mutex::unlock, napi_enumerable),
-            InstanceMethod("destroy", &node_shared_mutex::destroy, napi_enumerable)
+            InstanceMethod("lock_shared", &node_shared_mutex::lock_shared, napi_enumerable),
+            InstanceMethod("try_lock_shared", &node_shared_mutex::try_lock_shared, napi_enumerable),
+            InstanceMethod("unlock_shared", &node_shared_mutex::unlock_shared, napi_enumerable),
+            InstanceMethod("owner_died", &node_shared_mutex::owner_died, napi_enumerable),
+            InstanceMethod("wait_stats", &node_shared_mutex::wait_stats, napi_enumerable),
+            InstanceMethod("stats", &node_shared_mutex::stats, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_mutex::destroy, napi_enumerable),
+            StaticMethod("export_trace", &node_shared_mutex::export_trace, napi_enumerable),
+            StaticMethod("lock_all", &node_shared_mutex::lock_all, napi_enumerable),
+            StaticMethod("unlock_all", &node_shared_mutex::unlock_all, napi_enumerable)
     });
 
-    auto *constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
-
+    env.GetInstanceData<addon_data>()->shared_mutex_constructor = Napi::Persistent(func);
     exports.Set("shared_mutex", func);
-    env.SetInstanceData<Napi::FunctionReference>(constructor);
+}
+
+shared_mutex_options convert_mutex_options(const Napi::Env &env, const Napi::Value &value) {
+    shared_mutex_options options;
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("backend") && !obj.Get("backend").IsUndefined()) {
+        const std::string backend = obj.Get("backend").ToString().Utf8Value();
+        if (backend == "auto") {
+            options.backend = shared_mutex_backend::automatic;
+        } else if (backend == "semaphore") {
+            options.backend = shared_mutex_backend::semaphore;
+        } else if (backend == "futex") {
+            options.backend = shared_mutex_backend::futex;
+        } else if (backend == "robust") {
+            options.backend = shared_mutex_backend::robust;
+        } else if (backend == "fair") {
+            options.backend = shared_mutex_backend::fair;
+        } else if (backend == "pi") {
+            options.backend = shared_mutex_backend::pi;
+        } else {
+            throw Napi::TypeError::New(env, "Unknown backend: " + backend);
+        }
+    }
+
+    if (obj.Has("writer_preference") && !obj.Get("writer_preference").IsUndefined()) {
+        options.writer_preference = obj.Get("writer_preference").ToBoolean().Value();
+    }
+
+    if (obj.Has("stats") && !obj.Get("stats").IsUndefined()) {
+        options.stats = obj.Get("stats").ToBoolean().Value();
+    }
+
+    if (obj.Has("trace") && !obj.Get("trace").IsUndefined()) {
+        options.trace = obj.Get("trace").ToBoolean().Value();
+    }
+
+    if (obj.Has("wait_policy") && !obj.Get("wait_policy").IsUndefined()) {
+        const std::string policy = obj.Get("wait_policy").ToString().Utf8Value();
+        if (policy == "park") {
+            options.waiting.mode = wait_mode::park;
+        } else if (policy == "adaptive") {
+            options.waiting.mode = wait_mode::adaptive;
+        } else {
+            throw Napi::TypeError::New(env, "Unknown wait policy: " + policy);
+        }
+    }
+
+    if (obj.Has("max_spins") && !obj.Get("max_spins").IsUndefined()) {
+        options.waiting.max_spins = obj.Get("max_spins").ToNumber().Uint32Value();
+    }
+
+    if (obj.Has("max_yields") && !obj.Get("max_yields").IsUndefined()) {
+        options.waiting.max_yields = obj.Get("max_yields").ToNumber().Uint32Value();
+    }
+
+    return options;
 }
 
 node_shared_mutex::node_shared_mutex(const Napi::CallbackInfo &info) : ObjectWrap(info) {
     CHECK_ARGS(napi_tools::string);
     const std::string name = info[0].ToString().Utf8Value();
+    const shared_mutex_options options = convert_mutex_options(info.Env(), info[1]);
 
     TRY
-        instance = shared_mutex::createShared_mutex(name, true);
+        instance = shared_mutex::createShared_mutex(name, true, options);
     CATCH_EXCEPTIONS
 }
 
-void node_shared_mutex::lockBlocking(const Napi::CallbackInfo &info) {
+std::shared_ptr<shared_mutex> node_shared_mutex::unwrap(const Napi::Env &env, const Napi::Value &value) {
+    const Napi::FunctionReference &constructor = env.GetInstanceData<addon_data>()->shared_mutex_constructor;
+    if (!value.IsObject() || !value.ToObject().InstanceOf(constructor.Value())) {
+        throw Napi::TypeError::New(env, "The mutex must be of type shared_mutex");
+    }
+
+    const std::shared_ptr<shared_mutex> &instance = Unwrap(value.ToObject())->instance;
+    if (!instance) throw Napi::Error::New(env, "The mutex is not initialized");
+
+    return instance;
+}
+
+Napi::Object node_shared_mutex::create(const Napi::Env &env, const Napi::Value &name, const Napi::Value &options) {
+    return env.GetInstanceData<addon_data>()->shared_mutex_constructor.New({name, options});
+}
+
+Napi::Value node_shared_mutex::lockBlocking(const Napi::CallbackInfo &info) {
     CHECK_CREATED();
 
     TRY
         instance->lock();
+        return lock_result(info.Env(), instance->owner_died());
     CATCH_EXCEPTIONS
 }
 
-Napi::Value node_shared_mutex::lock(const Napi::CallbackInfo &info) {
-    return napi_tools::promises::promise<void>(info.Env(), [this] {
-        if (!instance) {
-            throw std::runtime_error("The mutex is not initialized");
+/**
+ * Submit a lock request to the async waiter
+ *
+ * @param info the callback info
+ * @param instance the mutex to lock
+ * @param shared whether to lock the mutex in shared mode
+ * @return the promise resolved once the mutex is locked
+ */
+static Napi::Value queue_lock(const Napi::CallbackInfo &info, const std::shared_ptr<shared_mutex> &instance,
+                              bool shared) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The mutex is not initialized").Value());
+
+        return deferred.Promise();
+    }
+
+    // Fast path: the mutex is free, resolve without involving the async waiter.
+    // An already aborted signal must still reject, leave that to the request.
+    if (!options.signal.IsObject() || !options.signal.ToObject().Get("aborted").ToBoolean().Value()) {
+        bool locked;
+        try {
+            locked = instance->try_acquire(shared);
+        } catch (const std::exception &e) {
+            throw Napi::Error::New(info.Env(), e.what());
         }
 
-        instance->lock();
-    });
+        if (locked) {
+            auto deferred = Napi::Promise::Deferred::New(info.Env());
+            deferred.Resolve(lock_result(info.Env(), instance->owner_died()));
+
+            return deferred.Promise();
+        }
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<lock_request>(instance, shared, options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_shared_mutex::lock(const Napi::CallbackInfo &info) {
+    return queue_lock(info, instance, false);
 }
 
 Napi::Value node_shared_mutex::try_lock(const Napi::CallbackInfo &info) {
@@ -59,6 +403,154 @@ void node_shared_mutex::unlock(const Napi::CallbackInfo &info) {
 
     TRY
         instance->unlock();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_mutex::lock_shared(const Napi::CallbackInfo &info) {
+    return queue_lock(info, instance, true);
+}
+
+Napi::Value node_shared_mutex::try_lock_shared(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->try_lock_shared());
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_mutex::unlock_shared(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance->unlock_shared();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_mutex::owner_died(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Boolean::New(info.Env(), instance->owner_died());
+}
+
+Napi::Value node_shared_mutex::wait_stats(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    const wait_phase_stats stats = instance->wait_stats();
+    Napi::Object result = Napi::Object::New(info.Env());
+    result.Set("spin", Napi::Number::New(info.Env(), static_cast<double>(stats.spin)));
+    result.Set("yield", Napi::Number::New(info.Env(), static_cast<double>(stats.yield)));
+    result.Set("park", Napi::Number::New(info.Env(), static_cast<double>(stats.park)));
+
+    return result;
+}
+
+Napi::Value node_shared_mutex::stats(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    const mutex_stats stats = instance->stats();
+    Napi::Object result = Napi::Object::New(info.Env());
+    result.Set("enabled", Napi::Boolean::New(info.Env(), stats.enabled));
+    result.Set("acquisitions", Napi::Number::New(info.Env(), static_cast<double>(stats.acquisitions)));
+    result.Set("contended", Napi::Number::New(info.Env(), static_cast<double>(stats.contended)));
+    result.Set("try_lock_failures", Napi::Number::New(info.Env(), static_cast<double>(stats.try_lock_failures)));
+    result.Set("total_wait_ns", Napi::Number::New(info.Env(), static_cast<double>(stats.total_wait_ns)));
+    result.Set("max_wait_ns", Napi::Number::New(info.Env(), static_cast<double>(stats.max_wait_ns)));
+    result.Set("waiters", Napi::Number::New(info.Env(), stats.waiters));
+
+    Napi::Array histogram = Napi::Array::New(info.Env(), stats.hold_histogram.size());
+    for (uint32_t i = 0; i < stats.hold_histogram.size(); i++) {
+        histogram.Set(i, Napi::Number::New(info.Env(), static_cast<double>(stats.hold_histogram[i])));
+    }
+
+    result.Set("hold_histogram", histogram);
+    return result;
+}
+
+Napi::Value node_shared_mutex::export_trace(const Napi::CallbackInfo &info) {
+    TRY
+        return Napi::String::New(info.Env(), lock_trace::instance().chrome_json());
+    CATCH_EXCEPTIONS
+}
+
+/**
+ * Get the mutexes passed to lock_all() or unlock_all()
+ *
+ * @param env the environment
+ * @param value the array of shared_mutex objects
+ * @return the mutexes
+ */
+static std::vector<std::shared_ptr<shared_mutex>> unwrap_all(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsArray()) {
+        throw Napi::TypeError::New(env, "The mutexes must be of type array");
+    }
+
+    const Napi::Array array = value.As<Napi::Array>();
+    std::vector<std::shared_ptr<shared_mutex>> mutexes;
+    for (uint32_t i = 0; i < array.Length(); i++) {
+        std::shared_ptr<shared_mutex> mutex = node_shared_mutex::unwrap(env, array.Get(i));
+        for (const auto &other : mutexes) {
+            // Another instance of the same mutex could never be locked
+            if (other->name() == mutex->name()) {
+                throw Napi::Error::New(env, "The mutex '" + mutex->name() + "' must not be passed twice");
+            }
+        }
+
+        mutexes.push_back(std::move(mutex));
+    }
+
+    return mutexes;
+}
+
+Napi::Value node_shared_mutex::lock_all(const Napi::CallbackInfo &info) {
+    const std::vector<std::shared_ptr<shared_mutex>> mutexes = unwrap_all(info.Env(), info[0]);
+    const wait_options options = convert_wait_options(info.Env(), info[1]);
+
+    // Fast path: all mutexes are free, resolve without involving the async waiter.
+    // An already aborted signal must still reject, leave that to the request.
+    std::vector<shared_mutex *> locked;
+    if (!options.signal.IsObject() || !options.signal.ToObject().Get("aborted").ToBoolean().Value()) {
+        try {
+            while (locked.size() < mutexes.size() && mutexes[locked.size()]->try_acquire(false)) {
+                locked.push_back(mutexes[locked.size()].get());
+            }
+        } catch (const std::exception &e) {
+            ::unlock_all(locked);
+            throw Napi::Error::New(info.Env(), e.what());
+        }
+
+        if (locked.size() == mutexes.size()) {
+            Napi::Array results = Napi::Array::New(info.Env(), mutexes.size());
+            for (uint32_t i = 0; i < mutexes.size(); i++) {
+                results.Set(i, lock_result(info.Env(), mutexes[i]->owner_died()));
+            }
+
+            auto deferred = Napi::Promise::Deferred::New(info.Env());
+            deferred.Resolve(results);
+
+            return deferred.Promise();
+        }
+
+        ::unlock_all(locked);
+        async_waiter::instance().notify_if_waiting();
+    }
+
+    // Wait for the contended mutex first
+    return node_wait_request::submit(info.Env(), std::make_shared<lock_all_request>(mutexes, locked.size(),
+                                                                                    options.deadline),
+                                     options.signal);
+}
+
+void node_shared_mutex::unlock_all(const Napi::CallbackInfo &info) {
+    const std::vector<std::shared_ptr<shared_mutex>> mutexes = unwrap_all(info.Env(), info[0]);
+
+    TRY
+        for (size_t i = mutexes.size(); i-- > 0;) {
+            mutexes[i]->unlock();
+        }
+
+        async_waiter::instance().notify_if_waiting();
     CATCH_EXCEPTIONS
 }
 
@@ -67,7 +559,8 @@ void node_shared_mutex::destroy(const Napi::CallbackInfo &info) {
 
     TRY
         instance.reset();
+        async_waiter::instance().notify_if_waiting();
     CATCH_EXCEPTIONS
 }
 
-node_shared_mutex::~node_shared_mutex() = default;
\ No newline at end of file
+node_shared_mutex::~node_shared_mutex() = default;
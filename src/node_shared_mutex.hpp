@@ -4,6 +4,15 @@
 #include <napi.h>
 #include "shared_mutex.hpp"
 
+/**
+ * Convert the options passed to the constructor of a mutex
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+shared_mutex_options convert_mutex_options(const Napi::Env &env, const Napi::Value &value);
+
 /**
  * A node shared_mutex wrapper class
  */
@@ -24,12 +33,32 @@ public:
      */
     explicit node_shared_mutex(const Napi::CallbackInfo &info);
 
+    /**
+     * Get the mutex of a shared_mutex object
+     *
+     * @param env the environment
+     * @param value the shared_mutex object
+     * @return the mutex instance
+     */
+    static std::shared_ptr<shared_mutex> unwrap(const Napi::Env &env, const Napi::Value &value);
+
+    /**
+     * Create a shared_mutex object
+     *
+     * @param env the environment
+     * @param name the name of the mutex
+     * @param options the mutex options or undefined
+     * @return the shared_mutex object
+     */
+    static Napi::Object create(const Napi::Env &env, const Napi::Value &name, const Napi::Value &options);
+
     /**
      * Lock the mutex. Blocking call.
      *
      * @param info the callback info
+     * @return the lock result
      */
-    void lockBlocking(const Napi::CallbackInfo &info);
+    Napi::Value lockBlocking(const Napi::CallbackInfo &info);
 
     /**
      * Lock the mutex. Async call.
@@ -54,6 +83,76 @@ public:
      */
     void unlock(const Napi::CallbackInfo &info);
 
+    /**
+     * Lock the mutex in shared mode. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value lock_shared(const Napi::CallbackInfo &info);
+
+    /**
+     * Try locking the mutex in shared mode
+     *
+     * @param info the callback info
+     * @return true, if the mutex could be locked
+     */
+    Napi::Value try_lock_shared(const Napi::CallbackInfo &info);
+
+    /**
+     * Unlock the mutex from shared mode
+     *
+     * @param info the callback info
+     */
+    void unlock_shared(const Napi::CallbackInfo &info);
+
+    /**
+     * Check whether the previous owner died while holding the mutex
+     *
+     * @param info the callback info
+     * @return true if the previous owner died while holding the mutex
+     */
+    Napi::Value owner_died(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of contended acquisitions per wait phase
+     *
+     * @param info the callback info
+     * @return the wait phase statistics
+     */
+    Napi::Value wait_stats(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the contention statistics of the mutex
+     *
+     * @param info the callback info
+     * @return the statistics
+     */
+    Napi::Value stats(const Napi::CallbackInfo &info);
+
+    /**
+     * Export the lock events traced on this machine as Chrome trace_event JSON
+     *
+     * @param info the callback info
+     * @return the JSON string
+     */
+    static Napi::Value export_trace(const Napi::CallbackInfo &info);
+
+    /**
+     * Lock multiple mutexes at once without deadlocking. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    static Napi::Value lock_all(const Napi::CallbackInfo &info);
+
+    /**
+     * Unlock multiple mutexes locked by lock_all()
+     *
+     * @param info the callback info
+     */
+    static void unlock_all(const Napi::CallbackInfo &info);
+
     /**
      * Destroy the mutex
      *
@@ -68,7 +167,7 @@ public:
 
 private:
     // The shared_mutex instance
-    std::unique_ptr<shared_mutex> instance;
+    std::shared_ptr<shared_mutex> instance;
 };
 
 #endif //SHARED_MUTEX_NODE_SHARED_MUTEX_HPP
@@ -0,0 +1,455 @@
+#include "node_shared_ring.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+#include <algorithm>
+#include <vector>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The ring is not initialized")
+
+/**
+ * Get the message passed to an operation
+ *
+ * @param env the environment
+ * @param value the Buffer or typed array
+ * @return the message
+ */
+static Napi::TypedArray get_message(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsTypedArray()) {
+        throw Napi::TypeError::New(env, "The message must be a Buffer or a typed array");
+    }
+
+    return value.As<Napi::TypedArray>();
+}
+
+/**
+ * Get the bytes of a message
+ *
+ * @param message the message
+ * @return the pointer to the first byte
+ */
+static const uint8_t *message_data(const Napi::TypedArray &message) {
+    return static_cast<const uint8_t *>(message.ArrayBuffer().Data()) + message.ByteOffset();
+}
+
+/**
+ * A request pushing a message once the ring isn't full.
+ * Holds a copy of the message, the JS buffer can't be read from the waiter thread.
+ */
+class push_request : public node_wait_request {
+public:
+    /**
+     * Create a push request
+     *
+     * @param ring the ring to push the message to
+     * @param data the first byte of the message
+     * @param size the size of the message
+     * @param deadline the time point to stop waiting at
+     */
+    push_request(std::shared_ptr<shared_ring> ring, const uint8_t *data, size_t size,
+                 futex::clock::time_point deadline)
+            : node_wait_request(deadline), ring(std::move(ring)), message(data, data + size), registered(false) {}
+
+    /**
+     * Stop waiting, if the request is still registered as a waiter
+     */
+    ~push_request() override {
+        ring->leave_push_wait(registered);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (!ring->try_push(message.data(), message.size())) return false;
+
+        ring->leave_push_wait(registered);
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return ring->prepare_push_wait(registered, target);
+    }
+
+    void abandon_wait() override {
+        ring->leave_push_wait(registered);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "push";
+    }
+
+private:
+    // The ring to push the message to
+    std::shared_ptr<shared_ring> ring;
+    // The message
+    std::vector<uint8_t> message;
+    // Whether the request is registered as a waiter
+    bool registered;
+};
+
+/**
+ * A request popping a message once the ring isn't empty
+ */
+class pop_request : public node_wait_request {
+public:
+    /**
+     * Create a pop request
+     *
+     * @param ring the ring to pop the message from
+     * @param deadline the time point to stop waiting at
+     */
+    pop_request(std::shared_ptr<shared_ring> ring, futex::clock::time_point deadline)
+            : node_wait_request(deadline), ring(std::move(ring)), message(std::make_unique<std::vector<uint8_t>>()),
+              popped(false), registered(false) {
+        // Copying the message out of its slot must not allocate, the slot is released afterwards
+        message->reserve(this->ring->slot_size());
+    }
+
+    /**
+     * Stop waiting, if the request is still registered as a waiter
+     */
+    ~pop_request() override {
+        ring->leave_pop_wait(registered);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        popped = ring->try_pop([this](const void *data, size_t size) {
+            message->assign(static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+        });
+
+        if (popped) ring->leave_pop_wait(registered);
+        return popped;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return ring->prepare_pop_wait(registered, target);
+    }
+
+    void abandon_wait() override {
+        ring->leave_pop_wait(registered);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        // Hand the popped bytes to the Buffer instead of copying them again
+        std::vector<uint8_t> *data = message.release();
+        return Napi::Buffer<uint8_t>::New(env, data->data(), data->size(), [](Napi::Env, uint8_t *,
+                                                                             std::vector<uint8_t> *hint) {
+            delete hint;
+        }, data);
+    }
+
+    void discard() override {
+        // Put the message back for another consumer, it is lost if the ring filled up in the meantime
+        if (popped) (void) ring->try_push(message->data(), message->size());
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "pop";
+    }
+
+private:
+    // The ring to pop the message from
+    std::shared_ptr<shared_ring> ring;
+    // The popped message
+    std::unique_ptr<std::vector<uint8_t>> message;
+    // Whether the message was popped
+    bool popped;
+    // Whether the request is registered as a waiter
+    bool registered;
+};
+
+void node_shared_ring::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_ring", {
+            InstanceMethod("try_push", &node_shared_ring::try_push, napi_enumerable),
+            InstanceMethod("try_push_batch", &node_shared_ring::try_push_batch, napi_enumerable),
+            InstanceMethod("push_blocking", &node_shared_ring::pushBlocking, napi_enumerable),
+            InstanceMethod("push", &node_shared_ring::push, napi_enumerable),
+            InstanceMethod("try_pop", &node_shared_ring::try_pop, napi_enumerable),
+            InstanceMethod("try_pop_batch", &node_shared_ring::try_pop_batch, napi_enumerable),
+            InstanceMethod("pop_blocking", &node_shared_ring::popBlocking, napi_enumerable),
+            InstanceMethod("pop", &node_shared_ring::pop, napi_enumerable),
+            InstanceMethod("size", &node_shared_ring::size, napi_enumerable),
+            InstanceMethod("capacity", &node_shared_ring::capacity, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_ring::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_ring", func);
+}
+
+/**
+ * Convert the options passed to the constructor
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+static shared_ring_options convert_options(const Napi::Env &env, const Napi::Value &value) {
+    shared_ring_options options;
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("capacity") && !obj.Get("capacity").IsUndefined()) {
+        options.capacity = obj.Get("capacity").ToNumber().Uint32Value();
+    }
+
+    if (obj.Has("slot_size") && !obj.Get("slot_size").IsUndefined()) {
+        options.slot_size = obj.Get("slot_size").ToNumber().Uint32Value();
+    }
+
+    if (obj.Has("mode") && !obj.Get("mode").IsUndefined()) {
+        const std::string mode = obj.Get("mode").ToString().Utf8Value();
+        if (mode == "mpmc") {
+            options.mode = ring_mode::mpmc;
+        } else if (mode == "spsc") {
+            options.mode = ring_mode::spsc;
+        } else {
+            throw Napi::TypeError::New(env, "Unknown ring mode: " + mode);
+        }
+    }
+
+    return options;
+}
+
+/**
+ * Messages copied out of the ring. The ring only releases a slot once the message was
+ * copied out of it, so the copy must not fail: the storage is reserved before popping
+ * and the JS Buffers are only created after the slots were released.
+ */
+class popped_messages {
+public:
+    /**
+     * Reserve the storage for the messages
+     *
+     * @param max the max number of messages to pop
+     * @param slot_size the max size of a message
+     */
+    popped_messages(size_t max, size_t slot_size) {
+        data.reserve(max * slot_size);
+        sizes.reserve(max);
+    }
+
+    /**
+     * Copy a message, never allocates as long as at most max messages are added
+     *
+     * @param message the first byte of the message
+     * @param size the size of the message
+     */
+    void add(const void *message, size_t size) noexcept {
+        const auto *bytes = static_cast<const uint8_t *>(message);
+        data.insert(data.end(), bytes, bytes + size);
+        sizes.push_back(size);
+    }
+
+    /**
+     * Get the number of messages
+     *
+     * @return the number of popped messages
+     */
+    [[nodiscard]] size_t count() const noexcept {
+        return sizes.size();
+    }
+
+    /**
+     * Copy the popped messages into new Buffers
+     *
+     * @param env the environment
+     * @return the Buffers
+     */
+    [[nodiscard]] std::vector<Napi::Buffer<uint8_t>> buffers(const Napi::Env &env) const {
+        std::vector<Napi::Buffer<uint8_t>> result;
+        result.reserve(sizes.size());
+
+        size_t offset = 0;
+        for (const size_t size : sizes) {
+            result.push_back(Napi::Buffer<uint8_t>::Copy(env, data.data() + offset, size));
+            offset += size;
+        }
+
+        return result;
+    }
+
+private:
+    // The bytes of all messages
+    std::vector<uint8_t> data;
+    // The size of every message
+    std::vector<size_t> sizes;
+};
+
+node_shared_ring::node_shared_ring(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    const shared_ring_options options = convert_options(info.Env(), info[1]);
+
+    TRY
+        instance = std::make_shared<shared_ring>(name, options);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_ring::try_push(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const Napi::TypedArray message = get_message(info.Env(), info[0]);
+
+    TRY
+        const bool pushed = instance->try_push(message_data(message), message.ByteLength());
+        if (pushed) async_waiter::instance().notify_if_waiting();
+
+        return Napi::Boolean::New(info.Env(), pushed);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_ring::try_push_batch(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    if (!info[0].IsArray()) {
+        throw Napi::TypeError::New(info.Env(), "The messages must be an array");
+    }
+
+    const Napi::Array array = info[0].As<Napi::Array>();
+    std::vector<Napi::TypedArray> messages;
+    messages.reserve(array.Length());
+    for (uint32_t i = 0; i < array.Length(); i++) {
+        messages.push_back(get_message(info.Env(), array.Get(i)));
+    }
+
+    TRY
+        const size_t pushed = instance->try_push_batch(messages.size(), [&](size_t i) {
+            return std::pair<const void *, size_t>(message_data(messages[i]), messages[i].ByteLength());
+        });
+
+        if (pushed > 0) async_waiter::instance().notify_if_waiting();
+        return Napi::Number::New(info.Env(), static_cast<double>(pushed));
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_ring::pushBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const Napi::TypedArray message = get_message(info.Env(), info[0]);
+
+    TRY
+        instance->push(message_data(message), message.ByteLength());
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_ring::push(const Napi::CallbackInfo &info) {
+    const Napi::TypedArray message = get_message(info.Env(), info[0]);
+    const wait_options options = convert_wait_options(info.Env(), info[1]);
+    auto deferred = Napi::Promise::Deferred::New(info.Env());
+    if (!instance) {
+        deferred.Reject(Napi::Error::New(info.Env(), "The ring is not initialized").Value());
+        return deferred.Promise();
+    } else if (message.ByteLength() > instance->slot_size()) {
+        // Fail early instead of on the waiter thread
+        deferred.Reject(Napi::RangeError::New(info.Env(), "The message must not be larger than " +
+                                                          std::to_string(instance->slot_size()) + " bytes").Value());
+        return deferred.Promise();
+    }
+
+    // Fast path: copy the message straight into the ring if it isn't full
+    if (!options.signal.IsObject() || !options.signal.ToObject().Get("aborted").ToBoolean().Value()) {
+        if (instance->try_push(message_data(message), message.ByteLength())) {
+            async_waiter::instance().notify_if_waiting();
+            deferred.Resolve(info.Env().Undefined());
+            return deferred.Promise();
+        }
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<push_request>(
+            instance, message_data(message), message.ByteLength(), options.deadline), options.signal);
+}
+
+Napi::Value node_shared_ring::try_pop(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    popped_messages messages(1, instance->slot_size());
+    if (!instance->try_pop([&](const void *data, size_t size) { messages.add(data, size); })) {
+        return info.Env().Null();
+    }
+
+    async_waiter::instance().notify_if_waiting();
+    return messages.buffers(info.Env()).front();
+}
+
+Napi::Value node_shared_ring::try_pop_batch(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    if (!info[0].IsNumber()) {
+        throw Napi::TypeError::New(info.Env(), "The max number of messages must be of type number");
+    }
+
+    // The ring never holds more messages than its capacity
+    const size_t max = std::min<size_t>(info[0].ToNumber().Uint32Value(), instance->capacity());
+    popped_messages messages(max, instance->slot_size());
+    const size_t popped = instance->try_pop_batch(max, [&](const void *data, size_t size) {
+        messages.add(data, size);
+    });
+
+    if (popped > 0) async_waiter::instance().notify_if_waiting();
+
+    Napi::Array result = Napi::Array::New(info.Env(), popped);
+    const std::vector<Napi::Buffer<uint8_t>> buffers = messages.buffers(info.Env());
+    for (uint32_t i = 0; i < buffers.size(); i++) {
+        result.Set(i, buffers[i]);
+    }
+
+    return result;
+}
+
+Napi::Value node_shared_ring::popBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    popped_messages messages(1, instance->slot_size());
+    instance->pop([&](const void *data, size_t size) { messages.add(data, size); });
+
+    async_waiter::instance().notify_if_waiting();
+    return messages.buffers(info.Env()).front();
+}
+
+Napi::Value node_shared_ring::pop(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    auto deferred = Napi::Promise::Deferred::New(info.Env());
+    if (!instance) {
+        deferred.Reject(Napi::Error::New(info.Env(), "The ring is not initialized").Value());
+        return deferred.Promise();
+    }
+
+    // Fast path: take a message right away if there is one
+    if (!options.signal.IsObject() || !options.signal.ToObject().Get("aborted").ToBoolean().Value()) {
+        popped_messages messages(1, instance->slot_size());
+        if (instance->try_pop([&](const void *data, size_t size) { messages.add(data, size); })) {
+            async_waiter::instance().notify_if_waiting();
+            deferred.Resolve(messages.buffers(info.Env()).front());
+            return deferred.Promise();
+        }
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<pop_request>(instance, options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_shared_ring::size(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), static_cast<double>(instance->size()));
+}
+
+Napi::Value node_shared_ring::capacity(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->capacity());
+}
+
+void node_shared_ring::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_ring::~node_shared_ring() = default;
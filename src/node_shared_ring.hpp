@@ -0,0 +1,125 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_RING_HPP
+#define SHARED_MUTEX_NODE_SHARED_RING_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_ring.hpp"
+
+/**
+ * A node shared_ring wrapper class
+ */
+class node_shared_ring : public Napi::ObjectWrap<node_shared_ring> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_ring wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_ring(const Napi::CallbackInfo &info);
+
+    /**
+     * Try pushing a message
+     *
+     * @param info the callback info
+     * @return false if the ring is full
+     */
+    Napi::Value try_push(const Napi::CallbackInfo &info);
+
+    /**
+     * Try pushing an array of messages
+     *
+     * @param info the callback info
+     * @return the number of messages pushed
+     */
+    Napi::Value try_push_batch(const Napi::CallbackInfo &info);
+
+    /**
+     * Push a message. Blocking call.
+     *
+     * @param info the callback info
+     */
+    void pushBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Push a message. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value push(const Napi::CallbackInfo &info);
+
+    /**
+     * Try popping a message
+     *
+     * @param info the callback info
+     * @return the message or null if the ring is empty
+     */
+    Napi::Value try_pop(const Napi::CallbackInfo &info);
+
+    /**
+     * Try popping a number of messages
+     *
+     * @param info the callback info
+     * @return the array of messages
+     */
+    Napi::Value try_pop_batch(const Napi::CallbackInfo &info);
+
+    /**
+     * Pop a message. Blocking call.
+     *
+     * @param info the callback info
+     * @return the message
+     */
+    Napi::Value popBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Pop a message. Async call.
+     *
+     * @param info the callback info
+     * @return the promise resolving to the message
+     */
+    Napi::Value pop(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of messages in the ring
+     *
+     * @param info the callback info
+     * @return the number of messages
+     */
+    Napi::Value size(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of slots
+     *
+     * @param info the callback info
+     * @return the capacity
+     */
+    Napi::Value capacity(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the ring
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the ring
+     */
+    ~node_shared_ring() override;
+
+private:
+    // The shared_ring instance
+    std::shared_ptr<shared_ring> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_RING_HPP
@@ -0,0 +1,206 @@
+#include "node_shared_semaphore.hpp"
+#include "node_async_waiter.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The semaphore is not initialized")
+
+/**
+ * A request acquiring permits of a semaphore
+ */
+class acquire_request : public node_wait_request {
+public:
+    /**
+     * Create an acquire request
+     *
+     * @param semaphore the semaphore to acquire the permits of
+     * @param count the number of permits to acquire
+     * @param deadline the time point to stop waiting at
+     */
+    acquire_request(std::shared_ptr<shared_semaphore> semaphore, uint32_t count, futex::clock::time_point deadline)
+            : node_wait_request(deadline), semaphore(std::move(semaphore)), count(count), registered(false) {}
+
+    /**
+     * Stop waiting, if the request is still registered as a waiter
+     */
+    ~acquire_request() override {
+        semaphore->leave_wait(registered);
+    }
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (!semaphore->try_acquire(count)) return false;
+
+        semaphore->leave_wait(registered);
+        return true;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return semaphore->prepare_wait(count, registered, target);
+    }
+
+    void abandon_wait() override {
+        semaphore->leave_wait(registered);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        return env.Undefined();
+    }
+
+    void discard() override {
+        semaphore->release(count);
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "acquire";
+    }
+
+private:
+    // The semaphore to acquire the permits of
+    std::shared_ptr<shared_semaphore> semaphore;
+    // The number of permits to acquire
+    uint32_t count;
+    // Whether the request is registered as a waiter
+    bool registered;
+};
+
+void node_shared_semaphore::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_semaphore", {
+            InstanceMethod("acquire_blocking", &node_shared_semaphore::acquireBlocking, napi_enumerable),
+            InstanceMethod("acquire", &node_shared_semaphore::acquire, napi_enumerable),
+            InstanceMethod("try_acquire", &node_shared_semaphore::try_acquire, napi_enumerable),
+            InstanceMethod("release", &node_shared_semaphore::release, napi_enumerable),
+            InstanceMethod("count", &node_shared_semaphore::count, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_semaphore::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_semaphore", func);
+}
+
+/**
+ * Convert the options passed to the constructor
+ *
+ * @param env the environment
+ * @param value the options object or undefined
+ * @return the converted options
+ */
+static shared_semaphore_options convert_options(const Napi::Env &env, const Napi::Value &value) {
+    shared_semaphore_options options;
+    if (value.IsUndefined() || value.IsNull()) {
+        return options;
+    } else if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, "The options must be of type object");
+    }
+
+    const Napi::Object obj = value.ToObject();
+    if (obj.Has("initial") && !obj.Get("initial").IsUndefined()) {
+        if (!obj.Get("initial").IsNumber()) {
+            throw Napi::TypeError::New(env, "The initial count must be of type number");
+        }
+
+        options.initial = obj.Get("initial").ToNumber().Uint32Value();
+    }
+
+    if (obj.Has("max") && !obj.Get("max").IsUndefined()) {
+        if (!obj.Get("max").IsNumber()) {
+            throw Napi::TypeError::New(env, "The max count must be of type number");
+        }
+
+        options.max = obj.Get("max").ToNumber().Uint32Value();
+    }
+
+    return options;
+}
+
+/**
+ * Get the number of permits passed to a method
+ *
+ * @param env the environment
+ * @param value the number of permits or undefined
+ * @return the number of permits, one if undefined
+ */
+static uint32_t get_count(const Napi::Env &env, const Napi::Value &value) {
+    if (value.IsUndefined()) {
+        return 1;
+    } else if (!value.IsNumber()) {
+        throw Napi::TypeError::New(env, "The number of permits must be of type number");
+    }
+
+    return value.ToNumber().Uint32Value();
+}
+
+node_shared_semaphore::node_shared_semaphore(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    const shared_semaphore_options options = convert_options(info.Env(), info[1]);
+
+    TRY
+        instance = std::make_shared<shared_semaphore>(name, options);
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_semaphore::acquireBlocking(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const uint32_t count = get_count(info.Env(), info[0]);
+
+    TRY
+        instance->acquire(count);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_semaphore::acquire(const Napi::CallbackInfo &info) {
+    const uint32_t count = get_count(info.Env(), info[0]);
+    const wait_options options = convert_wait_options(info.Env(), info[1]);
+    if (!instance) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The semaphore is not initialized").Value());
+
+        return deferred.Promise();
+    } else if (count == 0 || count > instance->max()) {
+        // Fail early instead of on the waiter thread
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::RangeError::New(info.Env(), "The number of permits must be between 1 and " +
+                                                          std::to_string(instance->max())).Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<acquire_request>(instance, count,
+                                                                                   options.deadline),
+                                     options.signal);
+}
+
+Napi::Value node_shared_semaphore::try_acquire(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const uint32_t count = get_count(info.Env(), info[0]);
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance->try_acquire(count));
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_semaphore::release(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const uint32_t count = get_count(info.Env(), info[0]);
+
+    TRY
+        instance->release(count);
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_semaphore::count(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->count());
+}
+
+void node_shared_semaphore::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+        async_waiter::instance().notify_if_waiting();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_semaphore::~node_shared_semaphore() = default;
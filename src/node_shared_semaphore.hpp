@@ -0,0 +1,84 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_SEMAPHORE_HPP
+#define SHARED_MUTEX_NODE_SHARED_SEMAPHORE_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_semaphore.hpp"
+
+/**
+ * A node shared_semaphore wrapper class
+ */
+class node_shared_semaphore : public Napi::ObjectWrap<node_shared_semaphore> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_semaphore wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_semaphore(const Napi::CallbackInfo &info);
+
+    /**
+     * Acquire permits. Blocking call.
+     *
+     * @param info the callback info
+     */
+    void acquireBlocking(const Napi::CallbackInfo &info);
+
+    /**
+     * Acquire permits. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value acquire(const Napi::CallbackInfo &info);
+
+    /**
+     * Try acquiring permits
+     *
+     * @param info the callback info
+     * @return true, if the permits could be acquired
+     */
+    Napi::Value try_acquire(const Napi::CallbackInfo &info);
+
+    /**
+     * Release permits
+     *
+     * @param info the callback info
+     */
+    void release(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the number of available permits
+     *
+     * @param info the callback info
+     * @return the number of available permits
+     */
+    Napi::Value count(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the semaphore
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the semaphore
+     */
+    ~node_shared_semaphore() override;
+
+private:
+    // The shared_semaphore instance
+    std::shared_ptr<shared_semaphore> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_SEMAPHORE_HPP
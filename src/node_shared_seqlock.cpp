@@ -0,0 +1,125 @@
+#include "node_shared_seqlock.hpp"
+#include <napi_tools.hpp>
+
+#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The seqlock is not initialized")
+
+void node_shared_seqlock::init(Napi::Env env, Napi::Object &exports) {
+    Napi::Function func = DefineClass(env, "shared_seqlock", {
+            InstanceMethod("read", &node_shared_seqlock::read, napi_enumerable),
+            InstanceMethod("read_into", &node_shared_seqlock::read_into, napi_enumerable),
+            InstanceMethod("write", &node_shared_seqlock::write, napi_enumerable),
+            InstanceMethod("sequence", &node_shared_seqlock::sequence, napi_enumerable),
+            InstanceMethod("size", &node_shared_seqlock::size, napi_enumerable),
+            InstanceMethod("destroy", &node_shared_seqlock::destroy, napi_enumerable)
+    });
+
+    exports.Set("shared_seqlock", func);
+}
+
+/**
+ * Get the offset passed to an operation
+ *
+ * @param env the environment
+ * @param value the offset or undefined
+ * @return the offset, zero if undefined
+ */
+static size_t get_offset(const Napi::Env &env, const Napi::Value &value) {
+    if (value.IsUndefined()) {
+        return 0;
+    } else if (!value.IsNumber()) {
+        throw Napi::TypeError::New(env, "The offset must be of type number");
+    }
+
+    const double offset = value.ToNumber().DoubleValue();
+    if (!(offset >= 0) || offset > shared_seqlock::max_size) {
+        throw Napi::RangeError::New(env, "The offset must not be negative");
+    }
+
+    return static_cast<size_t>(offset);
+}
+
+/**
+ * Get the typed array passed to an operation
+ *
+ * @param env the environment
+ * @param value the typed array
+ * @return the typed array
+ */
+static Napi::TypedArray get_array(const Napi::Env &env, const Napi::Value &value) {
+    if (!value.IsTypedArray()) {
+        throw Napi::TypeError::New(env, "The data must be a Buffer or a typed array");
+    }
+
+    return value.As<Napi::TypedArray>();
+}
+
+/**
+ * Get the bytes of a typed array
+ *
+ * @param array the typed array
+ * @return the pointer to the first byte
+ */
+static uint8_t *array_data(const Napi::TypedArray &array) {
+    return static_cast<uint8_t *>(array.ArrayBuffer().Data()) + array.ByteOffset();
+}
+
+node_shared_seqlock::node_shared_seqlock(const Napi::CallbackInfo &info) : ObjectWrap(info) {
+    CHECK_ARGS(napi_tools::string, napi_tools::number);
+    const std::string name = info[0].ToString().Utf8Value();
+    const uint32_t size = info[1].ToNumber().Uint32Value();
+
+    TRY
+        instance = std::make_shared<shared_seqlock>(name, size);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_seqlock::read(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(info.Env(), instance->size());
+    instance->read(buffer.Data(), buffer.Length());
+
+    return buffer;
+}
+
+Napi::Value node_shared_seqlock::read_into(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const Napi::TypedArray array = get_array(info.Env(), info[0]);
+    const size_t offset = get_offset(info.Env(), info[1]);
+
+    TRY
+        return Napi::Number::New(info.Env(), instance->read(array_data(array), array.ByteLength(), offset));
+    CATCH_EXCEPTIONS
+}
+
+void node_shared_seqlock::write(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+    const Napi::TypedArray array = get_array(info.Env(), info[0]);
+    const size_t offset = get_offset(info.Env(), info[1]);
+
+    TRY
+        instance->write(array_data(array), array.ByteLength(), offset);
+    CATCH_EXCEPTIONS
+}
+
+Napi::Value node_shared_seqlock::sequence(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->sequence());
+}
+
+Napi::Value node_shared_seqlock::size(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    return Napi::Number::New(info.Env(), instance->size());
+}
+
+void node_shared_seqlock::destroy(const Napi::CallbackInfo &info) {
+    CHECK_CREATED();
+
+    TRY
+        instance.reset();
+    CATCH_EXCEPTIONS
+}
+
+node_shared_seqlock::~node_shared_seqlock() = default;
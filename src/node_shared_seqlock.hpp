@@ -0,0 +1,85 @@
+#ifndef SHARED_MUTEX_NODE_SHARED_SEQLOCK_HPP
+#define SHARED_MUTEX_NODE_SHARED_SEQLOCK_HPP
+
+#include <napi.h>
+#include <memory>
+
+#include "shared_seqlock.hpp"
+
+/**
+ * A node shared_seqlock wrapper class
+ */
+class node_shared_seqlock : public Napi::ObjectWrap<node_shared_seqlock> {
+public:
+    /**
+     * Initialize the class
+     *
+     * @param env the environment
+     * @param exports the exports
+     */
+    static void init(Napi::Env env, Napi::Object &exports);
+
+    /**
+     * Create a shared_seqlock wrapper
+     *
+     * @param info the callback info
+     */
+    explicit node_shared_seqlock(const Napi::CallbackInfo &info);
+
+    /**
+     * Copy the data out of the region into a new buffer
+     *
+     * @param info the callback info
+     * @return the buffer
+     */
+    Napi::Value read(const Napi::CallbackInfo &info);
+
+    /**
+     * Copy data out of the region into an existing typed array
+     *
+     * @param info the callback info
+     * @return the sequence number of the copied data
+     */
+    Napi::Value read_into(const Napi::CallbackInfo &info);
+
+    /**
+     * Copy data into the region
+     *
+     * @param info the callback info
+     */
+    void write(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the current sequence number
+     *
+     * @param info the callback info
+     * @return the sequence number
+     */
+    Napi::Value sequence(const Napi::CallbackInfo &info);
+
+    /**
+     * Get the size of the region
+     *
+     * @param info the callback info
+     * @return the size in bytes
+     */
+    Napi::Value size(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the region
+     *
+     * @param info the callback info
+     */
+    void destroy(const Napi::CallbackInfo &info);
+
+    /**
+     * Destroy the region
+     */
+    ~node_shared_seqlock() override;
+
+private:
+    // The shared_seqlock instance
+    std::shared_ptr<shared_seqlock> instance;
+};
+
+#endif //SHARED_MUTEX_NODE_SHARED_SEQLOCK_HPP
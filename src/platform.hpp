@@ -0,0 +1,18 @@
+#ifndef SHARED_MUTEX_PLATFORM_HPP
+#define SHARED_MUTEX_PLATFORM_HPP
+
+#if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
+#   define OS_UNIX
+#elif defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#   define OS_WINDOWS
+#endif
+
+#ifdef __linux__
+#   define OS_LINUX
+#endif
+
+#if !defined(OS_UNIX) && !defined(OS_WINDOWS)
+#   error "shared_mutex is only supported on windows and unix systems"
+#endif
+
+#endif //SHARED_MUTEX_PLATFORM_HPP
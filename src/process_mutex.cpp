@@ -1,52 +1,171 @@
 #include "process_mutex.hpp"
+#include "addon_data.hpp"
+#include "node_async_waiter.hpp"
 #include <napi_tools.hpp>
 
-#define CHECK_CREATED() if (!instance) throw Napi::Error::New(info.Env(), "The mutex is not initialized")
+#define CHECK_CREATED() if (!instance && !lock) throw Napi::Error::New(info.Env(), "The mutex is not initialized")
+
+/**
+ * A request waiting for another instance to forward its arguments
+ */
+class receive_args_request : public node_wait_request {
+public:
+    /**
+     * Create a receive request
+     *
+     * @param lock the instance lock receiving the arguments
+     * @param deadline the time point to stop waiting at
+     */
+    receive_args_request(std::shared_ptr<instance_lock> lock, futex::clock::time_point deadline)
+            : node_wait_request(deadline), lock(std::move(lock)) {}
+
+protected:
+    [[nodiscard]] bool try_complete(bool) override {
+        if (lock->try_receive(args)) return true;
+
+        lock->check_receiving();
+        return false;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) override {
+        return lock->prepare_wait(target);
+    }
+
+    [[nodiscard]] Napi::Value result(const Napi::Env &env) override {
+        Napi::Array res = Napi::Array::New(env, args.size());
+        for (size_t i = 0; i < args.size(); i++) {
+            res.Set(static_cast<uint32_t>(i), Napi::String::New(env, args[i]));
+        }
+
+        return res;
+    }
+
+    void discard() override {
+        // Leave the arguments to the next request
+        lock->requeue(std::move(args));
+    }
+
+    [[nodiscard]] std::string operation() const override {
+        return "receive_args";
+    }
+
+private:
+    // The instance lock receiving the arguments
+    std::shared_ptr<instance_lock> lock;
+    // The received arguments
+    std::vector<std::string> args;
+};
 
 void process_mutex::init(Napi::Env env, Napi::Object &exports) {
     Napi::Function func = DefineClass(env, "process_mutex", {
             StaticMethod("try_create", &process_mutex::try_create, napi_enumerable),
+            StaticMethod("forward_args", &process_mutex::forward_args, napi_enumerable),
+            InstanceMethod("receive_args", &process_mutex::receive_args, napi_enumerable),
             InstanceMethod("destroy", &process_mutex::destroy, napi_enumerable)
     });
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
-
+    env.GetInstanceData<addon_data>()->process_mutex_constructor = Napi::Persistent(func);
     exports.Set("process_mutex", func);
-    env.SetInstanceData<Napi::FunctionReference>(constructor);
 }
 
 Napi::Value process_mutex::try_create(const Napi::CallbackInfo &info) {
     CHECK_ARGS(napi_tools::string);
 
-    if (constructor == nullptr) {
+    const Napi::FunctionReference &constructor = info.Env().GetInstanceData<addon_data>()->process_mutex_constructor;
+    if (constructor.IsEmpty()) {
         return info.Env().Null();
     }
 
     try {
-        return constructor->New({info[0].ToString()});
+        return constructor.New({info[0].ToString(), info[1]});
     } catch (...) {
         return info.Env().Null();
     }
 }
 
+Napi::Value process_mutex::forward_args(const Napi::CallbackInfo &info) {
+    CHECK_ARGS(napi_tools::string);
+    const std::string name = info[0].ToString().Utf8Value();
+    if (!info[1].IsArray()) {
+        throw Napi::TypeError::New(info.Env(), "The arguments must be an array of strings");
+    }
+
+    const Napi::Array array = info[1].As<Napi::Array>();
+    std::vector<std::string> args;
+    args.reserve(array.Length());
+    for (uint32_t i = 0; i < array.Length(); i++) {
+        args.push_back(array.Get(i).ToString().Utf8Value());
+    }
+
+    TRY
+        return Napi::Boolean::New(info.Env(), instance_lock::forward(name, args));
+    CATCH_EXCEPTIONS
+}
+
 process_mutex::process_mutex(const Napi::CallbackInfo &info) : ObjectWrap(info) {
     CHECK_ARGS(napi_tools::string);
     const std::string name = info[0].ToString().Utf8Value();
 
+    std::string backend = "semaphore";
+    bool receive = false;
+    if (!info[1].IsUndefined() && !info[1].IsNull()) {
+        if (!info[1].IsObject()) {
+            throw Napi::TypeError::New(info.Env(), "The options must be of type object");
+        }
+
+        const Napi::Object obj = info[1].ToObject();
+        if (obj.Has("backend") && !obj.Get("backend").IsUndefined()) {
+            backend = obj.Get("backend").ToString().Utf8Value();
+        }
+
+        if (obj.Has("receive_args") && !obj.Get("receive_args").IsUndefined()) {
+            receive = obj.Get("receive_args").ToBoolean().Value();
+        }
+    }
+
+    if (backend != "semaphore" && backend != "lock_file") {
+        throw Napi::TypeError::New(info.Env(), "Unknown backend: " + backend);
+    } else if (receive && backend != "lock_file") {
+        throw Napi::TypeError::New(info.Env(), "Receiving arguments requires the lock_file backend");
+    }
+
     TRY
-        instance = shared_mutex::createShared_mutex(name, false);
+        if (backend == "lock_file") {
+            lock = std::make_shared<instance_lock>(name, receive);
+        } else {
+            // The automatic backend would be the futex on linux, use the documented semaphore everywhere
+            shared_mutex_options options;
+            options.backend = shared_mutex_backend::semaphore;
+            instance = shared_mutex::createShared_mutex(name, false, options);
+        }
     CATCH_EXCEPTIONS
 }
 
+Napi::Value process_mutex::receive_args(const Napi::CallbackInfo &info) {
+    const wait_options options = convert_wait_options(info.Env(), info[0]);
+    if (!lock || !lock->receiving()) {
+        auto deferred = Napi::Promise::Deferred::New(info.Env());
+        deferred.Reject(Napi::Error::New(info.Env(), "The mutex doesn't receive arguments").Value());
+
+        return deferred.Promise();
+    }
+
+    return node_wait_request::submit(info.Env(), std::make_shared<receive_args_request>(lock, options.deadline),
+                                     options.signal);
+}
+
 void process_mutex::destroy(const Napi::CallbackInfo &info) {
     CHECK_CREATED();
 
     TRY
         instance.reset();
+        if (lock) {
+            // Pending requests still reference the lock, release it now and let them fail
+            lock->release();
+            async_waiter::instance().notify_if_waiting();
+            lock.reset();
+        }
     CATCH_EXCEPTIONS
 }
 
 process_mutex::~process_mutex() = default;
-
-Napi::FunctionReference *process_mutex::constructor = nullptr;
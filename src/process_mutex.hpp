@@ -3,6 +3,7 @@
 
 #include <napi.h>
 #include "shared_mutex.hpp"
+#include "instance_lock.hpp"
 
 /**
  * A process mutex
@@ -25,6 +26,14 @@ public:
      */
     static Napi::Value try_create(const Napi::CallbackInfo &info);
 
+    /**
+     * Forward arguments to the running instance of a program
+     *
+     * @param info the callback info
+     * @return false if no instance receives the arguments
+     */
+    static Napi::Value forward_args(const Napi::CallbackInfo &info);
+
     /**
      * Create a process_mutex instance
      *
@@ -32,6 +41,14 @@ public:
      */
     explicit process_mutex(const Napi::CallbackInfo &info);
 
+    /**
+     * Receive the arguments forwarded by another instance. Async call.
+     *
+     * @param info the callback info
+     * @return the promise
+     */
+    Napi::Value receive_args(const Napi::CallbackInfo &info);
+
     /**
      * Destroy the process mutex
      *
@@ -45,11 +62,10 @@ public:
     ~process_mutex() override;
 
 private:
-    // The js constructor
-    static Napi::FunctionReference *constructor;
-
-    // The mutex instance
+    // The mutex instance, if the semaphore backend is used
     std::unique_ptr<shared_mutex> instance;
+    // The instance lock, if the lock_file backend is used
+    std::shared_ptr<instance_lock> lock;
 };
 
 #endif //SHARED_MUTEX_PROCESS_MUTEX_HPP
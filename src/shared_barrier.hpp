@@ -0,0 +1,243 @@
+#ifndef SHARED_MUTEX_SHARED_BARRIER_HPP
+#define SHARED_MUTEX_SHARED_BARRIER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * A named reusable barrier in a shared memory segment.
+ * Every participant arrives once per phase, all waiters are
+ * released once the last participant arrived, which starts the next phase.
+ *
+ * The phase and the number of arrived participants share a single
+ * word, so a participant which stops waiting can withdraw its arrival
+ * without racing the participant completing the phase.
+ */
+class shared_barrier {
+public:
+    // The max number of participants of a barrier
+    static constexpr uint32_t max_count = 0xffffu;
+
+    /**
+     * Open or create a barrier
+     *
+     * @param name the name of the barrier
+     * @param count the number of participants, all processes must pass the same count
+     */
+    shared_barrier(std::string name, uint32_t count) : _name(std::move(name)) {
+        if (count == 0 || count > max_count) {
+            throw shared_mutex_exception("The number of participants must be between 1 and " +
+                                         std::to_string(max_count));
+        }
+
+        _memory = shared_memory::open_shared(_name + ".barrier", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(barrier_kind, _name, [&] {
+            _data->state.store(0, std::memory_order_relaxed);
+            _data->count = count;
+        });
+
+        if (_data->count != count) {
+            throw shared_mutex_exception("A barrier with the name '" + _name +
+                                         "' already exists with a different number of participants");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_barrier(const shared_barrier &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_barrier &operator=(const shared_barrier &) = delete;
+
+    /**
+     * Arrive at the barrier without waiting. Completes the
+     * phase and releases all waiters if this was the last participant.
+     *
+     * @return the phase the caller arrived in, used to wait for its completion
+     */
+    uint32_t arrive() noexcept {
+        uint32_t state = _data->state.load(std::memory_order_relaxed);
+        uint32_t next;
+        do {
+            if (arrived(state) + 1 >= _data->count) {
+                next = (phase(state) + 1) << phase_shift;
+            } else {
+                next = state + 1;
+            }
+        } while (!_data->state.compare_exchange_weak(state, next, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed));
+
+        if (arrived(next) == 0) {
+            futex::wake(_data->state, INT_MAX);
+        }
+
+        return phase(state);
+    }
+
+    /**
+     * Arrive at the barrier and wait until all participants arrived. Blocking call.
+     */
+    void arrive_and_wait() {
+        (void) timed_arrive_and_wait(futex::clock::time_point::max());
+    }
+
+    /**
+     * Arrive at the barrier and wait until all participants arrived, for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return false if the timeout was reached, the arrival is withdrawn in that case
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool arrive_and_wait_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_arrive_and_wait(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Arrive at the barrier and wait until all participants arrived, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return false if the deadline was reached, the arrival is withdrawn in that case
+     */
+    [[nodiscard]] bool timed_arrive_and_wait(futex::clock::time_point deadline) {
+        return timed_wait(arrive(), deadline);
+    }
+
+    /**
+     * Wait until the phase an arrival was made in completes, waiting until the deadline at most
+     *
+     * @param token the phase returned by arrive()
+     * @param deadline the time point to stop waiting at
+     * @return false if the deadline was reached, the arrival is withdrawn in that case
+     */
+    [[nodiscard]] bool timed_wait(uint32_t token, futex::clock::time_point deadline) {
+        uint32_t state;
+        while (phase(state = _data->state.load(std::memory_order_acquire)) == token) {
+            if (!futex::wait_until(_data->state, state, deadline)) {
+                // The phase may have completed while timing out
+                return !withdraw(token);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Check whether the phase an arrival was made in has completed
+     *
+     * @param token the phase returned by arrive()
+     * @return true if all participants arrived in that phase
+     */
+    [[nodiscard]] bool completed(uint32_t token) const noexcept {
+        return phase(_data->state.load(std::memory_order_acquire)) != token;
+    }
+
+    /**
+     * Prepare waiting for a phase to complete after completed() returned false
+     *
+     * @param token the phase returned by arrive()
+     * @param target set to the state word
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(uint32_t token, futex_target &target) const noexcept {
+        const uint32_t state = _data->state.load(std::memory_order_seq_cst);
+        if (phase(state) != token) return wait_preparation::retry;
+
+        target.word = &_data->state;
+        target.expected = state;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Withdraw an arrival, if its phase has not completed yet
+     *
+     * @param token the phase returned by arrive()
+     * @return true if the arrival was withdrawn, false if the phase already completed
+     */
+    bool withdraw(uint32_t token) noexcept {
+        uint32_t state = _data->state.load(std::memory_order_relaxed);
+        do {
+            if (phase(state) != token || arrived(state) == 0) return false;
+        } while (!_data->state.compare_exchange_weak(state, state - 1, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed));
+
+        return true;
+    }
+
+    /**
+     * Get the number of participants
+     *
+     * @return the number of participants which must arrive to complete a phase
+     */
+    [[nodiscard]] uint32_t count() const noexcept {
+        return _data->count;
+    }
+
+    /**
+     * Get the number of participants which arrived in the current phase
+     *
+     * @return the number of arrived participants
+     */
+    [[nodiscard]] uint32_t arrived() const noexcept {
+        return arrived(_data->state.load(std::memory_order_relaxed));
+    }
+
+private:
+    // The number of bits the phase is shifted by in the state word
+    static constexpr uint32_t phase_shift = 16;
+    // The bits of the state word storing the number of arrived participants
+    static constexpr uint32_t arrived_mask = (1u << phase_shift) - 1;
+
+    /**
+     * Get the phase from a state word
+     *
+     * @param state the state word
+     * @return the phase
+     */
+    static constexpr uint32_t phase(uint32_t state) noexcept {
+        return state >> phase_shift;
+    }
+
+    /**
+     * Get the number of arrived participants from a state word
+     *
+     * @param state the state word
+     * @return the number of arrived participants
+     */
+    static constexpr uint32_t arrived(uint32_t state) noexcept {
+        return state & arrived_mask;
+    }
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The phase in the upper and the number of arrived participants in the lower bits
+        std::atomic<uint32_t> state;
+        // The number of participants
+        uint32_t count;
+    };
+
+    // The name of the barrier
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+};
+
+#endif //SHARED_MUTEX_SHARED_BARRIER_HPP
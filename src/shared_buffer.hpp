@@ -0,0 +1,220 @@
+#ifndef SHARED_MUTEX_SHARED_BUFFER_HPP
+#define SHARED_MUTEX_SHARED_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "handle_registry.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * A named shared memory buffer which can be grown. The data is stored in
+ * its own segment, its size in a separate control segment. Growing the
+ * buffer enlarges the data segment, every process maps the new size the
+ * next time it asks for the mapping. Mappings of the old size stay valid
+ * and show the same memory, so the buffer can't be shrunk.
+ *
+ * The buffer doesn't synchronize accesses to its data, pair it with a mutex.
+ */
+class shared_buffer {
+public:
+    // The max size of a buffer in bytes
+    static constexpr uint64_t max_size = 1ull << 40u;
+
+    /**
+     * Open or create a buffer. Grows the buffer, if it
+     * already exists and is smaller than the given size.
+     *
+     * @param name the name of the buffer
+     * @param size the size of the buffer in bytes
+     */
+    shared_buffer(const std::string &name, size_t size) {
+        check_size(size);
+        _region = handle_registry<region>::instance().acquire(name, true, [&] {
+            return std::make_unique<region>(name, size);
+        });
+
+        if (_region->control->size.load(std::memory_order_acquire) < size) grow(size);
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_buffer(const shared_buffer &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_buffer &operator=(const shared_buffer &) = delete;
+
+    /**
+     * Get the mapping of the data, maps the buffer again if another process grew it.
+     * The mapping stays valid as long as a reference to it exists.
+     *
+     * @return the mapping, which is at least as large as the buffer
+     */
+    [[nodiscard]] std::shared_ptr<shared_memory> mapping() {
+        std::unique_lock<std::mutex> lock(_region->mutex);
+        const size_t current = _region->control->size.load(std::memory_order_acquire);
+        if (_region->data->size() < current) {
+            _region->data = std::make_shared<shared_memory>(_region->data_name, current, true);
+        }
+
+        return _region->data;
+    }
+
+    /**
+     * Get the size of the buffer
+     *
+     * @return the size in bytes
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return _region->control->size.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Grow the buffer. Does nothing if the buffer is already at least as large.
+     * Not supported on windows, where file mappings can't be resized.
+     *
+     * @param size the new size of the buffer in bytes
+     */
+    void grow(size_t size) {
+        check_size(size);
+        if (_region->control->size.load(std::memory_order_acquire) >= size) return;
+
+#ifdef OS_WINDOWS
+        throw shared_mutex_exception("Shared buffers can't be grown on windows");
+#else
+        resize_guard guard(_region->control->resize);
+        if (_region->control->size.load(std::memory_order_relaxed) >= size) return;
+
+        // Mapping the segment with a larger size enlarges it
+        std::shared_ptr<shared_memory> data = std::make_shared<shared_memory>(_region->data_name, size, true);
+        _region->control->size.store(size, std::memory_order_release);
+
+        std::unique_lock<std::mutex> lock(_region->mutex);
+        if (_region->data->size() < size) _region->data = std::move(data);
+#endif //OS_WINDOWS
+    }
+
+private:
+    /**
+     * The data stored in the control segment
+     */
+    struct control_data {
+        // The segment header
+        segment_header header;
+        // The size of the buffer in bytes
+        std::atomic<uint64_t> size;
+        // The lock word serializing changes to the size of the data segment
+        std::atomic<uint32_t> resize;
+    };
+
+    /**
+     * The state shared by all instances of a buffer in this process
+     */
+    class region {
+    public:
+        /**
+         * Open or create the segments of a buffer
+         *
+         * @param name the name of the buffer
+         * @param size the size of the buffer in bytes, if it is created
+         */
+        region(const std::string &name, size_t size) : data_name(name + ".buffer.data") {
+            memory = shared_memory::open_shared(name + ".buffer", sizeof(control_data), true);
+            control = memory->as<control_data>();
+            control->header.initialize(buffer_kind, name, [] {});
+
+            // Creating the data segment resizes it, which must not race with grow()
+            resize_guard guard(control->resize);
+            const size_t current = std::max<size_t>(control->size.load(std::memory_order_relaxed), size);
+            data = std::make_shared<shared_memory>(data_name, current, true);
+            control->size.store(current, std::memory_order_release);
+        }
+
+        /**
+         * Remove the name of the data segment, the control
+         * segment removes its own name
+         */
+        void unlink() noexcept {
+            data->unlink();
+        }
+
+        // The name of the data segment
+        const std::string data_name;
+        // The control segment
+        std::shared_ptr<shared_memory> memory;
+        // The data in the control segment
+        control_data *control = nullptr;
+        // The mutex guarding the current mapping
+        std::mutex mutex;
+        // The current mapping of the data segment
+        std::shared_ptr<shared_memory> data;
+    };
+
+    /**
+     * Holds the resize lock of a buffer. Resizing is rare, so this is a plain futex lock.
+     */
+    class resize_guard {
+    public:
+        /**
+         * Lock the resize lock
+         *
+         * @param word the lock word
+         */
+        explicit resize_guard(std::atomic<uint32_t> &word) noexcept: _word(word) {
+            uint32_t state = 0;
+            if (_word.compare_exchange_strong(state, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            if (state != 2) state = _word.exchange(2, std::memory_order_acquire);
+            while (state != 0) {
+                futex::wait(_word, 2);
+                state = _word.exchange(2, std::memory_order_acquire);
+            }
+        }
+
+        resize_guard(const resize_guard &) = delete;
+
+        resize_guard &operator=(const resize_guard &) = delete;
+
+        /**
+         * Unlock the resize lock
+         */
+        ~resize_guard() {
+            if (_word.exchange(0, std::memory_order_release) == 2) {
+                futex::wake(_word, 1);
+            }
+        }
+
+    private:
+        // The lock word
+        std::atomic<uint32_t> &_word;
+    };
+
+    /**
+     * Check the size passed to an operation
+     *
+     * @param size the size in bytes
+     */
+    static void check_size(size_t size) {
+        if (size == 0 || size > max_size) {
+            throw shared_mutex_exception("The size of a shared buffer must be between 1 and " +
+                                         std::to_string(max_size) + " bytes");
+        }
+    }
+
+    // The state of the buffer in this process
+    std::shared_ptr<region> _region;
+};
+
+#endif //SHARED_MUTEX_SHARED_BUFFER_HPP
@@ -0,0 +1,216 @@
+#ifndef SHARED_MUTEX_SHARED_CONDITION_VARIABLE_HPP
+#define SHARED_MUTEX_SHARED_CONDITION_VARIABLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+
+/**
+ * A named condition variable in a shared memory segment, used
+ * together with a shared_mutex. Waiters sleep on a sequence number
+ * which is incremented by every notification.
+ *
+ * Like std::condition_variable, waits may return spuriously and
+ * notifications are not stored, waiters must check their condition
+ * while holding the mutex.
+ */
+class shared_condition_variable {
+public:
+    /**
+     * Open or create a condition variable
+     *
+     * @param name the name of the condition variable
+     */
+    explicit shared_condition_variable(std::string name) : _name(std::move(name)) {
+        _memory = shared_memory::open_shared(_name + ".condition", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(condition_kind, _name, [] {});
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_condition_variable(const shared_condition_variable &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_condition_variable &operator=(const shared_condition_variable &) = delete;
+
+    /**
+     * Wait for a notification. The mutex must be locked by the caller,
+     * it is unlocked while waiting and locked again before returning.
+     *
+     * @tparam Mutex the type of the mutex, like shared_mutex
+     * @param mutex the mutex to unlock while waiting
+     */
+    template<class Mutex>
+    void wait(Mutex &mutex) {
+        (void) timed_wait(mutex, futex::clock::time_point::max());
+    }
+
+    /**
+     * Wait until the predicate is satisfied
+     *
+     * @tparam Mutex the type of the mutex, like shared_mutex
+     * @tparam Predicate the type of the predicate
+     * @param mutex the mutex to unlock while waiting
+     * @param predicate the predicate, checked while the mutex is locked
+     */
+    template<class Mutex, class Predicate>
+    void wait(Mutex &mutex, Predicate predicate) {
+        while (!predicate()) wait(mutex);
+    }
+
+    /**
+     * Wait for a notification for at most the given duration
+     *
+     * @tparam Mutex the type of the mutex, like shared_mutex
+     * @param mutex the mutex to unlock while waiting
+     * @param timeout the max time to wait for
+     * @return false if the timeout was reached
+     */
+    template<class Mutex, class Rep, class Period>
+    bool wait_for(Mutex &mutex, const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_wait(mutex, futex::deadline_after(timeout));
+    }
+
+    /**
+     * Wait until the predicate is satisfied for at most the given duration
+     *
+     * @tparam Mutex the type of the mutex, like shared_mutex
+     * @tparam Predicate the type of the predicate
+     * @param mutex the mutex to unlock while waiting
+     * @param timeout the max time to wait for
+     * @param predicate the predicate, checked while the mutex is locked
+     * @return the value of the predicate after waiting
+     */
+    template<class Mutex, class Rep, class Period, class Predicate>
+    bool wait_for(Mutex &mutex, const std::chrono::duration<Rep, Period> &timeout, Predicate predicate) {
+        const auto deadline = futex::deadline_after(timeout);
+        while (!predicate()) {
+            if (!timed_wait(mutex, deadline)) return predicate();
+        }
+
+        return true;
+    }
+
+    /**
+     * Wait for a notification until the deadline at most
+     *
+     * @tparam Mutex the type of the mutex, like shared_mutex
+     * @param mutex the mutex to unlock while waiting
+     * @param deadline the time point to stop waiting at
+     * @return false if the deadline was reached
+     */
+    template<class Mutex>
+    bool timed_wait(Mutex &mutex, futex::clock::time_point deadline) {
+        const uint32_t sequence = begin_wait();
+        mutex.unlock();
+
+        bool notified = true;
+        while (_data->sequence.load(std::memory_order_acquire) == sequence) {
+            if (!futex::wait_until(_data->sequence, sequence, deadline)) {
+                notified = notified_since(sequence);
+                break;
+            }
+        }
+
+        end_wait();
+        mutex.lock();
+        return notified;
+    }
+
+    /**
+     * Wake up one waiter
+     */
+    void notify_one() {
+        _data->sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (_data->waiters.load(std::memory_order_seq_cst) > 0) {
+            futex::wake(_data->sequence, 1);
+        }
+    }
+
+    /**
+     * Wake up all waiters
+     */
+    void notify_all() {
+        _data->sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (_data->waiters.load(std::memory_order_seq_cst) > 0) {
+            futex::wake(_data->sequence, INT_MAX);
+        }
+    }
+
+    /**
+     * Register a waiter. Must be called before the mutex is unlocked,
+     * end_wait() must be called once the waiter stopped waiting.
+     *
+     * @return the sequence number to wait for a change of
+     */
+    [[nodiscard]] uint32_t begin_wait() noexcept {
+        // Notifications increment the sequence before checking for waiters
+        _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+        return _data->sequence.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Check whether a notification happened since begin_wait()
+     *
+     * @param sequence the sequence number returned by begin_wait()
+     * @return true if the condition variable was notified
+     */
+    [[nodiscard]] bool notified_since(uint32_t sequence) const noexcept {
+        return _data->sequence.load(std::memory_order_acquire) != sequence;
+    }
+
+    /**
+     * Prepare waiting for a notification
+     *
+     * @param sequence the sequence number returned by begin_wait()
+     * @param target set to the sequence word
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(uint32_t sequence, futex_target &target) noexcept {
+        if (notified_since(sequence)) return wait_preparation::retry;
+
+        target.word = &_data->sequence;
+        target.expected = sequence;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Unregister a waiter
+     */
+    void end_wait() noexcept {
+        _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The notification sequence number
+        std::atomic<uint32_t> sequence;
+        // The number of threads and operations waiting for a notification
+        std::atomic<uint32_t> waiters;
+    };
+
+    // The name of the condition variable
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+};
+
+#endif //SHARED_MUTEX_SHARED_CONDITION_VARIABLE_HPP
@@ -0,0 +1,213 @@
+#ifndef SHARED_MUTEX_SHARED_EVENT_HPP
+#define SHARED_MUTEX_SHARED_EVENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * Options for creating a shared_event
+ */
+struct shared_event_options {
+    // Whether the event stays set until reset() is called. Otherwise,
+    // the event is reset once a single waiter was released.
+    bool manual_reset = false;
+    // Whether the event is set when it is created
+    bool initially_set = false;
+};
+
+/**
+ * A named event in a shared memory segment, like a windows event.
+ * Waiters sleep on the state word until the event is set.
+ */
+class shared_event {
+public:
+    /**
+     * Open or create an event
+     *
+     * @param name the name of the event
+     * @param options the event options, the initial state is only used by the process creating the event
+     */
+    explicit shared_event(std::string name, const shared_event_options &options = {}) : _name(std::move(name)) {
+        _memory = shared_memory::open_shared(_name + ".event", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(event_kind, _name, [&] {
+            _data->manual_reset = options.manual_reset ? 1 : 0;
+            _data->state.store(options.initially_set ? set_state : reset_state, std::memory_order_relaxed);
+        });
+
+        if (_data->manual_reset != (options.manual_reset ? 1u : 0u)) {
+            throw shared_mutex_exception(
+                    "An event with the name '" + _name + "' already exists with a different reset mode");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_event(const shared_event &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_event &operator=(const shared_event &) = delete;
+
+    /**
+     * Set the event. Wakes up all waiters of a manual reset
+     * event or a single waiter of an auto reset event.
+     */
+    void set() {
+        _data->state.store(set_state, std::memory_order_seq_cst);
+        if (_data->waiters.load(std::memory_order_seq_cst) > 0) {
+            futex::wake(_data->state, _data->manual_reset ? INT_MAX : 1);
+        }
+    }
+
+    /**
+     * Reset the event
+     */
+    void reset() noexcept {
+        _data->state.store(reset_state, std::memory_order_relaxed);
+    }
+
+    /**
+     * Check whether the event is set. Resets an auto reset event, if it was set.
+     *
+     * @return true if the event was set
+     */
+    [[nodiscard]] bool try_wait() noexcept {
+        if (_data->manual_reset) {
+            return _data->state.load(std::memory_order_acquire) == set_state;
+        }
+
+        uint32_t state = set_state;
+        return _data->state.compare_exchange_strong(state, reset_state, std::memory_order_acquire,
+                                                    std::memory_order_relaxed);
+    }
+
+    /**
+     * Wait until the event is set. Blocking call.
+     */
+    void wait() {
+        (void) timed_wait(futex::clock::time_point::max());
+    }
+
+    /**
+     * Wait until the event is set for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return false if the timeout was reached
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool wait_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_wait(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Wait until the event is set, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return false if the deadline was reached
+     */
+    [[nodiscard]] bool timed_wait(futex::clock::time_point deadline) {
+        if (try_wait()) return true;
+
+        // set() stores the state before checking for waiters
+        _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+        bool signalled;
+        while (!(signalled = try_wait())) {
+            if (!futex::wait_until(_data->state, reset_state, deadline)) {
+                signalled = try_wait();
+                // An auto reset event may have woken this waiter instead of another one, pass it on
+                if (!signalled && !_data->manual_reset) futex::wake(_data->state, 1);
+                break;
+            }
+        }
+
+        _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+        return signalled;
+    }
+
+    /**
+     * Prepare waiting for the event after try_wait() returned false.
+     * Registers the caller as a waiter, leave_wait() must be called once it stopped waiting.
+     *
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the state word
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(bool &registered, futex_target &target) noexcept {
+        if (!registered) {
+            _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+            registered = true;
+        }
+
+        if (_data->state.load(std::memory_order_seq_cst) == set_state) return wait_preparation::retry;
+
+        target.word = &_data->state;
+        target.expected = reset_state;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Stop waiting for the event after prepare_wait() was called
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     * @param signalled whether the caller consumed the event
+     */
+    void leave_wait(bool &registered, bool signalled) noexcept {
+        if (!registered) return;
+
+        _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+        registered = false;
+
+        // An auto reset event may have woken this waiter instead of another one, pass it on
+        if (!signalled && !_data->manual_reset) futex::wake(_data->state, 1);
+    }
+
+    /**
+     * Check whether the event must be reset manually
+     *
+     * @return true if this is a manual reset event
+     */
+    [[nodiscard]] bool manual_reset() const noexcept {
+        return _data->manual_reset != 0;
+    }
+
+private:
+    // The event is not set
+    static constexpr uint32_t reset_state = 0;
+    // The event is set
+    static constexpr uint32_t set_state = 1;
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // Whether the event is set
+        std::atomic<uint32_t> state;
+        // Whether the event must be reset manually
+        uint32_t manual_reset;
+        // The number of threads and operations waiting for the event
+        std::atomic<uint32_t> waiters;
+    };
+
+    // The name of the event
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+};
+
+#endif //SHARED_MUTEX_SHARED_EVENT_HPP
@@ -0,0 +1,165 @@
+#ifndef SHARED_MUTEX_SHARED_LATCH_HPP
+#define SHARED_MUTEX_SHARED_LATCH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * A named single use latch in a shared memory segment.
+ * The counter is decremented by any number of participants,
+ * all waiters are released once it reaches zero. A latch
+ * can't be reset, it stays open until all instances were destroyed.
+ */
+class shared_latch {
+public:
+    /**
+     * Open or create a latch
+     *
+     * @param name the name of the latch
+     * @param count the initial counter value, only used by the process creating the latch
+     */
+    shared_latch(std::string name, uint32_t count) : _name(std::move(name)) {
+        _memory = shared_memory::open_shared(_name + ".latch", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(latch_kind, _name, [&] {
+            _data->count.store(count, std::memory_order_relaxed);
+        });
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_latch(const shared_latch &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_latch &operator=(const shared_latch &) = delete;
+
+    /**
+     * Decrement the counter. Releases all waiters once it reaches zero.
+     *
+     * @param n the value to decrement the counter by
+     */
+    void count_down(uint32_t n = 1) {
+        uint32_t count = _data->count.load(std::memory_order_relaxed);
+        do {
+            if (n > count) {
+                throw shared_mutex_exception("The counter of the latch '" + _name + "' can't be decremented by " +
+                                             std::to_string(n) + ", it is " + std::to_string(count));
+            }
+        } while (!_data->count.compare_exchange_weak(count, count - n, std::memory_order_acq_rel,
+                                                     std::memory_order_relaxed));
+
+        if (count == n && n > 0) {
+            futex::wake(_data->count, INT_MAX);
+        }
+    }
+
+    /**
+     * Check whether the counter reached zero
+     *
+     * @return true if the latch is open
+     */
+    [[nodiscard]] bool try_wait() const noexcept {
+        return _data->count.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * Wait until the counter reaches zero. Blocking call.
+     */
+    void wait() const {
+        (void) timed_wait(futex::clock::time_point::max());
+    }
+
+    /**
+     * Wait until the counter reaches zero for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return false if the timeout was reached
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+        return timed_wait(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Wait until the counter reaches zero, waiting until the deadline at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return false if the deadline was reached
+     */
+    [[nodiscard]] bool timed_wait(futex::clock::time_point deadline) const {
+        uint32_t count;
+        while ((count = _data->count.load(std::memory_order_acquire)) != 0) {
+            if (!futex::wait_until(_data->count, count, deadline)) {
+                return try_wait();
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Decrement the counter and wait until it reaches zero. Blocking call.
+     *
+     * @param n the value to decrement the counter by
+     */
+    void arrive_and_wait(uint32_t n = 1) {
+        count_down(n);
+        wait();
+    }
+
+    /**
+     * Prepare waiting for the counter to reach zero after try_wait() returned false
+     *
+     * @param target set to the counter
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) const noexcept {
+        const uint32_t count = _data->count.load(std::memory_order_seq_cst);
+        if (count == 0) return wait_preparation::retry;
+
+        target.word = &_data->count;
+        target.expected = count;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Get the current counter value
+     *
+     * @return the number of count downs still required to open the latch
+     */
+    [[nodiscard]] uint32_t count() const noexcept {
+        return _data->count.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The remaining count
+        std::atomic<uint32_t> count;
+    };
+
+    // The name of the latch
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+};
+
+#endif //SHARED_MUTEX_SHARED_LATCH_HPP
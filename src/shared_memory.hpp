@@ -0,0 +1,339 @@
+#ifndef SHARED_MUTEX_SHARED_MEMORY_HPP
+#define SHARED_MUTEX_SHARED_MEMORY_HPP
+
+#include <string>
+#include <utility>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_mutex_exception.hpp"
+#include "handle_registry.hpp"
+
+#ifdef OS_WINDOWS
+
+#   include <Windows.h>
+
+#elif defined(OS_UNIX)
+
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <cerrno>
+
+#   ifndef PERM
+#       define PERM 0600
+#   endif
+
+#endif
+
+/**
+ * The kinds of objects stored in shared memory segments
+ */
+enum segment_kind : uint32_t {
+    // A futex based shared_mutex
+    futex_mutex_kind = 1,
+    // A robust shared_mutex
+    robust_mutex_kind = 2,
+    // A fair shared_mutex
+    fair_mutex_kind = 3,
+    // The contention statistics of a mutex
+    stats_kind = 4,
+    // A lock_table
+    lock_table_kind = 5,
+    // A shared_semaphore
+    semaphore_kind = 6,
+    // A shared_condition_variable
+    condition_kind = 7,
+    // A shared_event
+    event_kind = 8,
+    // A lease_mutex
+    lease_kind = 9,
+    // A shared_seqlock
+    seqlock_kind = 10,
+    // The control segment of a shared_buffer
+    buffer_kind = 11,
+    // A shared_ring
+    ring_kind = 12,
+    // A shared_mutex using the pi backend
+    pi_mutex_kind = 13,
+    // The lock_trace ring
+    trace_kind = 14,
+    // A shared_barrier
+    barrier_kind = 15,
+    // A shared_latch
+    latch_kind = 16
+};
+
+/**
+ * The header at the start of every shared memory segment
+ * used by this library. Segments are zero-filled on creation,
+ * the first process opening a segment initializes it.
+ */
+struct segment_header {
+    // The initialization state of the segment
+    std::atomic<uint32_t> state;
+    // The kind of object stored in the segment
+    uint32_t kind;
+
+    /**
+     * Initialize the segment or wait for another process to initialize it.
+     * Throws an exception if the segment stores a different kind of object.
+     *
+     * @param object_kind the kind of object stored in the segment
+     * @param name the name of the segment, used for error messages
+     * @param init the function initializing the object, only called in the initializing process
+     */
+    template<class Init>
+    void initialize(uint32_t object_kind, const std::string &name, Init &&init) {
+        uint32_t expected = uninitialized;
+        if (state.compare_exchange_strong(expected, initializing, std::memory_order_acquire)) {
+            kind = object_kind;
+            try {
+                init();
+            } catch (...) {
+                // Let the next process retry the initialization
+                state.store(uninitialized, std::memory_order_release);
+                futex::wake(state);
+                throw;
+            }
+
+            state.store(ready, std::memory_order_release);
+            futex::wake(state);
+            return;
+        }
+
+        // Wait for the initializing process to finish
+        const auto deadline = futex::clock::now() + init_timeout;
+        while ((expected = state.load(std::memory_order_acquire)) != ready) {
+            if (expected == uninitialized) {
+                // The initializing process failed, try again
+                initialize(object_kind, name, init);
+                return;
+            } else if (!futex::wait_until(state, expected, deadline)) {
+                throw shared_mutex_exception("The shared object '" + name + "' was never initialized");
+            }
+        }
+
+        if (kind != object_kind) {
+            throw shared_mutex_exception(
+                    "A shared object with the name '" + name + "' already exists with a different type");
+        }
+    }
+
+private:
+    // The segment is uninitialized
+    static constexpr uint32_t uninitialized = 0;
+    // The segment is being initialized
+    static constexpr uint32_t initializing = 1;
+    // The segment is ready to be used
+    static constexpr uint32_t ready = 2;
+    // The max time to wait for another process to initialize the segment
+    static constexpr std::chrono::seconds init_timeout{5};
+};
+
+/**
+ * A named shared memory segment
+ */
+class shared_memory {
+public:
+    /**
+     * Open or create a named shared memory segment.
+     * The segment is zero-filled when it is created.
+     *
+     * @param name the segment name
+     * @param size the size of the segment in bytes
+     * @param openIfExists whether to open the segment if it already exists or throw an exception
+     */
+    shared_memory(std::string name, size_t size, bool openIfExists) : _name(std::move(name)), _data(nullptr),
+                                                                        _size(size), _created(false) {
+#ifdef OS_WINDOWS
+        std::string segment_name = "Local\\";
+        segment_name.append(_name);
+
+        SetLastError(0);
+        _mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                      static_cast<DWORD>(size & 0xffffffffu), segment_name.c_str());
+
+        if (_mapping == nullptr) {
+            throw shared_mutex_exception("Could not create the shared memory segment '" + _name + "'");
+        } else if (GetLastError() == ERROR_ALREADY_EXISTS && !openIfExists) {
+            CloseHandle(_mapping);
+            throw shared_mutex_exception(
+                    "A shared memory segment with the name '" + _name + "' already exists");
+        }
+
+        _created = GetLastError() != ERROR_ALREADY_EXISTS;
+        _data = MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        if (_data == nullptr) {
+            CloseHandle(_mapping);
+            throw shared_mutex_exception("Could not map the shared memory segment '" + _name + "'");
+        }
+#elif defined(OS_UNIX)
+        const std::string segment_name = "/" + _name;
+
+        // Try to create the segment first to find out whether it already existed
+        int fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT | O_EXCL, PERM);
+        if (fd != -1) {
+            _created = true;
+        } else if (errno == EEXIST && openIfExists) {
+            fd = shm_open(segment_name.c_str(), O_RDWR | O_CREAT, PERM);
+        }
+
+        if (fd == -1) {
+            throw shared_mutex_exception(
+                    "A shared memory segment with the name '" + _name + "' already exists");
+        }
+
+        // Grow the segment if it is too small. Another process may have just created the segment,
+        // but not resized it yet, resizing it to the same size twice is fine.
+        struct stat st{};
+        if (fstat(fd, &st) == -1 || (static_cast<size_t>(st.st_size) < size && ftruncate(fd, size) == -1)) {
+            close(fd);
+            throw shared_mutex_exception("Could not resize the shared memory segment '" + _name + "'");
+        }
+
+        _data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (_data == MAP_FAILED) {
+            _data = nullptr;
+            throw shared_mutex_exception("Could not map the shared memory segment '" + _name + "'");
+        }
+#endif
+    }
+
+    /**
+     * Open or create a named shared memory segment, sharing the mapping with
+     * all other users of the segment in this process. The name of the segment
+     * is removed once the last user in this process closed it.
+     *
+     * @param name the segment name
+     * @param size the size of the segment in bytes
+     * @param openIfExists whether to open the segment if it already exists or throw an exception
+     * @return the segment
+     */
+    static inline std::shared_ptr<shared_memory> open_shared(const std::string &name, size_t size,
+                                                             bool openIfExists);
+
+    /**
+     * No copy constructor
+     */
+    shared_memory(const shared_memory &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_memory &operator=(const shared_memory &) = delete;
+
+    /**
+     * Get the mapped memory
+     *
+     * @return a pointer to the start of the segment
+     */
+    [[nodiscard]] void *data() const noexcept {
+        return _data;
+    }
+
+    /**
+     * Get the mapped memory as a pointer to an object
+     *
+     * @tparam T the type of the object at the start of the segment
+     * @return a pointer to the object
+     */
+    template<class T>
+    [[nodiscard]] T *as() const noexcept {
+        return static_cast<T *>(_data);
+    }
+
+    /**
+     * Get the size of the mapping
+     *
+     * @return the mapped size in bytes
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return _size;
+    }
+
+    /**
+     * Check whether this instance created the segment
+     *
+     * @return true if this instance created the segment
+     */
+    [[nodiscard]] bool created() const noexcept {
+        return _created;
+    }
+
+    /**
+     * Get the name of the segment
+     *
+     * @return the segment name
+     */
+    [[nodiscard]] const std::string &name() const noexcept {
+        return _name;
+    }
+
+    /**
+     * Remove the name of the segment. Processes which
+     * already mapped the segment can still use it.
+     * Does nothing on windows, where the segment is
+     * removed once the last handle to it is closed.
+     *
+     * @return false if the name could not be removed
+     */
+    bool unlink() const noexcept {
+#ifdef OS_UNIX
+        const std::string name = "/" + _name;
+        return shm_unlink(name.c_str()) == 0;
+#else
+        return true;
+#endif //OS_UNIX
+    }
+
+    /**
+     * Unmap the segment
+     */
+    ~shared_memory() {
+#ifdef OS_WINDOWS
+        if (_data != nullptr) UnmapViewOfFile(_data);
+        if (_mapping != nullptr) CloseHandle(_mapping);
+#elif defined(OS_UNIX)
+        if (_data != nullptr) munmap(_data, _size);
+#endif
+    }
+
+private:
+    // The name of the segment
+    std::string _name;
+    // The mapped memory
+    void *_data;
+    // The size of the mapping
+    size_t _size;
+    // Whether this instance created the segment
+    bool _created;
+#ifdef OS_WINDOWS
+    // The handle to the file mapping
+    HANDLE _mapping;
+#endif //OS_WINDOWS
+};
+
+std::shared_ptr<shared_memory> shared_memory::open_shared(const std::string &name, size_t size, bool openIfExists) {
+    std::shared_ptr<shared_memory> memory = handle_registry<shared_memory>::instance().acquire(name, openIfExists, [&] {
+        return std::make_unique<shared_memory>(name, size, openIfExists);
+    });
+
+    if (memory->size() < size) {
+        throw shared_mutex_exception(
+                "A shared object with the name '" + name + "' already exists with a different type");
+    }
+
+    return memory;
+}
+
+#endif //SHARED_MUTEX_SHARED_MEMORY_HPP
@@ -2,17 +2,24 @@
 #define SHARED_MUTEX_SHARED_MUTEX_HPP
 
 #include <string>
+#include <memory>
 #include <exception>
 #include <utility>
 #include <vector>
 #include <algorithm>
 #include <iostream>
-
-#if defined(__unix__) || defined(__linux__) || defined(__APPLE__)
-#   define OS_UNIX
-#elif defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-#   define OS_WINDOWS
-#endif
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#include "platform.hpp"
+#include "shared_mutex_exception.hpp"
+#include "shared_memory.hpp"
+#include "futex.hpp"
+#include "wait_policy.hpp"
+#include "mutex_stats.hpp"
+#include "handle_registry.hpp"
 
 #ifdef OS_WINDOWS
 
@@ -22,39 +29,52 @@
 
 #   include <semaphore.h>
 #   include <fcntl.h>
+#   include <signal.h>
+#   include <unistd.h>
+#   include <pthread.h>
+#   include <cerrno>
 
-#   define PERM 0600
-
-#else
-
-#   error "shared_mutex is only supported on windows and unix systems"
+#   ifndef PERM
+#       define PERM 0600
+#   endif
 
 #endif
 
 /**
- * A shared mutex exception
+ * The implementation backing a shared_mutex.
+ * All processes using a mutex must use the same backend.
  */
-class shared_mutex_exception : public std::exception {
-public:
-    /**
-     * Create a shared mutex exception
-     *
-     * @param error the error description
-     */
-    explicit shared_mutex_exception(std::string error) : std::exception(), error(std::move(error)) {}
-
-    /**
-     * Get the error message
-     *
-     * @return the error message
-     */
-    [[nodiscard]] const char *what() const noexcept override {
-        return error.c_str();
-    }
+enum class shared_mutex_backend {
+    // The fastest backend available on this platform
+    automatic,
+    // A named semaphore
+    semaphore,
+    // A futex in a shared memory segment. Linux only.
+    futex,
+    // A lock word storing the owner's process id in a shared memory segment.
+    // Recovers the mutex if the owning process dies. Unix only.
+    robust,
+    // A ticket lock in a shared memory segment. Waiters are served in the order they arrived.
+    fair,
+    // A priority inheritance futex in a shared memory segment. The kernel boosts the
+    // priority of the owner while higher priority threads wait for it. Linux only.
+    pi
+};
 
-private:
-    // The error
-    const std::string error;
+/**
+ * Options for creating a shared_mutex
+ */
+struct shared_mutex_options {
+    // The backend to use
+    shared_mutex_backend backend = shared_mutex_backend::automatic;
+    // Whether waiting writers block new readers, preventing writer starvation
+    bool writer_preference = false;
+    // How to wait for the mutex if it is contended
+    wait_policy_options waiting;
+    // Whether to record the contention statistics in a shared memory segment next to the mutex
+    bool stats = false;
+    // Whether to record the lock events in the lock_trace ring of this machine
+    bool trace = false;
 };
 
 /**
@@ -67,21 +87,32 @@ public:
      *
      * @param mutex_name the mutex name
      * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
      * @return a pointer to the mutex
      */
-    static inline std::unique_ptr<shared_mutex> createShared_mutex(const std::string &mtx_name, bool openIfExists);
+    static inline std::unique_ptr<shared_mutex>
+    createShared_mutex(const std::string &mtx_name, bool openIfExists, const shared_mutex_options &options = {});
 
     /**
      * Create a shared_mutex instance.
      *
      * @param mutex_name the mutex name
      * @param openIfExists whether to open the mutex if it already exists or throw an exception
+     * @param waiting how to wait for the mutex if it is contended
      */
-    explicit shared_mutex(std::string mutex_name, bool openIfExists) : _mtx_name(std::move(mutex_name)), _locked(false),
-                                                                       _unique(!openIfExists) {
-        // If mtx_name already exists in owned_mutexes, throw an exception
-        if (_unique && std::find(_owned_mutexes.begin(), _owned_mutexes.end(), _mtx_name) != _owned_mutexes.end()) {
-            throw shared_mutex_exception("A mutex with the name '" + _mtx_name + "' is already owned by this program");
+    explicit shared_mutex(std::string mutex_name, bool openIfExists, const wait_policy_options &waiting = {})
+            : _mtx_name(std::move(mutex_name)), _locked(false), _unique(!openIfExists), _claimed(false),
+              _owner_died(false), _wait_policy(waiting), _locked_at(0) {
+        // Only one unique instance of a mutex may exist in this program
+        if (_unique) {
+            _claimed = owned_mutexes().with_shard(_mtx_name, [this](std::unordered_map<std::string, bool> &owned) {
+                return owned.emplace(_mtx_name, true).second;
+            });
+
+            if (!_claimed) {
+                throw shared_mutex_exception(
+                        "A mutex with the name '" + _mtx_name + "' is already owned by this program");
+            }
         }
     }
 
@@ -113,39 +144,366 @@ public:
     virtual void unlock() = 0;
 
     /**
-     * Try locking the mutex
+     * Try locking the mutex. The default implementation calls acquire()
+     * and counts failures in the statistics, subclasses may override it.
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] virtual bool try_lock() {
+        if (acquire()) return true;
+
+        _stats.try_lock_failed();
+        return false;
+    }
+
+    /**
+     * Lock the mutex in shared mode. Multiple owners may hold
+     * the mutex in shared mode at the same time. Backends which
+     * don't support shared ownership lock the mutex exclusively.
+     */
+    virtual void lock_shared() {
+        lock();
+    }
+
+    /**
+     * Unlock the mutex from shared mode
+     */
+    virtual void unlock_shared() {
+        unlock();
+    }
+
+    /**
+     * Try locking the mutex in shared mode
+     *
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] virtual bool try_lock_shared() {
+        if (acquire_shared()) return true;
+
+        _stats.try_lock_failed();
+        return false;
+    }
+
+    /**
+     * Try locking the mutex on behalf of a waiter. Unlike
+     * try_lock(), failures are not counted in the statistics.
+     *
+     * @param shared whether to lock the mutex in shared mode
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_acquire(bool shared) {
+        return shared ? acquire_shared() : acquire();
+    }
+
+    /**
+     * Try locking the mutex, waiting for the ownership for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return true, if the ownership could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking the mutex, waiting for the ownership until the given time point at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    template<class Clock, class Duration>
+    [[nodiscard]] bool try_lock_until(const std::chrono::time_point<Clock, Duration> &deadline) {
+        return timed_lock(futex::to_deadline(deadline));
+    }
+
+    /**
+     * Try locking the mutex in shared mode, waiting for at most the given duration
+     *
+     * @param timeout the max time to wait for
+     * @return true, if the shared ownership could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_lock_shared_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_lock_shared(futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try locking the mutex in shared mode, waiting until the given time point at most
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the shared ownership could be acquired
+     */
+    template<class Clock, class Duration>
+    [[nodiscard]] bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration> &deadline) {
+        return timed_lock_shared(futex::to_deadline(deadline));
+    }
+
+    /**
+     * Lock the mutex, waiting until the deadline at most.
+     * The default implementation polls acquire().
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] virtual bool timed_lock(futex::clock::time_point deadline) {
+        if (acquire()) return true;
+
+        mutex_stats_recorder::wait_scope wait(&_stats);
+        if (!poll_until(deadline, [this] { return acquire(); })) return false;
+
+        wait.acquired();
+        return true;
+    }
+
+    /**
+     * Lock the mutex in shared mode, waiting until the deadline at most.
+     * The default implementation locks the mutex exclusively.
+     *
+     * @param deadline the time point to stop waiting at
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] virtual bool timed_lock_shared(futex::clock::time_point deadline) {
+        return timed_lock(deadline);
+    }
+
+    /**
+     * Prepare waiting for the mutex without blocking a thread. Used by
+     * async waiters, which wait on the futex target themselves. Marks
+     * the mutex as having waiters, so the target will be woken up once
+     * the mutex is released. The default implementation has no target,
+     * the mutex must be polled instead.
+     *
+     * @param shared whether to wait for shared ownership
+     * @param target set to the futex word to wait on
+     * @return whether to wait on the target, retry locking the mutex immediately or poll it
+     */
+    [[nodiscard]] virtual wait_preparation prepare_wait(bool shared, futex_target &target) {
+        (void) shared;
+        (void) target;
+        return wait_preparation::unsupported;
+    }
+
+    /**
+     * Try to lock the mutex after waiting on the target set by prepare_wait().
+     * Other waiters may still be waiting, they will be woken up once the mutex is released.
      *
+     * @param shared whether to lock the mutex in shared mode
      * @return true, if the ownership could be acquired
      */
-    [[nodiscard]] virtual bool try_lock() = 0;
+    [[nodiscard]] virtual bool try_lock_after_wait(bool shared) {
+        return try_acquire(shared);
+    }
+
+    /**
+     * Stop waiting for the mutex after prepare_wait() was called.
+     * The waiter may have consumed the wake up of another waiter, pass it on.
+     *
+     * @param shared whether the waiter waited for shared ownership
+     */
+    virtual void abandon_wait(bool shared) {
+        (void) shared;
+    }
+
+    /**
+     * Check whether the mutex is owned by the thread which locked it rather than by
+     * this instance. Such a mutex must be unlocked by the thread which locked it, so
+     * async waiters can't lock it on their own thread. They wait until it appears
+     * to be unlocked instead and lock it on the thread which will unlock it.
+     *
+     * @return true if the mutex is owned by a thread
+     */
+    [[nodiscard]] virtual bool thread_owned() const noexcept {
+        return false;
+    }
+
+    /**
+     * Check whether the mutex appears to be unlocked. Used by async waiters of
+     * thread owned mutexes, the mutex may be locked again by the time this returns.
+     *
+     * @return true if the mutex was not locked
+     */
+    [[nodiscard]] virtual bool appears_unlocked() const noexcept {
+        return false;
+    }
+
+    /**
+     * Check whether the previous owner of the mutex died while holding it.
+     * Only backends which track the owner of the mutex can detect this.
+     * If this returns true after acquiring the mutex, the data protected
+     * by the mutex may be in an inconsistent state.
+     *
+     * @return true if the previous owner died while holding the mutex
+     */
+    [[nodiscard]] bool owner_died() const noexcept {
+        return _owner_died;
+    }
+
+    /**
+     * Check whether this instance owns the mutex exclusively
+     *
+     * @return true if this instance locked the mutex
+     */
+    [[nodiscard]] bool locked() const noexcept {
+        return _locked;
+    }
+
+    /**
+     * Get the name of the mutex
+     *
+     * @return the mutex name
+     */
+    [[nodiscard]] const std::string &name() const noexcept {
+        return _mtx_name;
+    }
+
+    /**
+     * Get the number of contended acquisitions which
+     * succeeded while spinning, yielding and waiting in the kernel
+     *
+     * @return the wait phase statistics
+     */
+    [[nodiscard]] wait_phase_stats wait_stats() const noexcept {
+        return _wait_policy.stats();
+    }
+
+    /**
+     * Get the contention statistics of the mutex, summed up over all processes
+     * recording them. All counters are zero if this instance was created without
+     * the stats option or SHARED_MUTEX_NO_STATS is defined.
+     *
+     * @return the contention statistics
+     */
+    [[nodiscard]] mutex_stats stats() const noexcept {
+        return _stats.snapshot();
+    }
+
+    /**
+     * Start tracking a wait for the mutex which is done outside of this instance,
+     * like an async waiter. The wait is counted as contended once it acquired the mutex.
+     *
+     * @return the wait, which stops once it is destroyed
+     */
+    [[nodiscard]] mutex_stats_recorder::wait_scope track_wait() noexcept {
+        return mutex_stats_recorder::wait_scope(&_stats);
+    }
 
     /**
      * Delete the shared_mutex instance
      */
-    virtual ~shared_mutex() = default;
+    virtual ~shared_mutex() {
+        try_remove_mutex();
+    }
 
 protected:
-    // A vector containing all mutexes owned by this program
-    static inline std::vector<std::string> _owned_mutexes = std::vector<std::string>();
+    /**
+     * Get the names of all unique mutexes owned by this program
+     *
+     * @return the owned mutex names
+     */
+    static sharded_map<bool> &owned_mutexes() {
+        // Never destroyed, mutexes may still be destroyed during static destruction
+        static auto *owned = new sharded_map<bool>();
+        return *owned;
+    }
 
     /**
-     * Try to remove the mutex name from the owned_mutexes vector
+     * Try to acquire the ownership of the mutex without waiting.
+     * Records the acquisition in the statistics.
+     *
+     * @return true, if the ownership could be acquired
      */
-    void try_remove_mutex() {
-        // Try to delete the mutex name from the owned_mutexes vector, if it exists in it
-        try {
-            if (_unique && std::find(_owned_mutexes.begin(), _owned_mutexes.end(), _mtx_name) != _owned_mutexes.end()) {
-                _owned_mutexes.erase(std::find(_owned_mutexes.begin(), _owned_mutexes.end(), _mtx_name));
-            }
-        } catch (...) {}
+    [[nodiscard]] virtual bool acquire() = 0;
+
+    /**
+     * Try to acquire the shared ownership of the mutex without waiting.
+     * The default implementation acquires the mutex exclusively.
+     *
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] virtual bool acquire_shared() {
+        return acquire();
+    }
+
+    /**
+     * Record that the mutex was locked exclusively
+     */
+    void record_locked() noexcept {
+        _stats.acquired();
+        if (_stats.recording()) {
+            _locked_at.store(futex::clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Record that the mutex was locked in shared mode
+     */
+    void record_locked_shared() noexcept {
+        _stats.acquired(true);
+    }
+
+    /**
+     * Record that the exclusively locked mutex is released.
+     * Must be called before the mutex is released.
+     */
+    void record_unlocked() noexcept {
+        if (_stats.recording() || _stats.tracing()) {
+            const futex::clock::duration locked_at(_locked_at.load(std::memory_order_relaxed));
+            _stats.released(futex::clock::now() - futex::clock::time_point(locked_at));
+        }
+    }
+
+    /**
+     * Call a function until it returns true or the deadline is reached,
+     * sleeping for an increasing amount of time in between
+     *
+     * @param deadline the time point to stop at
+     * @param fn the function to call
+     * @return true, if the function returned true
+     */
+    template<class Fn>
+    static bool poll_until(futex::clock::time_point deadline, Fn &&fn) {
+        std::chrono::microseconds interval(50);
+        while (!fn()) {
+            const auto now = futex::clock::now();
+            if (now >= deadline) return false;
+
+            std::this_thread::sleep_for(std::min<futex::clock::duration>(interval, deadline - now));
+            interval = std::min<std::chrono::microseconds>(interval * 2, std::chrono::milliseconds(5));
+        }
+
+        return true;
+    }
+
+    /**
+     * Remove the mutex name from the owned mutexes, if this instance owns it
+     */
+    void try_remove_mutex() noexcept {
+        if (!_claimed) return;
+
+        _claimed = false;
+        owned_mutexes().with_shard(_mtx_name, [this](std::unordered_map<std::string, bool> &owned) {
+            owned.erase(_mtx_name);
+        });
     }
 
     // The mutex name
     std::string _mtx_name;
-    // Whether this instance owns the mutex
-    bool _locked;
+    // Whether this instance owns the mutex. Set by the thread which acquired the mutex, which
+    // may be the async waiter thread, and cleared by the unlocking thread before releasing it.
+    std::atomic<bool> _locked;
     // Whether this mutex should be unique
     bool _unique;
+    // Whether this instance owns the mutex name in this program
+    bool _claimed;
+    // Whether the previous owner died while holding the mutex, set by the thread which acquired the mutex
+    std::atomic<bool> _owner_died;
+    // How to wait for the mutex if it is contended
+    wait_policy _wait_policy;
+    // The contention statistics, opened by the backends once the mutex was created
+    mutex_stats_recorder _stats;
+    // The clock ticks the mutex was locked exclusively at, set by the thread which acquired the mutex
+    std::atomic<futex::clock::rep> _locked_at;
 };
 
 #ifdef OS_WINDOWS
@@ -160,33 +518,17 @@ public:
      *
      * @param mutex_name the mutex name
      * @param openIfExists whether to open the mutex if it already exists or throw an exception
+     * @param options the mutex options
      */
-    win_shared_mutex(const std::string &mutex_name, bool openIfExists) : shared_mutex(mutex_name, openIfExists) {
-        // Create the name for the mutex
-        std::string name = "Local\\";
-        name.append(_mtx_name);
-
-        // Set the last error to zero
-        SetLastError(0);
-
-        // Try to create the mutex
-        HANDLE sem = CreateSemaphoreA(nullptr, 1, 1, name.c_str());
-
-        // If the mutex creation failed, throw an exception.
-        // If the mutex already exists and the mutex should not be opened
-        // if it already exists, throw an exception.
-        if (sem == nullptr) {
-            throw shared_mutex_exception("Could not create the mutex");
-        } else if (GetLastError() == ERROR_ALREADY_EXISTS && !openIfExists) {
-            // Close the handle to the mutex
-            CloseHandle(sem);
-            throw shared_mutex_exception(
-                    "A mutex with the name '" + _mtx_name + "' is already owned by another program");
-        }
-
-        // Set the handle to mutex and add the mutex name to owned_mutexes
-        this->_semaphore = sem;
-        if (_unique) _owned_mutexes.push_back(_mtx_name);
+    win_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting) {
+        // Reuse the handle to the semaphore if this program already opened it
+        _handle = handle_registry<semaphore>::instance().acquire(_mtx_name, openIfExists, [&] {
+            return std::make_unique<semaphore>(_mtx_name, openIfExists);
+        });
+
+        this->_semaphore = _handle->get();
+        _stats.open(_mtx_name, options.stats, options.trace);
     }
 
     /**
@@ -194,11 +536,17 @@ public:
      *
      * @param rhs the shared_mutex to move
      */
-    win_shared_mutex(win_shared_mutex &&rhs) noexcept: shared_mutex(std::move(rhs._mtx_name), !rhs._unique),
+    win_shared_mutex(win_shared_mutex &&rhs) noexcept: shared_mutex(std::move(rhs._mtx_name), true,
+                                                                    rhs._wait_policy.options()),
+                                                       _handle(std::move(rhs._handle)),
                                                        _semaphore(rhs._semaphore) {
         // Set the semaphore of rhs to nullptr
         rhs._semaphore = nullptr;
-        this->_locked = rhs._locked;
+        this->_locked = rhs._locked.load();
+        this->_unique = rhs._unique;
+        this->_claimed = rhs._claimed;
+        rhs._claimed = false;
+        _stats.open(_mtx_name, rhs._stats.recording(), rhs._stats.tracing());
     }
 
     /**
@@ -215,14 +563,34 @@ public:
     win_shared_mutex &operator=(win_shared_mutex &&rhs) noexcept {
         // Swap all class members
         std::swap(rhs._mtx_name, this->_mtx_name);
+        std::swap(rhs._handle, this->_handle);
         std::swap(rhs._semaphore, this->_semaphore);
-        std::swap(rhs._locked, this->_locked);
+        this->_locked = rhs._locked.exchange(this->_locked);
         std::swap(rhs._unique, this->_unique);
+        std::swap(rhs._claimed, this->_claimed);
 
         return *this;
     }
 
     void lock() override {
+        const auto try_acquire = [this] {
+            return WaitForSingleObject(_semaphore, 0) == WAIT_OBJECT_0;
+        };
+
+        if (try_acquire()) {
+            _locked = true;
+            record_locked();
+            return;
+        }
+
+        mutex_stats_recorder::wait_scope wait(&_stats);
+        if (_wait_policy.spin(try_acquire)) {
+            _locked = true;
+            wait.acquired();
+            record_locked();
+            return;
+        }
+
         DWORD res = WaitForSingleObject(_semaphore, INFINITE);
         switch (res) {
             case WAIT_ABANDONED: // The mutex the handle is pointing to is abandoned
@@ -231,6 +599,9 @@ public:
                 throw shared_mutex_exception("The wait failed");
             case WAIT_OBJECT_0: // The ownership could be acquired
                 _locked = true;
+                wait.acquired();
+                record_locked();
+                _wait_policy.parked();
                 return;
             default: // Unknown error
                 throw shared_mutex_exception("WaitForSingleObject() failed with an unknown error");
@@ -238,15 +609,81 @@ public:
     }
 
     void unlock() override {
-        // Try releasing the mutex
+        record_unlocked();
+
+        // Clear the ownership first, the mutex may be acquired by another thread right after releasing it
+        _locked = false;
         if (!ReleaseSemaphore(_semaphore, 1, nullptr)) {
+            _locked = true;
             throw shared_mutex_exception("Could not release the mutex. Error: " + getLastErrorAsString());
-        } else {
-            _locked = false;
         }
     }
 
-    [[nodiscard]] bool try_lock() override {
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        const auto try_acquire = [this] {
+            return WaitForSingleObject(_semaphore, 0) == WAIT_OBJECT_0;
+        };
+
+        if (try_acquire()) {
+            _locked = true;
+            record_locked();
+            return true;
+        }
+
+        mutex_stats_recorder::wait_scope wait(&_stats);
+        if (_wait_policy.spin(try_acquire, deadline)) {
+            _locked = true;
+            wait.acquired();
+            record_locked();
+            return true;
+        }
+
+        for (;;) {
+            // Wait for the remaining time, in steps of less than INFINITE milliseconds
+            const auto now = futex::clock::now();
+            const auto remaining = deadline > now ? std::chrono::ceil<std::chrono::milliseconds>(deadline - now)
+                                                  : std::chrono::milliseconds(0);
+            const DWORD timeout = static_cast<DWORD>(std::min<int64_t>(remaining.count(), INFINITE - 1));
+
+            DWORD res = WaitForSingleObject(_semaphore, timeout);
+            switch (res) {
+                case WAIT_ABANDONED: // The mutex the handle is pointing to is abandoned
+                    throw shared_mutex_exception("The mutex was abandoned");
+                case WAIT_FAILED: // The wait failed
+                    throw shared_mutex_exception("The wait failed");
+                case WAIT_OBJECT_0: // The ownership could be acquired
+                    _locked = true;
+                    wait.acquired();
+                    record_locked();
+                    _wait_policy.parked();
+                    return true;
+                case WAIT_TIMEOUT: // The wait timed out
+                    if (static_cast<int64_t>(timeout) == remaining.count()) return false;
+                    break;
+                default: // Unknown error
+                    throw shared_mutex_exception("WaitForSingleObject failed with an unknown error");
+            }
+        }
+    }
+
+    /**
+     * Delete this shared_mutex.
+     * Destroys the semaphore or mutex.
+     */
+    ~win_shared_mutex() override {
+        // If the semaphore is null, return
+        if (_semaphore == nullptr) return;
+
+        // Unlock the mutex if locked. The handle is closed once the last instance using it is destroyed.
+        if (_locked) {
+            if (!ReleaseSemaphore(_semaphore, 1, nullptr)) {
+                std::cerr << "Could not release the mutex. Error: " << getLastErrorAsString() << std::endl;
+            }
+        }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
         // Wait for max 1 millisecond
         DWORD res = WaitForSingleObject(_semaphore, 1);
         switch (res) {
@@ -256,6 +693,7 @@ public:
                 throw shared_mutex_exception("The wait failed");
             case WAIT_OBJECT_0: // The ownership could be acquired
                 _locked = true;
+                record_locked();
                 return true;
             case WAIT_TIMEOUT: // The wait timed out
                 return false;
@@ -264,32 +702,82 @@ public:
         }
     }
 
+private:
     /**
-     * Delete this shared_mutex.
-     * Destroys the semaphore or mutex.
+     * A handle to a named semaphore, shared by all instances of a mutex in this program
      */
-    ~win_shared_mutex() override {
-        // If the semaphore is null, return
-        if (_semaphore == nullptr) return;
-
-        // Unlock the mutex if locked
-        if (_locked) {
-            if (!ReleaseSemaphore(_semaphore, 1, nullptr)) {
-                std::cerr << "Could not release the mutex. Error: " << getLastErrorAsString() << std::endl;
+    class semaphore {
+    public:
+        /**
+         * Open or create the semaphore
+         *
+         * @param mutex_name the mutex name
+         * @param openIfExists whether to open the semaphore if it already exists or throw an exception
+         */
+        semaphore(const std::string &mutex_name, bool openIfExists) {
+            // Create the name for the mutex
+            std::string name = "Local\\";
+            name.append(mutex_name);
+
+            // Set the last error to zero
+            SetLastError(0);
+
+            // Try to create the mutex
+            _handle = CreateSemaphoreA(nullptr, 1, 1, name.c_str());
+
+            // If the mutex creation failed, throw an exception.
+            // If the mutex already exists and the mutex should not be opened
+            // if it already exists, throw an exception.
+            if (_handle == nullptr) {
+                throw shared_mutex_exception("Could not create the mutex");
+            } else if (GetLastError() == ERROR_ALREADY_EXISTS && !openIfExists) {
+                // Close the handle to the mutex
+                CloseHandle(_handle);
+                throw shared_mutex_exception(
+                        "A mutex with the name '" + mutex_name + "' is already owned by another program");
             }
         }
 
-        // Close the handle to the mutex
-        if (!CloseHandle(_semaphore)) {
-            std::cerr << "Could not close the handle to the mutex. Error: " << getLastErrorAsString() << std::endl;
+        semaphore(const semaphore &) = delete;
+
+        semaphore &operator=(const semaphore &) = delete;
+
+        /**
+         * Get the semaphore handle
+         *
+         * @return the handle
+         */
+        [[nodiscard]] HANDLE get() const noexcept {
+            return _handle;
         }
 
-        // Try to delete the mutex name from the owned_mutexes vector
-        try_remove_mutex();
-    }
+        /**
+         * Does nothing, the semaphore is removed once the last handle to it is closed
+         *
+         * @return true
+         */
+        bool unlink() const noexcept {
+            return true;
+        }
 
-private:
-    // The semaphore pointer
+        /**
+         * Close the handle to the semaphore
+         */
+        ~semaphore() {
+            if (!CloseHandle(_handle)) {
+                std::cerr << "Could not close the handle to the mutex. Error: " << getLastErrorAsString()
+                          << std::endl;
+            }
+        }
+
+    private:
+        // The semaphore handle
+        HANDLE _handle;
+    };
+
+    // The semaphore shared by all instances of this mutex
+    std::shared_ptr<semaphore> _handle;
+    // The semaphore handle
     HANDLE _semaphore;
 
     /**
@@ -338,31 +826,17 @@ public:
      *
      * @param mutex_name the mutex name
      * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
      */
-    unix_shared_mutex(const std::string &mutex_name, bool openIfExists) : shared_mutex(mutex_name, openIfExists) {
-        // Create the name for the mutex
-        std::string name = "/";
-        name.append(_mtx_name);
-
-        // The semaphore pointer
-        sem_t *sem;
-
-        // Try to create the semaphore
-        if (openIfExists) {
-            sem = sem_open(name.c_str(), O_CREAT, PERM, 1);
-        } else {
-            sem = sem_open(name.c_str(), O_CREAT | O_EXCL, PERM, 1);
-        }
-
-        // If the creation failed, thrown an exception
-        if (sem == SEM_FAILED) {
-            throw shared_mutex_exception(
-                    "A mutex with the name '" + _mtx_name + "' is already owned by another program");
-        } else {
-            // Set the semaphore and add the mutex name to owned_mutexes
-            this->_semaphore = sem;
-            if (_unique) _owned_mutexes.push_back(_mtx_name);
-        }
+    unix_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting) {
+        // Reuse the semaphore if this program already opened it
+        _handle = handle_registry<semaphore>::instance().acquire(_mtx_name, openIfExists, [&] {
+            return std::make_unique<semaphore>(_mtx_name, openIfExists);
+        });
+
+        this->_semaphore = _handle->get();
+        _stats.open(_mtx_name, options.stats, options.trace);
     }
 
     /**
@@ -370,11 +844,17 @@ public:
      *
      * @param rhs the shared_mutex to move
      */
-    unix_shared_mutex(unix_shared_mutex &&rhs) noexcept: shared_mutex(std::move(rhs._mtx_name), !rhs._unique),
+    unix_shared_mutex(unix_shared_mutex &&rhs) noexcept: shared_mutex(std::move(rhs._mtx_name), true,
+                                                                      rhs._wait_policy.options()),
+                                                         _handle(std::move(rhs._handle)),
                                                          _semaphore(rhs._semaphore) {
         // Set the semaphore of rhs to nullptr
         rhs._semaphore = nullptr;
-        this->_locked = rhs._locked;
+        this->_locked = rhs._locked.load();
+        this->_unique = rhs._unique;
+        this->_claimed = rhs._claimed;
+        rhs._claimed = false;
+        _stats.open(_mtx_name, rhs._stats.recording(), rhs._stats.tracing());
     }
 
     /**
@@ -391,45 +871,105 @@ public:
     unix_shared_mutex &operator=(unix_shared_mutex &&rhs) noexcept {
         // Swap all class members
         std::swap(rhs._mtx_name, this->_mtx_name);
+        std::swap(rhs._handle, this->_handle);
         std::swap(rhs._semaphore, this->_semaphore);
-        std::swap(rhs._locked, this->_locked);
+        this->_locked = rhs._locked.exchange(this->_locked);
         std::swap(rhs._unique, this->_unique);
+        std::swap(rhs._claimed, this->_claimed);
 
         return *this;
     }
 
     void lock() override {
-        // Try acquire the ownership of the semaphore
-        if (sem_wait(_semaphore) != 0) {
-            throw shared_mutex_exception("The wait failed");
-        } else {
-            // The operation was successful, we now own the semaphore
-            _locked = true;
+        // Only wait in the kernel if the semaphore could not be acquired without waiting
+        const auto try_acquire = [this] {
+            return sem_trywait(_semaphore) == 0;
+        };
+
+        if (!try_acquire()) {
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!_wait_policy.spin(try_acquire)) {
+                // Try acquire the ownership of the semaphore
+                if (sem_wait(_semaphore) != 0) {
+                    throw shared_mutex_exception("The wait failed");
+                }
+
+                _wait_policy.parked();
+            }
+
+            wait.acquired();
         }
+
+        // The operation was successful, we now own the semaphore
+        _locked = true;
+        record_locked();
     }
 
     void unlock() override {
-        // Try to unlock the semaphore
+        record_unlocked();
+
+        // Clear the ownership first, the mutex may be acquired by another thread right after releasing it
+        _locked = false;
         if (sem_post(_semaphore) != 0) {
+            _locked = true;
             throw shared_mutex_exception("sem_post() failed");
-        } else {
-            // The operation was successful, we don't own the semaphore anymore
-            _locked = false;
         }
     }
 
-    [[nodiscard]] bool try_lock() override {
-        // Try waiting for the semaphore to lock
-        if (sem_trywait(_semaphore) != 0) {
-            // sem_trywait failed, could not acquire ownership
-            return false;
-        } else {
-            // The operation was successful, we now own the semaphore
+#ifndef __APPLE__
+    // macOS doesn't implement sem_timedwait, the default implementation is used there
+
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        if (deadline == futex::clock::time_point::max()) {
+            lock();
+            return true;
+        }
+
+        const auto try_acquire = [this] {
+            return sem_trywait(_semaphore) == 0;
+        };
+
+        if (try_acquire()) {
+            _locked = true;
+            record_locked();
+            return true;
+        }
+
+        mutex_stats_recorder::wait_scope wait(&_stats);
+        if (_wait_policy.spin(try_acquire, deadline)) {
             _locked = true;
+            wait.acquired();
+            record_locked();
             return true;
         }
+
+        // sem_timedwait takes an absolute CLOCK_REALTIME timeout
+        const auto remaining = std::chrono::ceil<std::chrono::nanoseconds>(deadline - futex::clock::now());
+        const auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()) + remaining;
+
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+
+        while (sem_timedwait(_semaphore, &ts) != 0) {
+            if (errno == ETIMEDOUT) {
+                return false;
+            } else if (errno != EINTR) {
+                throw shared_mutex_exception("The wait failed");
+            }
+        }
+
+        // The operation was successful, we now own the semaphore
+        _locked = true;
+        wait.acquired();
+        record_locked();
+        _wait_policy.parked();
+        return true;
     }
 
+#endif //__APPLE__
+
     /**
      * Delete this shared_mutex.
      * Destroys the semaphore or mutex.
@@ -438,42 +978,1562 @@ public:
         // If the semaphore is null, return
         if (_semaphore == nullptr) return;
 
-        // If locked, unlock the mutex
+        // If locked, unlock the mutex. The semaphore is closed and
+        // deleted once the last instance using it is destroyed.
         if (_locked) {
             sem_post(_semaphore);
         }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
+        // Try waiting for the semaphore to lock
+        if (sem_trywait(_semaphore) != 0) {
+            // sem_trywait failed, could not acquire ownership
+            return false;
+        } else {
+            // The operation was successful, we now own the semaphore
+            _locked = true;
+            record_locked();
+            return true;
+        }
+    }
 
-        // Re-create the semaphore name
-        std::string name = "/";
-        name.append(_mtx_name);
+private:
+    /**
+     * A named semaphore, shared by all instances of a mutex in this program
+     */
+    class semaphore {
+    public:
+        /**
+         * Open or create the semaphore
+         *
+         * @param mutex_name the mutex name
+         * @param openIfExists whether to open the semaphore if it already exists or throw an exception
+         */
+        semaphore(const std::string &mutex_name, bool openIfExists) : _name("/" + mutex_name) {
+            // Try to create the semaphore
+            if (openIfExists) {
+                _semaphore = sem_open(_name.c_str(), O_CREAT, PERM, 1);
+            } else {
+                _semaphore = sem_open(_name.c_str(), O_CREAT | O_EXCL, PERM, 1);
+            }
 
-        // Close the semaphore
-        if (sem_close(_semaphore) == -1) {
-            std::cerr << "Could not close the semaphore" << std::endl;
+            // If the creation failed, thrown an exception
+            if (_semaphore == SEM_FAILED) {
+                throw shared_mutex_exception(
+                        "A mutex with the name '" + mutex_name + "' is already owned by another program");
+            }
         }
 
-        // Delete the semaphore
-        if (sem_unlink(name.c_str()) == -1) {
-            std::cerr << "Could not delete the semaphore" << std::endl;
+        semaphore(const semaphore &) = delete;
+
+        semaphore &operator=(const semaphore &) = delete;
+
+        /**
+         * Get the semaphore pointer
+         *
+         * @return the semaphore
+         */
+        [[nodiscard]] sem_t *get() const noexcept {
+            return _semaphore;
         }
 
-        // Try to delete the mutex name from the owned_mutexes vector
-        try_remove_mutex();
-    }
+        /**
+         * Delete the semaphore name
+         *
+         * @return false if the name could not be deleted
+         */
+        bool unlink() const noexcept {
+            return sem_unlink(_name.c_str()) == 0;
+        }
 
-private:
+        /**
+         * Close the semaphore
+         */
+        ~semaphore() {
+            if (sem_close(_semaphore) == -1) {
+                std::cerr << "Could not close the semaphore" << std::endl;
+            }
+        }
+
+    private:
+        // The semaphore name
+        std::string _name;
+        // The semaphore pointer
+        sem_t *_semaphore;
+    };
+
+    // The semaphore shared by all instances of this mutex
+    std::shared_ptr<semaphore> _handle;
     // The semaphore pointer
     sem_t *_semaphore;
 };
 
 #endif //OS_UNIX
 
-std::unique_ptr<shared_mutex> shared_mutex::createShared_mutex(const std::string &mtx_name, bool openIfExists) {
-#ifdef OS_WINDOWS
-    return std::make_unique<win_shared_mutex>(mtx_name, openIfExists);
-#elif defined(OS_UNIX)
-    return std::make_unique<unix_shared_mutex>(mtx_name, openIfExists);
-#endif //OS_WINDOWS
+#ifdef OS_LINUX
+
+/**
+ * The lock word algorithm of a futex in a shared memory segment.
+ * Uncontended lock and unlock operations are a single atomic
+ * operation, only contended operations call into the kernel.
+ * Supports shared (reader) and exclusive (writer) ownership.
+ *
+ * Backends only implement the lock word, the callers track which locks
+ * they hold and record the statistics. Used by futex_shared_mutex and
+ * as the Backend of basic_shared_mutex.
+ */
+class futex_mutex_backend {
+public:
+    // Whether the backend supports shared ownership
+    static constexpr bool supports_shared = true;
+
+    /**
+     * Open or create the shared memory segment of a mutex
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    futex_mutex_backend(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options)
+            : _writer_preference(options.writer_preference) {
+        // Try to create the shared memory segment
+        try {
+            _memory = shared_memory::open_shared(mutex_name + ".mutex", sizeof(data), openIfExists);
+        } catch (const shared_mutex_exception &) {
+            throw shared_mutex_exception(
+                    "A mutex with the name '" + mutex_name + "' is already owned by another program");
+        }
+
+        // The lock word is zero-initialized, which is the unlocked state
+        _data = _memory->as<data>();
+        _data->header.initialize(futex_mutex_kind, mutex_name, [&] {
+            _data->writer_preference = _writer_preference ? 1 : 0;
+        });
+
+        // All processes must run the same admission rules on the lock word
+        if (_data->writer_preference != (_writer_preference ? 1u : 0u)) {
+            throw shared_mutex_exception(
+                    "A mutex with the name '" + mutex_name + "' already exists with a different writer preference");
+        }
+    }
+
+    futex_mutex_backend(const futex_mutex_backend &) = delete;
+
+    futex_mutex_backend &operator=(const futex_mutex_backend &) = delete;
+
+    /**
+     * Try to lock the mutex exclusively without waiting
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock() noexcept {
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        while ((state & (writer | reader_mask)) == unlocked) {
+            if (_data->word.compare_exchange_weak(state, state | writer, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Wait until the mutex can be locked exclusively, after try_lock() failed
+     *
+     * @param policy the wait policy deciding whether to spin first
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    template<class WaitPolicy>
+    bool lock_slow(WaitPolicy &policy, futex::clock::time_point deadline) {
+        if (policy.spin([this] { return try_lock(); }, deadline)) return true;
+
+        bool waited = false;
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if ((state & (writer | reader_mask)) == unlocked) {
+                // A writer which was woken up doesn't know whether there are
+                // other writers waiting, keep the waiters bit set in that case
+                const uint32_t desired = state | writer | (waited ? writers_waiting : 0);
+                if (_data->word.compare_exchange_weak(state, desired, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    policy.parked();
+                    return true;
+                }
+            } else if ((state & writers_waiting) == 0 &&
+                       !_data->word.compare_exchange_weak(state, state | writers_waiting,
+                                                          std::memory_order_relaxed)) {
+                // The state changed, check it again
+                continue;
+            } else if (!futex::wait_until(_data->word, state | writers_waiting, deadline, writer_bitset)) {
+                // This waiter may have consumed the wake up of another writer,
+                // make sure the remaining writers will be woken up
+                if (waited) {
+                    wake_waiters(_data->word.fetch_or(writers_waiting, std::memory_order_relaxed) | writers_waiting);
+                }
+
+                return false;
+            } else {
+                state = _data->word.load(std::memory_order_relaxed);
+                waited = true;
+            }
+        }
+    }
+
+    /**
+     * Unlock the mutex from exclusive ownership
+     */
+    void unlock() noexcept {
+        // Fast path: there are no waiters
+        uint32_t state = writer;
+        if (_data->word.compare_exchange_strong(state, unlocked, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+            return;
+        }
+
+        for (;;) {
+            // Prefer waking up a writer if writers are preferred or there are no readers waiting
+            const bool wake_writer = (state & writers_waiting) != 0 &&
+                                     (_writer_preference || (state & readers_waiting) == 0);
+            const uint32_t desired = wake_writer ? (state & readers_waiting) : unlocked;
+
+            if (_data->word.compare_exchange_weak(state, desired, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+                if (wake_writer) {
+                    wake_writer_or_readers(state);
+                } else {
+                    if (state & readers_waiting) futex::wake(_data->word, INT_MAX, reader_bitset);
+                    if (state & writers_waiting) futex::wake(_data->word, 1, writer_bitset);
+                }
+
+                return;
+            }
+        }
+    }
+
+    /**
+     * Try to lock the mutex in shared mode without waiting
+     *
+     * @return true, if the shared ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock_shared() noexcept {
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        while (can_lock_shared(state)) {
+            if (_data->word.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Wait until the mutex can be locked in shared mode, after try_lock_shared() failed
+     *
+     * @param policy the wait policy deciding whether to spin first
+     * @param deadline the time point to stop waiting at
+     * @return true, if the shared ownership could be acquired
+     */
+    template<class WaitPolicy>
+    bool lock_shared_slow(WaitPolicy &policy, futex::clock::time_point deadline) {
+        if (policy.spin([this] { return try_lock_shared(); }, deadline)) return true;
+
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (can_lock_shared(state)) {
+                if (_data->word.compare_exchange_weak(state, state + 1, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    policy.parked();
+                    return true;
+                }
+            } else if ((state & readers_waiting) == 0 &&
+                       !_data->word.compare_exchange_weak(state, state | readers_waiting,
+                                                          std::memory_order_relaxed)) {
+                // The state changed, check it again
+                continue;
+            } else if (!futex::wait_until(_data->word, state | readers_waiting, deadline, reader_bitset)) {
+                // All readers are woken up at once, no need to pass on the wake up
+                return false;
+            } else {
+                state = _data->word.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Unlock the mutex from shared mode
+     */
+    void unlock_shared() noexcept {
+        // If this was the last reader, wake up the waiters
+        wake_waiters(_data->word.fetch_sub(1, std::memory_order_release) - 1);
+    }
+
+    /**
+     * Prepare waiting for the mutex without blocking a thread
+     *
+     * @param shared whether to wait for shared ownership
+     * @param target set to the futex word to wait on
+     * @return whether to wait on the target or retry locking the mutex immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(bool shared, futex_target &target) noexcept {
+        const uint32_t waiting = shared ? readers_waiting : writers_waiting;
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (shared ? can_lock_shared(state) : (state & (writer | reader_mask)) == unlocked) {
+                return wait_preparation::retry;
+            } else if ((state & waiting) != 0 ||
+                       _data->word.compare_exchange_weak(state, state | waiting, std::memory_order_relaxed)) {
+                target.word = &_data->word;
+                target.expected = state | waiting;
+                return wait_preparation::wait;
+            }
+        }
+    }
+
+    /**
+     * Try to lock the mutex after waiting on the target set by prepare_wait()
+     *
+     * @param shared whether to lock the mutex in shared mode
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock_after_wait(bool shared) noexcept {
+        // Async waiters are woken up by any wake, they may have consumed
+        // the wake up of a writer. Keep the writers waiting bit set.
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        while (shared ? can_lock_shared(state) : (state & (writer | reader_mask)) == unlocked) {
+            const uint32_t desired = (shared ? state + 1 : state | writer) | writers_waiting;
+            if (_data->word.compare_exchange_weak(state, desired, std::memory_order_acquire,
+                                                  std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Stop waiting after prepare_wait() was called, passing on a consumed wake up
+     */
+    void abandon_wait() noexcept {
+        wake_waiters(_data->word.fetch_or(writers_waiting, std::memory_order_relaxed) | writers_waiting);
+    }
+
+private:
+    // The mutex is not locked
+    static constexpr uint32_t unlocked = 0;
+    // The bit set if the mutex is owned exclusively
+    static constexpr uint32_t writer = 1u << 31u;
+    // The bit set if there may be writers waiting
+    static constexpr uint32_t writers_waiting = 1u << 30u;
+    // The bit set if there may be readers waiting
+    static constexpr uint32_t readers_waiting = 1u << 29u;
+    // The bits storing the number of readers
+    static constexpr uint32_t reader_mask = readers_waiting - 1;
+    // The futex bitset readers wait with
+    static constexpr uint32_t reader_bitset = 1;
+    // The futex bitset writers wait with
+    static constexpr uint32_t writer_bitset = 2;
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The lock word. Stores the writer and waiter bits and the number of readers.
+        std::atomic<uint32_t> word;
+        // Whether writers are preferred over readers, set by the process creating the mutex
+        uint32_t writer_preference;
+    };
+
+    /**
+     * Check whether the mutex can be locked in shared mode
+     *
+     * @param state the state of the lock word
+     * @return true if a reader may acquire the mutex
+     */
+    [[nodiscard]] bool can_lock_shared(uint32_t state) const noexcept {
+        return (state & writer) == 0 && (state & reader_mask) != reader_mask &&
+               (!_writer_preference || (state & writers_waiting) == 0);
+    }
+
+    /**
+     * Wake up the waiters if the mutex is not locked
+     *
+     * @param state the current state of the lock word
+     */
+    void wake_waiters(uint32_t state) noexcept {
+        while ((state & (writer | reader_mask)) == unlocked && (state & (writers_waiting | readers_waiting))) {
+            const bool wake_writer = (state & writers_waiting) != 0;
+            const uint32_t desired = wake_writer ? (state & ~writers_waiting) : (state & ~readers_waiting);
+
+            if (_data->word.compare_exchange_weak(state, desired, std::memory_order_relaxed)) {
+                if (wake_writer) {
+                    wake_writer_or_readers(state);
+                } else {
+                    futex::wake(_data->word, INT_MAX, reader_bitset);
+                }
+
+                break;
+            }
+        }
+    }
+
+    /**
+     * Wake up one waiting writer. If there is no writer
+     * waiting, wake up all waiting readers instead.
+     *
+     * @param state the state of the lock word before the writers waiting bit was cleared
+     */
+    void wake_writer_or_readers(uint32_t state) noexcept {
+        if (futex::wake(_data->word, 1, writer_bitset) == 0 && (state & readers_waiting)) {
+            _data->word.fetch_and(~readers_waiting, std::memory_order_relaxed);
+            futex::wake(_data->word, INT_MAX, reader_bitset);
+        }
+    }
+
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // Whether writers are preferred over readers, the same in all processes using the mutex
+    const bool _writer_preference;
+};
+
+/**
+ * A shared mutex for linux, using a futex in a shared memory segment.
+ * Uncontended lock and unlock operations are a single atomic
+ * operation, only contended operations call into the kernel.
+ * Supports shared (reader) and exclusive (writer) ownership.
+ */
+class futex_shared_mutex : public shared_mutex {
+public:
+    /**
+     * Create a shared_mutex instance.
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    futex_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting), _backend(_mtx_name, openIfExists, options),
+              _shared_locks(0) {
+        _stats.open(_mtx_name, options.stats, options.trace);
+    }
+
+    void lock() override {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        if (!_backend.try_lock()) {
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!_backend.lock_slow(_wait_policy, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    void unlock() override {
+        record_unlocked();
+        // Clear the ownership first, the async waiter thread may acquire the mutex right after releasing it
+        _locked = false;
+        _backend.unlock();
+    }
+
+    void lock_shared() override {
+        (void) timed_lock_shared(futex::clock::time_point::max());
+    }
+
+    [[nodiscard]] bool timed_lock_shared(futex::clock::time_point deadline) override {
+        if (!_backend.try_lock_shared()) {
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!_backend.lock_shared_slow(_wait_policy, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        _shared_locks.fetch_add(1, std::memory_order_relaxed);
+        record_locked_shared();
+        return true;
+    }
+
+    void unlock_shared() override {
+        uint32_t held = _shared_locks.load(std::memory_order_relaxed);
+        while (held > 0 && !_shared_locks.compare_exchange_weak(held, held - 1, std::memory_order_relaxed)) {}
+
+        _backend.unlock_shared();
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(bool shared, futex_target &target) override {
+        return _backend.prepare_wait(shared, target);
+    }
+
+    [[nodiscard]] bool try_lock_after_wait(bool shared) override {
+        if (!_backend.try_lock_after_wait(shared)) return false;
+
+        if (shared) {
+            _shared_locks.fetch_add(1, std::memory_order_relaxed);
+            record_locked_shared();
+        } else {
+            _locked = true;
+            record_locked();
+        }
+
+        return true;
+    }
+
+    void abandon_wait(bool) override {
+        _backend.abandon_wait();
+    }
+
+    /**
+     * Delete this shared_mutex. The shared memory segment is unmapped
+     * and deleted once the last instance using it is destroyed.
+     */
+    ~futex_shared_mutex() override {
+        // If locked, unlock the mutex
+        if (_locked) {
+            unlock();
+        }
+
+        while (_shared_locks.load(std::memory_order_relaxed) > 0) {
+            unlock_shared();
+        }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
+        if (!_backend.try_lock()) return false;
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    [[nodiscard]] bool acquire_shared() override {
+        if (!_backend.try_lock_shared()) return false;
+
+        _shared_locks.fetch_add(1, std::memory_order_relaxed);
+        record_locked_shared();
+        return true;
+    }
+
+private:
+    // The lock word
+    futex_mutex_backend _backend;
+    // The number of shared locks held by this instance. Changed by the
+    // JavaScript thread and the async waiter thread at the same time.
+    std::atomic<uint32_t> _shared_locks;
+};
+
+#endif //OS_LINUX
+
+#ifdef OS_UNIX
+
+/**
+ * A shared mutex for unix which recovers from its owner dying.
+ * The lock word in a shared memory segment stores the process id of the
+ * owner, waiters periodically check whether the owner is still alive and
+ * take over the ownership of the mutex if it isn't. The mutex is owned by
+ * the process, so it may be unlocked by a different thread than the one
+ * which locked it.
+ */
+class robust_shared_mutex : public shared_mutex {
+public:
+    /**
+     * Create a shared_mutex instance.
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    robust_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting), _pid(static_cast<uint32_t>(getpid())),
+              _alive_owner(0) {
+        // Try to create the shared memory segment
+        try {
+            _memory = shared_memory::open_shared(_mtx_name + ".mutex", sizeof(data), openIfExists);
+        } catch (const shared_mutex_exception &) {
+            throw shared_mutex_exception(
+                    "A mutex with the name '" + _mtx_name + "' is already owned by another program");
+        }
+
+        // The lock word is zero-initialized, which is the unlocked state
+        _data = _memory->as<data>();
+        _data->header.initialize(robust_mutex_kind, _mtx_name, [] {});
+        _stats.open(_mtx_name, options.stats, options.trace);
+    }
+
+    void lock() override {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        // Fast path: the mutex is not locked
+        uint32_t state = unlocked;
+        if (_data->word.compare_exchange_strong(state, _pid, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            _owner_died = false;
+        } else {
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!lock_slow(state, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    void unlock() override {
+        record_unlocked();
+        // Clear the ownership first, the async waiter thread may acquire the mutex right after releasing it
+        _locked = false;
+
+        // Only wake up a waiter if there are any
+        if (_data->word.exchange(unlocked, std::memory_order_release) & waiters) {
+            futex::wake(_data->word, 1);
+        }
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(bool, futex_target &target) override {
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state == unlocked || !process_alive(state & pid_mask)) {
+                return wait_preparation::retry;
+            } else if ((state & waiters) != 0 ||
+                       _data->word.compare_exchange_weak(state, state | waiters, std::memory_order_relaxed)) {
+                // Check whether the owner is still alive periodically
+                target.word = &_data->word;
+                target.expected = state | waiters;
+                target.recheck = futex::clock::now() + liveness_interval;
+                return wait_preparation::wait;
+            }
+        }
+    }
+
+    [[nodiscard]] bool try_lock_after_wait(bool) override {
+        // We don't know if there are other waiters, keep the waiters bit set
+        uint32_t state = _data->word.load(std::memory_order_relaxed);
+        const bool owner_died = state != unlocked && !process_alive(state & pid_mask);
+        if ((state == unlocked || owner_died) &&
+            _data->word.compare_exchange_strong(state, _pid | waiters, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            _owner_died = owner_died;
+            _locked = true;
+            record_locked();
+            return true;
+        }
+
+        return false;
+    }
+
+    void abandon_wait(bool) override {
+        futex::wake(_data->word, 1);
+    }
+
+    /**
+     * Delete this shared_mutex. The shared memory segment is unmapped
+     * and deleted once the last instance using it is destroyed.
+     */
+    ~robust_shared_mutex() override {
+        // If the segment is null, return
+        if (!_memory) return;
+
+        // If locked, unlock the mutex
+        if (_locked) {
+            unlock();
+        }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
+        uint32_t state = unlocked;
+        if (_data->word.compare_exchange_strong(state, _pid, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+            _owner_died = false;
+        } else if (state == unlocked || owner_alive(state & pid_mask) ||
+                   !_data->word.compare_exchange_strong(state, _pid | (state & waiters),
+                                                        std::memory_order_acquire, std::memory_order_relaxed)) {
+            return false;
+        } else {
+            // The owner died, we took over the ownership
+            _owner_died = true;
+        }
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+private:
+    // The mutex is not locked
+    static constexpr uint32_t unlocked = 0;
+    // The bit set if there may be waiters
+    static constexpr uint32_t waiters = 0x80000000u;
+    // The bits storing the owner's process id
+    static constexpr uint32_t pid_mask = ~waiters;
+    // The interval to check whether the owner is still alive in
+    static constexpr std::chrono::milliseconds liveness_interval{10};
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The lock word. Stores the owner's process id and the waiters bit.
+        std::atomic<uint32_t> word;
+    };
+
+    /**
+     * Check whether a process is still alive
+     *
+     * @param pid the id of the process
+     * @return false if the process doesn't exist or is a zombie
+     */
+    static bool process_alive(uint32_t pid) {
+        if (kill(static_cast<pid_t>(pid), 0) == -1 && errno == ESRCH) {
+            return false;
+        }
+
+#ifdef OS_LINUX
+        // Processes which were not reaped by their parent yet still exist as zombies
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        std::string line;
+        if (std::getline(stat, line)) {
+            // The state follows the executable name, which is enclosed in parentheses
+            const size_t pos = line.rfind(')');
+            if (pos != std::string::npos && pos + 2 < line.size()) {
+                return line[pos + 2] != 'Z' && line[pos + 2] != 'X';
+            }
+        }
+#endif //OS_LINUX
+
+        return true;
+    }
+
+    /**
+     * Check whether the owner of the mutex is still alive. Remembers the last owner
+     * found alive for the liveness interval, so failing try_lock() calls don't
+     * signal the owner and read its /proc entry every time.
+     *
+     * @param pid the id of the owner
+     * @return false if the owner doesn't exist or is a zombie
+     */
+    bool owner_alive(uint32_t pid) {
+        const auto now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                futex::clock::now().time_since_epoch()).count());
+        const uint64_t cached = _alive_owner.load(std::memory_order_relaxed);
+        if (static_cast<uint32_t>(cached >> 32u) == pid &&
+            now - static_cast<uint32_t>(cached) < static_cast<uint32_t>(liveness_interval.count())) {
+            return true;
+        }
+
+        if (!process_alive(pid)) return false;
+        _alive_owner.store((static_cast<uint64_t>(pid) << 32u) | now, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Wait until the mutex is released or its owner died
+     *
+     * @param state the last observed state of the lock word
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    bool lock_slow(uint32_t state, futex::clock::time_point deadline) {
+        // Only spin on the lock word, checking whether the owner is alive is too expensive
+        const bool spun = _wait_policy.spin([this] {
+            uint32_t current = unlocked;
+            return _data->word.load(std::memory_order_relaxed) == unlocked &&
+                   _data->word.compare_exchange_strong(current, _pid, std::memory_order_acquire,
+                                                       std::memory_order_relaxed);
+        }, deadline);
+
+        if (spun) {
+            _owner_died = false;
+            return true;
+        }
+
+        state = _data->word.load(std::memory_order_relaxed);
+        for (;;) {
+            if (state == unlocked) {
+                // We don't know if there are other waiters, keep the waiters bit set
+                if (_data->word.compare_exchange_weak(state, _pid | waiters, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    _owner_died = false;
+                    _wait_policy.parked();
+                    return true;
+                }
+            } else if (!process_alive(state & pid_mask)) {
+                // The owner died, take over the ownership
+                if (_data->word.compare_exchange_weak(state, _pid | waiters, std::memory_order_acquire,
+                                                      std::memory_order_relaxed)) {
+                    _owner_died = true;
+                    _wait_policy.parked();
+                    return true;
+                }
+            } else if ((state & waiters) == 0 &&
+                       !_data->word.compare_exchange_weak(state, state | waiters, std::memory_order_relaxed)) {
+                // The state changed, check it again
+                continue;
+            } else if (futex::clock::now() >= deadline) {
+                // This waiter may have consumed the wake up of another waiter, pass it on
+                futex::wake(_data->word, 1);
+                return false;
+            } else {
+                // Wait for the mutex to be released, wake up periodically to check whether the owner is alive
+                const auto liveness_deadline = futex::clock::now() + liveness_interval;
+                futex::wait_until(_data->word, state | waiters, std::min<futex::clock::time_point>(deadline, liveness_deadline));
+                state = _data->word.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // The id of this process
+    const uint32_t _pid;
+    // The last owner found alive in the upper and the time it was checked at in the lower 32 bits
+    std::atomic<uint64_t> _alive_owner;
+};
+
+#endif //OS_UNIX
+
+#ifdef OS_LINUX
+
+/**
+ * A shared mutex for linux using a priority inheritance futex in a shared
+ * memory segment. Contended lock operations block in the kernel, which
+ * raises the priority of the owner to the one of the highest priority
+ * waiter and hands the mutex to that waiter once it is released. This
+ * prevents a preempted low priority owner from stalling high priority waiters.
+ *
+ * The kernel requires the lock word to store the thread id of the owner, so
+ * the mutex is owned by the thread which locked it and must be unlocked by
+ * that thread. If the owner dies, the next thread locking the mutex takes
+ * over the ownership and owner_died() returns true.
+ */
+class pi_shared_mutex : public shared_mutex {
+public:
+    /**
+     * Create a shared_mutex instance.
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    pi_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting), _owner(0) {
+        // Try to create the shared memory segment
+        try {
+            _memory = shared_memory::open_shared(_mtx_name + ".mutex", sizeof(data), openIfExists);
+        } catch (const shared_mutex_exception &) {
+            throw shared_mutex_exception(
+                    "A mutex with the name '" + _mtx_name + "' is already owned by another program");
+        }
+
+        // The lock word is zero-initialized, which is the unlocked state
+        _data = _memory->as<data>();
+        _data->header.initialize(pi_mutex_kind, _mtx_name, [] {});
+        _stats.open(_mtx_name, options.stats, options.trace);
+    }
+
+    void lock() override {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        const uint32_t tid = current_tid();
+
+        // Fast path: the mutex is not locked
+        uint32_t state = unlocked;
+        if (_data->word.compare_exchange_strong(state, tid, std::memory_order_acquire, std::memory_order_relaxed)) {
+            _owner_died = false;
+        } else {
+            // Spinning in user space would hide the waiter from the kernel, which spins itself while the owner runs
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!lock_slow(tid, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        _owner = tid;
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    void unlock() override {
+        if (_owner != current_tid()) {
+            throw shared_mutex_exception(
+                    "The mutex '" + _mtx_name + "' must be unlocked by the thread which locked it");
+        }
+
+        record_unlocked();
+        _owner = 0;
+        _locked = false;
+
+        // Fast path: there are no waiters blocked in the kernel
+        uint32_t state = current_tid();
+        if (!_data->word.compare_exchange_strong(state, unlocked, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed)) {
+            // The kernel hands the mutex to the waiter with the highest priority
+            while (syscall(SYS_futex, reinterpret_cast<uint32_t *>(&_data->word), FUTEX_UNLOCK_PI, 0, nullptr,
+                           nullptr, 0) == -1) {
+                if (errno != EINTR && errno != EAGAIN) {
+                    throw shared_mutex_exception("The mutex '" + _mtx_name + "' could not be unlocked");
+                }
+            }
+        }
+
+        // Async waiters check the lock word before sleeping on the release sequence
+        if (_data->async_waiters.exchange(0, std::memory_order_seq_cst) != 0) {
+            _data->sequence.fetch_add(1, std::memory_order_seq_cst);
+            futex::wake(_data->sequence);
+        }
+    }
+
+    [[nodiscard]] bool thread_owned() const noexcept override {
+        return true;
+    }
+
+    [[nodiscard]] bool appears_unlocked() const noexcept override {
+        return _data->word.load(std::memory_order_relaxed) == unlocked;
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(bool, futex_target &target) override {
+        // Waiting on the lock word with anything but FUTEX_LOCK_PI breaks the kernel's
+        // bookkeeping, async waiters sleep on the release sequence instead
+        _data->async_waiters.store(1, std::memory_order_seq_cst);
+        target.word = &_data->sequence;
+        target.expected = _data->sequence.load(std::memory_order_seq_cst);
+
+        return _data->word.load(std::memory_order_seq_cst) == unlocked ? wait_preparation::retry
+                                                                      : wait_preparation::wait;
+    }
+
+    /**
+     * Delete this shared_mutex. The shared memory segment is unmapped
+     * and deleted once the last instance using it is destroyed.
+     */
+    ~pi_shared_mutex() override {
+        // If the segment is null, return
+        if (!_memory) return;
+
+        // If locked by this thread, unlock the mutex
+        if (_locked && _owner == current_tid()) {
+            try {
+                unlock();
+            } catch (...) {
+                // There is nothing else to do
+            }
+        }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
+        const uint32_t tid = current_tid();
+        uint32_t state = unlocked;
+        if (!_data->word.compare_exchange_strong(state, tid, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+            return false;
+        }
+
+        _owner_died = false;
+        _owner = tid;
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+private:
+    // The mutex is not locked
+    static constexpr uint32_t unlocked = 0;
+    // FUTEX_LOCK_PI2, which takes a CLOCK_MONOTONIC timeout. Available since linux 5.14.
+    static constexpr int futex_lock_pi2 = 13;
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The lock word. Stores the owner's thread id and the bits set by the kernel.
+        std::atomic<uint32_t> word;
+        // Incremented when the mutex is released while async waiters wait for it
+        std::atomic<uint32_t> sequence;
+        // Set if async waiters may be sleeping on the sequence
+        std::atomic<uint32_t> async_waiters;
+    };
+
+    /**
+     * Get the id of the calling thread
+     *
+     * @return the thread id
+     */
+    static uint32_t current_tid() noexcept {
+        static const bool registered = [] {
+            // The thread calling fork() continues with a new thread id in the child
+            pthread_atfork(nullptr, nullptr, [] {
+                cached_tid() = 0;
+            });
+
+            return true;
+        }();
+        (void) registered;
+
+        uint32_t &tid = cached_tid();
+        if (tid == 0) tid = static_cast<uint32_t>(syscall(SYS_gettid));
+        return tid;
+    }
+
+    /**
+     * Get the cached id of the calling thread
+     *
+     * @return the cached thread id, zero if it wasn't retrieved yet
+     */
+    static uint32_t &cached_tid() noexcept {
+        thread_local uint32_t tid = 0;
+        return tid;
+    }
+
+    /**
+     * Convert a deadline to a timespec
+     *
+     * @param deadline the deadline
+     * @param clock_offset the offset of the clock the kernel expects from the steady clock
+     * @return the timespec
+     */
+    static timespec to_timespec(futex::clock::time_point deadline, std::chrono::nanoseconds clock_offset) {
+        const auto since_epoch = std::max(std::chrono::nanoseconds::zero(), std::chrono::duration_cast<
+                std::chrono::nanoseconds>(deadline.time_since_epoch()) + clock_offset);
+
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+        return ts;
+    }
+
+    /**
+     * Block in the kernel until the mutex could be locked or the deadline is reached
+     *
+     * @param deadline the time point to stop waiting at
+     * @return zero on success, -1 with errno set on failure
+     */
+    long lock_pi(futex::clock::time_point deadline) {
+        auto *word = reinterpret_cast<uint32_t *>(&_data->word);
+        if (deadline == futex::clock::time_point::max()) {
+            return syscall(SYS_futex, word, FUTEX_LOCK_PI, 0, nullptr, nullptr, 0);
+        }
+
+        static std::atomic<bool> lock_pi2_supported(true);
+        if (lock_pi2_supported.load(std::memory_order_relaxed)) {
+            const timespec ts = to_timespec(deadline, std::chrono::nanoseconds::zero());
+            const long res = syscall(SYS_futex, word, futex_lock_pi2, 0, &ts, nullptr, 0);
+            if (res == 0 || errno != ENOSYS) return res;
+
+            lock_pi2_supported.store(false, std::memory_order_relaxed);
+        }
+
+        // FUTEX_LOCK_PI takes an absolute CLOCK_REALTIME timeout
+        const auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()) -
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    futex::clock::now().time_since_epoch());
+        const timespec ts = to_timespec(deadline, offset);
+        return syscall(SYS_futex, word, FUTEX_LOCK_PI, 0, &ts, nullptr, 0);
+    }
+
+    /**
+     * Wait in the kernel until the mutex is released or its owner died
+     *
+     * @param tid the id of the calling thread
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    bool lock_slow(uint32_t tid, futex::clock::time_point deadline) {
+        bool owner_died = false;
+        while (lock_pi(deadline) != 0) {
+            if (errno == ETIMEDOUT) {
+                return false;
+            } else if (errno == EDEADLK) {
+                throw shared_mutex_exception("The mutex '" + _mtx_name + "' is already locked by this thread");
+            } else if (errno == ESRCH) {
+                // The owner died without the kernel noticing, because nobody was waiting. Take over the ownership.
+                uint32_t state = _data->word.load(std::memory_order_relaxed);
+                if (state != unlocked && _data->word.compare_exchange_strong(
+                        state, tid | (state & FUTEX_WAITERS), std::memory_order_acquire, std::memory_order_relaxed)) {
+                    owner_died = true;
+                    break;
+                }
+            } else if (errno != EINTR && errno != EAGAIN) {
+                throw shared_mutex_exception("The mutex '" + _mtx_name + "' could not be locked");
+            }
+        }
+
+        // The kernel marks the word if it handed over the mutex of a thread which died
+        if (_data->word.load(std::memory_order_relaxed) & FUTEX_OWNER_DIED) {
+            _data->word.fetch_and(~static_cast<uint32_t>(FUTEX_OWNER_DIED), std::memory_order_relaxed);
+            owner_died = true;
+        }
+
+        _owner_died = owner_died;
+        _wait_policy.parked();
+        return true;
+    }
+
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // The id of the thread which locked the mutex through this instance
+    uint32_t _owner;
+};
+
+#endif //OS_LINUX
+
+/**
+ * The ticket lock algorithm of a fair mutex. Waiters draw tickets in a shared
+ * memory segment and are served in the order they arrived. Every waiter sleeps
+ * on its own slot, releasing the mutex hands the ownership directly to the next
+ * waiter and only wakes up that waiter. Waiters which time out mark their
+ * ticket as abandoned, the ticket is skipped once it is served.
+ *
+ * Used by fair_shared_mutex and as the Backend of basic_shared_mutex.
+ */
+class fair_mutex_backend {
+public:
+    // Whether the backend supports shared ownership
+    static constexpr bool supports_shared = false;
+
+    /**
+     * Open or create the shared memory segment of a mutex
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    fair_mutex_backend(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options)
+            : _has_ticket(false), _ticket(0) {
+        (void) options;
+
+        // Try to create the shared memory segment
+        try {
+            _memory = shared_memory::open_shared(mutex_name + ".mutex", sizeof(data), openIfExists);
+        } catch (const shared_mutex_exception &) {
+            throw shared_mutex_exception(
+                    "A mutex with the name '" + mutex_name + "' is already owned by another program");
+        }
+
+        // All counters are zero-initialized, which is the unlocked state
+        _data = _memory->as<data>();
+        _data->header.initialize(fair_mutex_kind, mutex_name, [] {});
+    }
+
+    fair_mutex_backend(const fair_mutex_backend &) = delete;
+
+    fair_mutex_backend &operator=(const fair_mutex_backend &) = delete;
+
+    /**
+     * Try to lock the mutex without waiting
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock() noexcept {
+        // The mutex is free if nobody holds a ticket which wasn't served yet
+        const uint32_t serving = _data->now_serving.load(std::memory_order_acquire);
+        uint32_t ticket = serving;
+        return _data->next_ticket.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire,
+                                                          std::memory_order_relaxed);
+    }
+
+    /**
+     * Draw a ticket and wait until it is served, after try_lock() failed
+     *
+     * @param policy the wait policy deciding whether to spin first
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ownership could be acquired
+     */
+    template<class WaitPolicy>
+    bool lock_slow(WaitPolicy &policy, futex::clock::time_point deadline) {
+        uint32_t ticket;
+        return take_ticket(ticket, deadline) && wait_for_turn(ticket, policy, deadline);
+    }
+
+    /**
+     * Unlock the mutex, handing it over to the next waiter
+     */
+    void unlock() noexcept {
+        hand_over(_data->now_serving.load(std::memory_order_relaxed) + 1);
+    }
+
+    /**
+     * Prepare waiting for the mutex without blocking a thread.
+     * Async waiters of this instance share one ticket.
+     *
+     * @param target set to the futex word to wait on
+     * @return whether to wait on the target, retry locking the mutex immediately or poll it
+     */
+    [[nodiscard]] wait_preparation prepare_wait(futex_target &target) noexcept {
+        if (!_has_ticket) {
+            if (!take_ticket(_ticket, futex::clock::time_point::min())) {
+                // The queue is full
+                return wait_preparation::unsupported;
+            }
+
+            _has_ticket = true;
+        }
+
+        std::atomic<uint32_t> &slot = _data->slots[_ticket % slot_count];
+        target.word = &slot;
+        target.expected = slot.load(std::memory_order_acquire);
+
+        return is_served(_ticket) ? wait_preparation::retry : wait_preparation::wait;
+    }
+
+    /**
+     * Try to lock the mutex after waiting on the target set by prepare_wait()
+     *
+     * @return true, if the ownership could be acquired
+     */
+    [[nodiscard]] bool try_lock_after_wait() noexcept {
+        if (_has_ticket && is_served(_ticket)) {
+            _has_ticket = false;
+            return true;
+        }
+
+        return try_lock();
+    }
+
+    /**
+     * Stop waiting after prepare_wait() was called, giving up the ticket of the async waiters
+     */
+    void abandon_wait() noexcept {
+        if (_has_ticket) {
+            _has_ticket = false;
+            release_ticket(_ticket);
+        }
+    }
+
+    /**
+     * Give up the ticket of the async waiters, if they still hold it
+     */
+    ~fair_mutex_backend() {
+        abandon_wait();
+    }
+
+private:
+    // The number of waiter slots, which is the max number of tickets handed out at once
+    static constexpr uint32_t slot_count = 256;
+    // The interval to check whether the queue has room again in
+    static constexpr std::chrono::milliseconds queue_full_interval{1};
+
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The next ticket to hand out
+        std::atomic<uint32_t> next_ticket;
+        // The ticket owning the mutex, or the next ticket to hand out if the mutex is not locked
+        std::atomic<uint32_t> now_serving;
+        // The number of processes waiting for the queue to have room again
+        std::atomic<uint32_t> queue_full_waiters;
+        // The futex words waiters sleep on, indexed by ticket
+        std::atomic<uint32_t> slots[slot_count];
+        // The abandoned marks of tickets which gave up waiting, indexed by ticket
+        std::atomic<uint32_t> abandoned[slot_count];
+    };
+
+    /**
+     * Get the value marking a ticket as abandoned
+     *
+     * @param ticket the ticket
+     * @return the non-zero mark
+     */
+    static uint32_t abandoned_mark(uint32_t ticket) noexcept {
+        return (ticket << 1u) | 1u;
+    }
+
+    /**
+     * Check whether a ticket owns the mutex
+     *
+     * @param ticket the ticket to check
+     * @return true if the ticket is served
+     */
+    [[nodiscard]] bool is_served(uint32_t ticket) const noexcept {
+        return _data->now_serving.load(std::memory_order_acquire) == ticket;
+    }
+
+    /**
+     * Draw a ticket. Waits while all slots are taken.
+     *
+     * @param ticket set to the drawn ticket
+     * @param deadline the time point to stop waiting at
+     * @return false if no ticket could be drawn in time
+     */
+    bool take_ticket(uint32_t &ticket, futex::clock::time_point deadline) noexcept {
+        uint32_t next = _data->next_ticket.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint32_t serving = _data->now_serving.load(std::memory_order_acquire);
+            if (next - serving >= slot_count) {
+                // The queue is full, wait until a ticket was served
+                const auto now = futex::clock::now();
+                if (now >= deadline) return false;
+
+                _data->queue_full_waiters.fetch_add(1, std::memory_order_seq_cst);
+                futex::wait_until(_data->now_serving, serving,
+                                  std::min<futex::clock::time_point>(deadline, now + queue_full_interval));
+                _data->queue_full_waiters.fetch_sub(1, std::memory_order_relaxed);
+
+                next = _data->next_ticket.load(std::memory_order_relaxed);
+            } else if (_data->next_ticket.compare_exchange_weak(next, next + 1, std::memory_order_acquire,
+                                                                std::memory_order_relaxed)) {
+                ticket = next;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * Wait until a ticket is served
+     *
+     * @param ticket the ticket to wait for
+     * @param policy the wait policy deciding whether to spin first
+     * @param deadline the time point to stop waiting at
+     * @return true, if the ticket owns the mutex
+     */
+    template<class WaitPolicy>
+    bool wait_for_turn(uint32_t ticket, WaitPolicy &policy, futex::clock::time_point deadline) {
+        const auto served = [this, ticket] {
+            return is_served(ticket);
+        };
+
+        if (served() || policy.spin(served, deadline)) return true;
+
+        std::atomic<uint32_t> &slot = _data->slots[ticket % slot_count];
+        for (;;) {
+            // Read the slot before checking the ticket, hand_over() changes the slot after serving the ticket
+            const uint32_t sequence = slot.load(std::memory_order_acquire);
+            if (served()) {
+                policy.parked();
+                return true;
+            } else if (!futex::wait_until(slot, sequence, deadline)) {
+                return abandon(ticket);
+            }
+        }
+    }
+
+    /**
+     * Mark a ticket as abandoned
+     *
+     * @param ticket the ticket to abandon
+     * @return true, if the ticket was served in the meantime and now owns the mutex
+     */
+    bool abandon(uint32_t ticket) noexcept {
+        std::atomic<uint32_t> &mark = _data->abandoned[ticket % slot_count];
+        mark.store(abandoned_mark(ticket), std::memory_order_seq_cst);
+
+        // Either hand_over() sees the mark or we see the ticket being served.
+        // If both happened, whoever removes the mark decides who owns the ticket.
+        uint32_t expected = abandoned_mark(ticket);
+        return _data->now_serving.load(std::memory_order_seq_cst) == ticket &&
+               mark.compare_exchange_strong(expected, 0, std::memory_order_seq_cst);
+    }
+
+    /**
+     * Give up a ticket which will never wait for its turn.
+     * Passes the mutex on if the ticket is already served.
+     *
+     * @param ticket the ticket to give up
+     */
+    void release_ticket(uint32_t ticket) noexcept {
+        if (abandon(ticket)) {
+            hand_over(ticket + 1);
+        }
+    }
+
+    /**
+     * Hand the mutex over to a ticket.
+     * Skips abandoned tickets and wakes up the waiter of the served ticket.
+     *
+     * @param ticket the ticket to serve
+     */
+    void hand_over(uint32_t ticket) noexcept {
+        for (;;) {
+            _data->now_serving.store(ticket, std::memory_order_seq_cst);
+            if (_data->queue_full_waiters.load(std::memory_order_seq_cst) > 0) {
+                futex::wake(_data->now_serving);
+            }
+
+            // Nobody is waiting, the next caller of take_ticket() will draw the served ticket
+            if (_data->next_ticket.load(std::memory_order_seq_cst) == ticket) return;
+
+            uint32_t expected = abandoned_mark(ticket);
+            if (!_data->abandoned[ticket % slot_count].compare_exchange_strong(expected, 0,
+                                                                               std::memory_order_seq_cst)) {
+                std::atomic<uint32_t> &slot = _data->slots[ticket % slot_count];
+                slot.fetch_add(1, std::memory_order_release);
+                futex::wake(slot);
+                return;
+            }
+
+            // The waiter gave up, skip its ticket
+            ticket++;
+        }
+    }
+
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // Whether async waiters of this instance hold a ticket, only used by the async waiter thread
+    bool _has_ticket;
+    // The ticket held by async waiters of this instance, only used by the async waiter thread
+    uint32_t _ticket;
+};
+
+/**
+ * A fair shared mutex. Waiters draw tickets in a shared memory segment
+ * and are served in the order they arrived. Every waiter sleeps on its
+ * own slot, releasing the mutex hands the ownership directly to the next
+ * waiter and only wakes up that waiter. Waiters which time out mark their
+ * ticket as abandoned, the ticket is skipped once it is served.
+ */
+class fair_shared_mutex : public shared_mutex {
+public:
+    /**
+     * Create a shared_mutex instance.
+     *
+     * @param mutex_name the mutex name
+     * @param openIfExists whether to open if the mutex already exists or throw an exception
+     * @param options the mutex options
+     */
+    fair_shared_mutex(const std::string &mutex_name, bool openIfExists, const shared_mutex_options &options = {})
+            : shared_mutex(mutex_name, openIfExists, options.waiting), _backend(_mtx_name, openIfExists, options) {
+        _stats.open(_mtx_name, options.stats, options.trace);
+    }
+
+    void lock() override {
+        (void) timed_lock(futex::clock::time_point::max());
+    }
+
+    [[nodiscard]] bool timed_lock(futex::clock::time_point deadline) override {
+        if (!_backend.try_lock()) {
+            mutex_stats_recorder::wait_scope wait(&_stats);
+            if (!_backend.lock_slow(_wait_policy, deadline)) return false;
+
+            wait.acquired();
+        }
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    void unlock() override {
+        record_unlocked();
+        // Clear the ownership first, the async waiter thread may acquire the mutex right after releasing it
+        _locked = false;
+        _backend.unlock();
+    }
+
+    [[nodiscard]] wait_preparation prepare_wait(bool, futex_target &target) override {
+        return _backend.prepare_wait(target);
+    }
+
+    [[nodiscard]] bool try_lock_after_wait(bool) override {
+        if (!_backend.try_lock_after_wait()) return false;
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+    void abandon_wait(bool) override {
+        _backend.abandon_wait();
+    }
+
+    /**
+     * Delete this shared_mutex. The shared memory segment is unmapped
+     * and deleted once the last instance using it is destroyed.
+     */
+    ~fair_shared_mutex() override {
+        // If locked, unlock the mutex. The backend gives up the ticket of the async waiters afterwards.
+        if (_locked) {
+            unlock();
+        }
+    }
+
+protected:
+    [[nodiscard]] bool acquire() override {
+        if (!_backend.try_lock()) return false;
+
+        _locked = true;
+        record_locked();
+        return true;
+    }
+
+private:
+    // The ticket lock
+    fair_mutex_backend _backend;
+};
+
+std::unique_ptr<shared_mutex>
+shared_mutex::createShared_mutex(const std::string &mtx_name, bool openIfExists, const shared_mutex_options &options) {
+    switch (options.backend) {
+        case shared_mutex_backend::automatic:
+#ifdef OS_WINDOWS
+            return std::make_unique<win_shared_mutex>(mtx_name, openIfExists, options);
+#elif defined(OS_LINUX)
+            return std::make_unique<futex_shared_mutex>(mtx_name, openIfExists, options);
+#elif defined(OS_UNIX)
+            return std::make_unique<unix_shared_mutex>(mtx_name, openIfExists, options);
+#endif
+        case shared_mutex_backend::semaphore:
+#ifdef OS_WINDOWS
+            return std::make_unique<win_shared_mutex>(mtx_name, openIfExists, options);
+#elif defined(OS_UNIX)
+            return std::make_unique<unix_shared_mutex>(mtx_name, openIfExists, options);
+#endif
+        case shared_mutex_backend::futex:
+#ifdef OS_LINUX
+            return std::make_unique<futex_shared_mutex>(mtx_name, openIfExists, options);
+#else
+            throw shared_mutex_exception("The futex backend is only supported on linux");
+#endif //OS_LINUX
+        case shared_mutex_backend::robust:
+#ifdef OS_UNIX
+            return std::make_unique<robust_shared_mutex>(mtx_name, openIfExists, options);
+#else
+            throw shared_mutex_exception("The robust backend is only supported on unix systems");
+#endif //OS_UNIX
+        case shared_mutex_backend::fair:
+            return std::make_unique<fair_shared_mutex>(mtx_name, openIfExists, options);
+        case shared_mutex_backend::pi:
+#ifdef OS_LINUX
+            return std::make_unique<pi_shared_mutex>(mtx_name, openIfExists, options);
+#else
+            throw shared_mutex_exception("The pi backend is only supported on linux");
+#endif //OS_LINUX
+        default:
+            throw shared_mutex_exception("Unknown shared_mutex backend");
+    }
 }
 
 #endif //SHARED_MUTEX_SHARED_MUTEX_HPP
@@ -0,0 +1,34 @@
+#ifndef SHARED_MUTEX_SHARED_MUTEX_EXCEPTION_HPP
+#define SHARED_MUTEX_SHARED_MUTEX_EXCEPTION_HPP
+
+#include <string>
+#include <exception>
+#include <utility>
+
+/**
+ * A shared mutex exception
+ */
+class shared_mutex_exception : public std::exception {
+public:
+    /**
+     * Create a shared mutex exception
+     *
+     * @param error the error description
+     */
+    explicit shared_mutex_exception(std::string error) : std::exception(), error(std::move(error)) {}
+
+    /**
+     * Get the error message
+     *
+     * @return the error message
+     */
+    [[nodiscard]] const char *what() const noexcept override {
+        return error.c_str();
+    }
+
+private:
+    // The error
+    const std::string error;
+};
+
+#endif //SHARED_MUTEX_SHARED_MUTEX_EXCEPTION_HPP
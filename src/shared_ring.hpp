@@ -0,0 +1,586 @@
+#ifndef SHARED_MUTEX_SHARED_RING_HPP
+#define SHARED_MUTEX_SHARED_RING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * The kinds of rings
+ */
+enum class ring_mode : uint32_t {
+    // Any number of producers and consumers
+    mpmc = 0,
+    // A single producer and a single consumer at a time
+    spsc = 1
+};
+
+/**
+ * Options for creating a shared_ring
+ */
+struct shared_ring_options {
+    // The number of slots, must be a power of two
+    uint32_t capacity = 1024;
+    // The max size of a message in bytes
+    uint32_t slot_size = 256;
+    // Whether the ring is used by many or a single producer and consumer
+    ring_mode mode = ring_mode::mpmc;
+};
+
+/**
+ * A bounded message queue in a shared memory segment. Messages are copied
+ * into fixed-size slots. Pushing and popping doesn't block or take a lock,
+ * producers and consumers only sleep on a futex if the ring is full or empty,
+ * and only wake each other up if someone sleeps.
+ *
+ * The MPMC mode orders the slots with per-slot sequence numbers. The SPSC mode
+ * only uses the head and tail indices, the ring must then be used by a
+ * single producer and a single consumer at a time, which is not checked.
+ * A process dying while it copies a message blocks its slot forever.
+ */
+class shared_ring {
+public:
+    // The max number of slots
+    static constexpr uint32_t max_capacity = 1u << 20u;
+    // The max size of a message in bytes
+    static constexpr uint32_t max_slot_size = 1u << 20u;
+
+    /**
+     * Open or create a ring
+     *
+     * @param name the name of the ring
+     * @param options the ring options, must match the options the ring was created with
+     */
+    explicit shared_ring(std::string name, const shared_ring_options &options = {}) : _name(std::move(name)) {
+        if (options.capacity < 2 || options.capacity > max_capacity ||
+            (options.capacity & (options.capacity - 1)) != 0) {
+            throw shared_mutex_exception("The capacity of a ring must be a power of two between 2 and " +
+                                         std::to_string(max_capacity));
+        } else if (options.slot_size == 0 || options.slot_size > max_slot_size) {
+            throw shared_mutex_exception("The slot size of a ring must be between 1 and " +
+                                         std::to_string(max_slot_size) + " bytes");
+        } else if (static_cast<uint64_t>(options.capacity) * stride(options.slot_size) > max_bytes) {
+            throw shared_mutex_exception("A ring must not be larger than " + std::to_string(max_bytes) + " bytes");
+        }
+
+        _stride = stride(options.slot_size);
+        _mask = options.capacity - 1;
+        _spsc = options.mode == ring_mode::spsc;
+        _memory = shared_memory::open_shared(_name + ".ring", sizeof(header) +
+                                                              static_cast<size_t>(options.capacity) * _stride, true);
+        _header = _memory->as<header>();
+        _slots = static_cast<char *>(_memory->data()) + sizeof(header);
+        _header->segment.initialize(ring_kind, _name, [&] {
+            _header->capacity = options.capacity;
+            _header->slot_size = options.slot_size;
+            _header->mode = static_cast<uint32_t>(options.mode);
+            for (uint32_t i = 0; i < options.capacity; i++) {
+                slot_at(i).sequence.store(i, std::memory_order_relaxed);
+            }
+        });
+
+        if (_header->capacity != options.capacity || _header->slot_size != options.slot_size ||
+            _header->mode != static_cast<uint32_t>(options.mode)) {
+            throw shared_mutex_exception(
+                    "A ring with the name '" + _name + "' already exists with different options");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_ring(const shared_ring &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_ring &operator=(const shared_ring &) = delete;
+
+    /**
+     * Try pushing a message without blocking
+     *
+     * @param data the message
+     * @param size the size of the message in bytes
+     * @return false, if the ring is full
+     */
+    [[nodiscard]] bool try_push(const void *data, size_t size) {
+        if (!push_one(data, size)) return false;
+
+        notify(_header->items, _header->consumers, 1);
+        return true;
+    }
+
+    /**
+     * Push messages without blocking. Consumers are woken up once for the whole batch.
+     *
+     * @param count the number of messages
+     * @param message a function returning the pointer to and the size of the message at an index
+     * @return the number of messages pushed, less than count if the ring got full
+     */
+    template<class Message>
+    size_t try_push_batch(size_t count, Message &&message) {
+        size_t pushed = 0;
+        try {
+            for (; pushed < count; pushed++) {
+                const std::pair<const void *, size_t> msg = message(pushed);
+                if (!push_one(msg.first, msg.second)) break;
+            }
+        } catch (...) {
+            // Don't leave consumers sleeping on the messages which were pushed
+            if (pushed > 0) notify(_header->items, _header->consumers, pushed);
+            throw;
+        }
+
+        if (pushed > 0) notify(_header->items, _header->consumers, pushed);
+        return pushed;
+    }
+
+    /**
+     * Push a message, waiting until the deadline at most while the ring is full
+     *
+     * @param data the message
+     * @param size the size of the message in bytes
+     * @param deadline the time point to stop waiting at
+     * @return false, if the deadline was reached
+     */
+    [[nodiscard]] bool timed_push(const void *data, size_t size, futex::clock::time_point deadline) {
+        return wait_for_slot(_header->space, _header->producers, deadline, [&] {
+            return try_push(data, size);
+        });
+    }
+
+    /**
+     * Push a message. Blocking call.
+     *
+     * @param data the message
+     * @param size the size of the message in bytes
+     */
+    void push(const void *data, size_t size) {
+        (void) timed_push(data, size, futex::clock::time_point::max());
+    }
+
+    /**
+     * Try popping a message without blocking
+     *
+     * @param consume a function called with the pointer to and the size of the message,
+     *                which must copy the message before it returns
+     * @return false, if the ring is empty
+     */
+    template<class Consume>
+    [[nodiscard]] bool try_pop(Consume &&consume) {
+        if (!pop_one(consume)) return false;
+
+        notify(_header->space, _header->producers, 1);
+        return true;
+    }
+
+    /**
+     * Pop messages without blocking. Producers are woken up once for the whole batch.
+     *
+     * @param max the max number of messages to pop
+     * @param consume a function called with the pointer to and the size of every message
+     * @return the number of messages popped
+     */
+    template<class Consume>
+    size_t try_pop_batch(size_t max, Consume &&consume) {
+        size_t popped = 0;
+        while (popped < max && pop_one(consume)) popped++;
+
+        if (popped > 0) notify(_header->space, _header->producers, popped);
+        return popped;
+    }
+
+    /**
+     * Pop a message, waiting until the deadline at most while the ring is empty
+     *
+     * @param consume a function called with the pointer to and the size of the message
+     * @param deadline the time point to stop waiting at
+     * @return false, if the deadline was reached
+     */
+    template<class Consume>
+    [[nodiscard]] bool timed_pop(Consume &&consume, futex::clock::time_point deadline) {
+        return wait_for_slot(_header->items, _header->consumers, deadline, [&] {
+            return try_pop(consume);
+        });
+    }
+
+    /**
+     * Pop a message. Blocking call.
+     *
+     * @param consume a function called with the pointer to and the size of the message
+     */
+    template<class Consume>
+    void pop(Consume &&consume) {
+        (void) timed_pop(consume, futex::clock::time_point::max());
+    }
+
+    /**
+     * Prepare waiting until a message can be pushed after try_push() failed. Registers
+     * the caller as a waiting producer, leave_push_wait() must be called once it stopped waiting.
+     *
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the futex word producers wait on
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_push_wait(bool &registered, futex_target &target) noexcept {
+        return prepare_wait(_header->space, _header->producers, registered, target, [this] {
+            return full();
+        });
+    }
+
+    /**
+     * Stop waiting until a message can be pushed
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     */
+    void leave_push_wait(bool &registered) noexcept {
+        leave_wait(_header->producers, registered);
+    }
+
+    /**
+     * Prepare waiting until a message can be popped after try_pop() failed. Registers
+     * the caller as a waiting consumer, leave_pop_wait() must be called once it stopped waiting.
+     *
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the futex word consumers wait on
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_pop_wait(bool &registered, futex_target &target) noexcept {
+        return prepare_wait(_header->items, _header->consumers, registered, target, [this] {
+            return empty();
+        });
+    }
+
+    /**
+     * Stop waiting until a message can be popped
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     */
+    void leave_pop_wait(bool &registered) noexcept {
+        leave_wait(_header->consumers, registered);
+    }
+
+    /**
+     * Get the number of messages in the ring. Only a snapshot, other processes may push or pop at any time.
+     *
+     * @return the number of messages
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        const uint64_t tail = _header->tail.load(std::memory_order_acquire);
+        const uint64_t head = _header->head.load(std::memory_order_acquire);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+
+    /**
+     * Get the number of slots
+     *
+     * @return the capacity
+     */
+    [[nodiscard]] uint32_t capacity() const noexcept {
+        return _header->capacity;
+    }
+
+    /**
+     * Get the max size of a message
+     *
+     * @return the slot size in bytes
+     */
+    [[nodiscard]] uint32_t slot_size() const noexcept {
+        return _header->slot_size;
+    }
+
+private:
+    // The size of a cache line
+    static constexpr size_t cache_line = 64;
+    // The max size of the slots of a ring in bytes
+    static constexpr uint64_t max_bytes = 1ull << 32u;
+
+    /**
+     * The header at the start of the shared memory segment.
+     * Producers and consumers write to separate cache lines.
+     */
+    struct alignas(cache_line) header {
+        // The segment header
+        segment_header segment;
+        // The number of slots
+        uint32_t capacity;
+        // The max size of a message
+        uint32_t slot_size;
+        // The ring mode
+        uint32_t mode;
+        // The position of the next message to push
+        alignas(cache_line) std::atomic<uint64_t> head;
+        // The position of the next message to pop
+        alignas(cache_line) std::atomic<uint64_t> tail;
+        // Incremented when messages are pushed while consumers are waiting
+        alignas(cache_line) std::atomic<uint32_t> items;
+        // The number of waiting consumers
+        std::atomic<uint32_t> consumers;
+        // Incremented when messages are popped while producers are waiting
+        alignas(cache_line) std::atomic<uint32_t> space;
+        // The number of waiting producers
+        std::atomic<uint32_t> producers;
+    };
+
+    /**
+     * The header of a slot, followed by the message
+     */
+    struct slot {
+        // The sequence number of the slot, equal to the position for a free slot
+        // and the position plus one for a slot holding a message. Unused in SPSC mode.
+        std::atomic<uint64_t> sequence;
+        // The size of the message
+        uint32_t size;
+    };
+
+    /**
+     * Get the distance between two slots
+     *
+     * @param slot_size the max size of a message
+     * @return the distance in bytes, a multiple of the cache line size
+     */
+    static size_t stride(uint32_t slot_size) noexcept {
+        return (sizeof(slot) + slot_size + cache_line - 1) / cache_line * cache_line;
+    }
+
+    /**
+     * Get a slot
+     *
+     * @param position the position of a message
+     * @return the slot the message is stored in
+     */
+    slot &slot_at(uint64_t position) const noexcept {
+        return *reinterpret_cast<slot *>(_slots + static_cast<size_t>(position & _mask) * _stride);
+    }
+
+    /**
+     * Get the message stored in a slot
+     *
+     * @param s the slot
+     * @return the pointer to the message
+     */
+    static char *message(slot &s) noexcept {
+        return reinterpret_cast<char *>(&s) + sizeof(slot);
+    }
+
+    /**
+     * Claim a slot and copy a message into it
+     *
+     * @param data the message
+     * @param size the size of the message
+     * @return false, if the ring is full
+     */
+    bool push_one(const void *data, size_t size) {
+        if (size > _header->slot_size) {
+            throw shared_mutex_exception("The message of " + std::to_string(size) + " bytes is larger than the "
+                                         "slot size of the ring '" + _name + "'");
+        }
+
+        if (_spsc) {
+            const uint64_t head = _header->head.load(std::memory_order_relaxed);
+            if (head - _header->tail.load(std::memory_order_acquire) >= _header->capacity) return false;
+
+            slot &s = slot_at(head);
+            s.size = static_cast<uint32_t>(size);
+            std::memcpy(message(s), data, size);
+            _header->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        uint64_t position = _header->head.load(std::memory_order_relaxed);
+        for (;;) {
+            slot &s = slot_at(position);
+            const auto diff = static_cast<int64_t>(s.sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                if (_header->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    s.size = static_cast<uint32_t>(size);
+                    std::memcpy(message(s), data, size);
+                    s.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The slot still holds a message from the last round
+                return false;
+            } else {
+                position = _header->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Pop a message from its slot
+     *
+     * @param consume the function consuming the message
+     * @return false, if the ring is empty
+     */
+    template<class Consume>
+    bool pop_one(Consume &consume) {
+        if (_spsc) {
+            const uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+            if (tail == _header->head.load(std::memory_order_acquire)) return false;
+
+            slot &s = slot_at(tail);
+            consume(static_cast<const void *>(message(s)), static_cast<size_t>(s.size));
+            _header->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        uint64_t position = _header->tail.load(std::memory_order_relaxed);
+        for (;;) {
+            slot &s = slot_at(position);
+            const auto diff = static_cast<int64_t>(s.sequence.load(std::memory_order_acquire) - (position + 1));
+            if (diff == 0) {
+                if (_header->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    consume(static_cast<const void *>(message(s)), static_cast<size_t>(s.size));
+                    s.sequence.store(position + _mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The slot is free or a producer is still copying its message
+                return false;
+            } else {
+                position = _header->tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Check whether the ring is full
+     *
+     * @return true, if no message can be pushed right now
+     */
+    [[nodiscard]] bool full() const noexcept {
+        if (_spsc) return size() >= _header->capacity;
+
+        const uint64_t position = _header->head.load(std::memory_order_acquire);
+        return static_cast<int64_t>(slot_at(position).sequence.load(std::memory_order_acquire) - position) < 0;
+    }
+
+    /**
+     * Check whether the ring is empty
+     *
+     * @return true, if no message can be popped right now
+     */
+    [[nodiscard]] bool empty() const noexcept {
+        if (_spsc) return size() == 0;
+
+        const uint64_t position = _header->tail.load(std::memory_order_acquire);
+        return static_cast<int64_t>(slot_at(position).sequence.load(std::memory_order_acquire) -
+                                    (position + 1)) < 0;
+    }
+
+    /**
+     * Wake up the waiters of one side of the ring, if there are any
+     *
+     * @param word the futex word of the waiters
+     * @param waiters the number of waiters
+     * @param count the number of messages or free slots which became available
+     */
+    static void notify(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiters, size_t count) {
+        // Waiters register before checking the ring again, the slot must be published before checking
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return;
+
+        word.fetch_add(1, std::memory_order_release);
+        futex::wake(word, count > INT_MAX ? INT_MAX : static_cast<int>(count));
+    }
+
+    /**
+     * Prepare waiting on one side of the ring
+     *
+     * @param word the futex word of the waiters
+     * @param waiters the number of waiters
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the futex word
+     * @param blocked a function checking whether the caller still can't proceed
+     * @return whether to wait on the target or retry immediately
+     */
+    template<class Blocked>
+    static wait_preparation prepare_wait(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiters,
+                                         bool &registered, futex_target &target, Blocked &&blocked) noexcept {
+        if (!registered) {
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            registered = true;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint32_t observed = word.load(std::memory_order_acquire);
+        if (!blocked()) return wait_preparation::retry;
+
+        target.word = &word;
+        target.expected = observed;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Stop waiting on one side of the ring
+     *
+     * @param waiters the number of waiters
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     */
+    static void leave_wait(std::atomic<uint32_t> &waiters, bool &registered) noexcept {
+        if (!registered) return;
+
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        registered = false;
+    }
+
+    /**
+     * Retry an operation until it succeeds, sleeping while the ring is full or empty
+     *
+     * @param word the futex word of the waiters
+     * @param waiters the number of waiters
+     * @param deadline the time point to stop waiting at
+     * @param attempt the operation to retry
+     * @return false, if the deadline was reached
+     */
+    template<class Attempt>
+    bool wait_for_slot(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiters,
+                       futex::clock::time_point deadline, Attempt &&attempt) {
+        if (attempt()) return true;
+
+        bool registered = false;
+        for (;;) {
+            // Register first, so the other side wakes this waiter up if the attempt fails
+            futex_target target;
+            (void) prepare_wait(word, waiters, registered, target, [] { return true; });
+            if (attempt()) break;
+
+            if (!futex::wait_until(word, target.expected, deadline)) {
+                const bool succeeded = attempt();
+                leave_wait(waiters, registered);
+                return succeeded;
+            }
+        }
+
+        leave_wait(waiters, registered);
+        return true;
+    }
+
+    // The name of the ring
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The header in the shared memory segment
+    header *_header = nullptr;
+    // The first slot
+    char *_slots = nullptr;
+    // The distance between two slots in bytes
+    size_t _stride = 0;
+    // The mask turning a position into a slot index
+    uint64_t _mask = 0;
+    // Whether the ring is used by a single producer and consumer
+    bool _spsc = false;
+};
+
+#endif //SHARED_MUTEX_SHARED_RING_HPP
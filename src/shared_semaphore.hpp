@@ -0,0 +1,279 @@
+#ifndef SHARED_MUTEX_SHARED_SEMAPHORE_HPP
+#define SHARED_MUTEX_SHARED_SEMAPHORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+
+/**
+ * Options for creating a shared_semaphore
+ */
+struct shared_semaphore_options {
+    // The number of permits the semaphore starts with
+    uint32_t initial = 1;
+    // The max number of permits, zero to use the initial number
+    uint32_t max = 0;
+};
+
+/**
+ * A named counting semaphore in a shared memory segment.
+ * Any number of permits can be acquired and released at once,
+ * acquiring multiple permits takes them all in a single step.
+ *
+ * Waiters are not served in order, a waiter acquiring many permits
+ * may be overtaken by waiters acquiring fewer permits. Permits held
+ * by a process which dies are lost.
+ */
+class shared_semaphore {
+public:
+    // The max number of permits of a semaphore
+    static constexpr uint32_t max_count = 0x7fffffffu;
+
+    /**
+     * Open or create a semaphore
+     *
+     * @param name the name of the semaphore
+     * @param options the semaphore options, only used by the process creating the semaphore
+     */
+    explicit shared_semaphore(std::string name, const shared_semaphore_options &options = {})
+            : _name(std::move(name)), _held(0) {
+        const uint32_t max = options.max == 0 ? options.initial : options.max;
+        if (max == 0 || max > max_count || options.initial > max) {
+            throw shared_mutex_exception("The initial number of permits must be between 0 and the max number "
+                                         "of permits, which must be between 1 and " + std::to_string(max_count));
+        }
+
+        _memory = shared_memory::open_shared(_name + ".semaphore", sizeof(data), true);
+        _data = _memory->as<data>();
+        _data->header.initialize(semaphore_kind, _name, [&] {
+            _data->count.store(options.initial, std::memory_order_relaxed);
+            _data->max = max;
+        });
+
+        if (_data->max != max) {
+            throw shared_mutex_exception(
+                    "A semaphore with the name '" + _name + "' already exists with a different max count");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_semaphore(const shared_semaphore &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_semaphore &operator=(const shared_semaphore &) = delete;
+
+    /**
+     * Acquire permits. Blocking call.
+     *
+     * @param count the number of permits to acquire
+     */
+    void acquire(uint32_t count = 1) {
+        (void) timed_acquire(count, futex::clock::time_point::max());
+    }
+
+    /**
+     * Acquire permits, waiting until the deadline at most
+     *
+     * @param count the number of permits to acquire
+     * @param deadline the time point to stop waiting at
+     * @return true, if the permits could be acquired
+     */
+    [[nodiscard]] bool timed_acquire(uint32_t count, futex::clock::time_point deadline) {
+        if (try_acquire(count)) return true;
+
+        _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+        for (;;) {
+            // Releases increment the count before checking for waiters
+            const uint32_t available = _data->count.load(std::memory_order_seq_cst);
+            if (available >= count) {
+                if (try_acquire(count)) break;
+            } else if (!futex::wait_until(_data->count, available, deadline)) {
+                _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Acquire permits, waiting for at most the given duration
+     *
+     * @param count the number of permits to acquire
+     * @param timeout the max time to wait for
+     * @return true, if the permits could be acquired
+     */
+    template<class Rep, class Period>
+    [[nodiscard]] bool try_acquire_for(uint32_t count, const std::chrono::duration<Rep, Period> &timeout) {
+        return timed_acquire(count, futex::deadline_after(timeout));
+    }
+
+    /**
+     * Try acquiring permits without blocking
+     *
+     * @param count the number of permits to acquire
+     * @return true, if the permits could be acquired
+     */
+    [[nodiscard]] bool try_acquire(uint32_t count = 1) {
+        check_count(count);
+
+        uint32_t available = _data->count.load(std::memory_order_relaxed);
+        while (available >= count) {
+            if (_data->count.compare_exchange_weak(available, available - count, std::memory_order_acquire,
+                                                   std::memory_order_relaxed)) {
+                _held.fetch_add(count, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Release permits. Permits may be released by instances which
+     * didn't acquire them, as long as the max count isn't exceeded.
+     *
+     * @param count the number of permits to release
+     */
+    void release(uint32_t count = 1) {
+        check_count(count);
+
+        uint32_t available = _data->count.load(std::memory_order_relaxed);
+        do {
+            if (count > _data->max - available) {
+                throw shared_mutex_exception("Releasing " + std::to_string(count) + " permits would exceed the "
+                                             "max count of the semaphore '" + _name + "'");
+            }
+        } while (!_data->count.compare_exchange_weak(available, available + count, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed));
+
+        uint64_t held = _held.load(std::memory_order_relaxed);
+        while (!_held.compare_exchange_weak(held, held - std::min<uint64_t>(held, count),
+                                            std::memory_order_relaxed)) {}
+
+        // Waiters may wait for different numbers of permits, wake them all up
+        if (_data->waiters.load(std::memory_order_seq_cst) > 0) {
+            futex::wake(_data->count);
+        }
+    }
+
+    /**
+     * Prepare waiting for permits after try_acquire() failed. Registers
+     * the caller as a waiter, leave_wait() must be called once it stopped waiting.
+     *
+     * @param count the number of permits to acquire
+     * @param registered whether the caller is registered as a waiter, updated by this call
+     * @param target set to the count word
+     * @return whether to wait on the target or retry immediately
+     */
+    [[nodiscard]] wait_preparation prepare_wait(uint32_t count, bool &registered, futex_target &target) {
+        if (!registered) {
+            _data->waiters.fetch_add(1, std::memory_order_seq_cst);
+            registered = true;
+        }
+
+        const uint32_t available = _data->count.load(std::memory_order_seq_cst);
+        if (available >= count) return wait_preparation::retry;
+
+        target.word = &_data->count;
+        target.expected = available;
+        return wait_preparation::wait;
+    }
+
+    /**
+     * Stop waiting for permits after prepare_wait() was called
+     *
+     * @param registered whether the caller is registered as a waiter, reset by this call
+     */
+    void leave_wait(bool &registered) noexcept {
+        if (!registered) return;
+
+        _data->waiters.fetch_sub(1, std::memory_order_relaxed);
+        registered = false;
+    }
+
+    /**
+     * Get the number of available permits
+     *
+     * @return the number of permits which could be acquired right now
+     */
+    [[nodiscard]] uint32_t count() const noexcept {
+        return _data->count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the max number of permits
+     *
+     * @return the max count
+     */
+    [[nodiscard]] uint32_t max() const noexcept {
+        return _data->max;
+    }
+
+    /**
+     * Delete the semaphore. Releases all permits acquired by this instance which
+     * were not released yet. The shared memory segment is deleted once the last
+     * instance using it is destroyed.
+     */
+    ~shared_semaphore() {
+        const uint64_t held = _held.load(std::memory_order_relaxed);
+        if (held == 0) return;
+
+        try {
+            release(static_cast<uint32_t>(std::min<uint64_t>(held, _data->max)));
+        } catch (...) {
+            // Other instances released permits they didn't acquire
+        }
+    }
+
+private:
+    /**
+     * The data stored in the shared memory segment
+     */
+    struct data {
+        // The segment header
+        segment_header header;
+        // The number of available permits
+        std::atomic<uint32_t> count;
+        // The max number of permits
+        uint32_t max;
+        // The number of threads and operations waiting for permits
+        std::atomic<uint32_t> waiters;
+    };
+
+    /**
+     * Check the number of permits passed to an operation
+     *
+     * @param count the number of permits
+     */
+    void check_count(uint32_t count) const {
+        if (count == 0 || count > _data->max) {
+            throw shared_mutex_exception("The number of permits must be between 1 and the max count of the "
+                                         "semaphore '" + _name + "', which is " + std::to_string(_data->max));
+        }
+    }
+
+    // The name of the semaphore
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The data in the shared memory segment
+    data *_data = nullptr;
+    // The number of permits acquired by this instance and not released yet
+    std::atomic<uint64_t> _held;
+};
+
+#endif //SHARED_MUTEX_SHARED_SEMAPHORE_HPP
@@ -0,0 +1,262 @@
+#ifndef SHARED_MUTEX_SHARED_SEQLOCK_HPP
+#define SHARED_MUTEX_SHARED_SEQLOCK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "platform.hpp"
+#include "futex.hpp"
+#include "shared_memory.hpp"
+#include "shared_mutex_exception.hpp"
+#include "wait_policy.hpp"
+
+/**
+ * A named data region in a shared memory segment protected by a seqlock.
+ * Writers exclude each other with a lock and increment a sequence number
+ * before and after changing the data. Readers copy the data without
+ * locking and retry if the sequence number changed while copying, so they
+ * never block writers or each other and never write to the segment.
+ *
+ * The data is copied in 64-bit words with relaxed atomic loads and stores.
+ * A writer dying while it changes the data leaves the region unreadable.
+ */
+class shared_seqlock {
+public:
+    // The max size of the data region in bytes
+    static constexpr uint32_t max_size = 1u << 30u;
+
+    /**
+     * Open or create a seqlock protected region
+     *
+     * @param name the name of the region
+     * @param size the size of the region in bytes, must match the size it was created with
+     */
+    shared_seqlock(std::string name, uint32_t size) : _name(std::move(name)) {
+        if (size == 0 || size > max_size) {
+            throw shared_mutex_exception("The size of a seqlock region must be between 1 and " +
+                                         std::to_string(max_size) + " bytes");
+        }
+
+        _memory = shared_memory::open_shared(_name + ".seqlock", sizeof(header) + word_count(size) * sizeof(word),
+                                             true);
+        _header = _memory->as<header>();
+        _words = reinterpret_cast<word *>(static_cast<char *>(_memory->data()) + sizeof(header));
+        _header->segment.initialize(seqlock_kind, _name, [&] {
+            _header->size = size;
+        });
+
+        if (_header->size != size) {
+            throw shared_mutex_exception("A seqlock region with the name '" + _name + "' already exists with a "
+                                         "size of " + std::to_string(_header->size) + " bytes");
+        }
+    }
+
+    /**
+     * No copy constructor
+     */
+    shared_seqlock(const shared_seqlock &) = delete;
+
+    /**
+     * No copy assignment operator
+     */
+    shared_seqlock &operator=(const shared_seqlock &) = delete;
+
+    /**
+     * Copy data into the region. Waits for other writers, but never for readers.
+     *
+     * @param source the data to copy
+     * @param size the number of bytes to copy
+     * @param offset the offset in the region to copy the data to
+     */
+    void write(const void *source, size_t size, size_t offset = 0) {
+        check_range(size, offset);
+
+        lock_writer();
+        const uint32_t sequence = _header->sequence.load(std::memory_order_relaxed);
+        _header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        // Readers must see the odd sequence number before any of the new data
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const auto *src = static_cast<const unsigned char *>(source);
+        for (size_t pos = offset; pos < offset + size;) {
+            const size_t index = pos / sizeof(uint64_t);
+            const size_t begin = pos % sizeof(uint64_t);
+            const size_t count = std::min(sizeof(uint64_t) - begin, offset + size - pos);
+
+            uint64_t value = _words[index].load(std::memory_order_relaxed);
+            std::memcpy(reinterpret_cast<unsigned char *>(&value) + begin, src + (pos - offset), count);
+            _words[index].store(value, std::memory_order_relaxed);
+            pos += count;
+        }
+
+        _header->sequence.store(sequence + 2, std::memory_order_release);
+        unlock_writer();
+    }
+
+    /**
+     * Try copying data out of the region once
+     *
+     * @param destination the buffer to copy the data to
+     * @param size the number of bytes to copy
+     * @param offset the offset in the region to copy the data from
+     * @param sequence set to the sequence number of the copied data
+     * @return false, if a writer changed the data while copying
+     */
+    [[nodiscard]] bool try_read(void *destination, size_t size, size_t offset, uint32_t &sequence) const {
+        check_range(size, offset);
+
+        sequence = _header->sequence.load(std::memory_order_acquire);
+        if (sequence & 1u) return false;
+
+        auto *dest = static_cast<unsigned char *>(destination);
+        for (size_t pos = offset; pos < offset + size;) {
+            const size_t index = pos / sizeof(uint64_t);
+            const size_t begin = pos % sizeof(uint64_t);
+            const size_t count = std::min(sizeof(uint64_t) - begin, offset + size - pos);
+
+            const uint64_t value = _words[index].load(std::memory_order_relaxed);
+            std::memcpy(dest + (pos - offset), reinterpret_cast<const unsigned char *>(&value) + begin, count);
+            pos += count;
+        }
+
+        // The data must be read before the sequence number is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _header->sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    /**
+     * Copy data out of the region. Retries until no writer changed the data while copying.
+     *
+     * @param destination the buffer to copy the data to
+     * @param size the number of bytes to copy
+     * @param offset the offset in the region to copy the data from
+     * @return the sequence number of the copied data
+     */
+    uint32_t read(void *destination, size_t size, size_t offset = 0) const {
+        uint32_t sequence;
+        for (uint32_t attempts = 0; !try_read(destination, size, offset, sequence); attempts++) {
+            // A writer is copying its data, which doesn't take long
+            if (attempts < 64) {
+                cpu_relax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        return sequence;
+    }
+
+    /**
+     * Get the current sequence number. It is odd while a writer changes the data
+     * and increases with every write, readers caching a copy of the data may
+     * compare it to the sequence number of their copy to check whether it is outdated.
+     *
+     * @return the sequence number
+     */
+    [[nodiscard]] uint32_t sequence() const noexcept {
+        return _header->sequence.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Get the size of the region
+     *
+     * @return the size in bytes
+     */
+    [[nodiscard]] uint32_t size() const noexcept {
+        return _header->size;
+    }
+
+private:
+    // The size of a cache line
+    static constexpr size_t cache_line = 64;
+    // The writer lock is not locked
+    static constexpr uint32_t unlocked = 0;
+    // The writer lock is locked without waiters
+    static constexpr uint32_t locked = 1;
+    // The writer lock is locked and there may be waiters
+    static constexpr uint32_t contended = 2;
+
+    // A word of the data region
+    using word = std::atomic<uint64_t>;
+
+    /**
+     * The header at the start of the shared memory segment. The sequence number
+     * is read by every reader and is kept apart from the lock word writers wait on.
+     */
+    struct alignas(cache_line) header {
+        // The segment header
+        segment_header segment;
+        // The size of the region in bytes
+        uint32_t size;
+        // The lock word excluding writers from each other
+        std::atomic<uint32_t> writer;
+        // The sequence number, odd while a writer changes the data
+        alignas(cache_line) std::atomic<uint32_t> sequence;
+    };
+
+    /**
+     * Get the number of words needed to store a region
+     *
+     * @param size the size of the region in bytes
+     * @return the number of 64-bit words
+     */
+    static size_t word_count(uint32_t size) noexcept {
+        return (static_cast<size_t>(size) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+
+    /**
+     * Check the range passed to an operation
+     *
+     * @param size the number of bytes to copy
+     * @param offset the offset in the region
+     */
+    void check_range(size_t size, size_t offset) const {
+        if (offset > _header->size || size > _header->size - offset) {
+            throw shared_mutex_exception("The range of " + std::to_string(size) + " bytes at offset " +
+                                         std::to_string(offset) + " exceeds the size of the seqlock region '" +
+                                         _name + "', which is " + std::to_string(_header->size) + " bytes");
+        }
+    }
+
+    /**
+     * Lock the writer lock
+     */
+    void lock_writer() noexcept {
+        uint32_t state = unlocked;
+        if (_header->writer.compare_exchange_strong(state, locked, std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+            return;
+        }
+
+        if (state != contended) state = _header->writer.exchange(contended, std::memory_order_acquire);
+        while (state != unlocked) {
+            futex::wait(_header->writer, contended);
+            state = _header->writer.exchange(contended, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * Unlock the writer lock
+     */
+    void unlock_writer() noexcept {
+        if (_header->writer.exchange(unlocked, std::memory_order_release) == contended) {
+            futex::wake(_header->writer, 1);
+        }
+    }
+
+    // The name of the region
+    const std::string _name;
+    // The shared memory segment
+    std::shared_ptr<shared_memory> _memory;
+    // The header in the shared memory segment
+    header *_header = nullptr;
+    // The words of the data region
+    word *_words = nullptr;
+};
+
+#endif //SHARED_MUTEX_SHARED_SEQLOCK_HPP
@@ -0,0 +1,200 @@
+#ifndef SHARED_MUTEX_WAIT_POLICY_HPP
+#define SHARED_MUTEX_WAIT_POLICY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "platform.hpp"
+#include "futex.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#   include <intrin.h>
+#endif
+
+/**
+ * How to wait for a contended mutex
+ */
+enum class wait_mode {
+    // Wait in the kernel immediately
+    park,
+    // Spin for a while, then yield the CPU a few times, then wait in the kernel.
+    // The number of spins adapts to the time the mutex was held for.
+    adaptive
+};
+
+/**
+ * Options for waiting for a contended mutex
+ */
+struct wait_policy_options {
+    // How to wait
+    wait_mode mode = wait_mode::park;
+    // The max number of spins before yielding
+    uint32_t max_spins = 4000;
+    // The max number of yields before waiting in the kernel
+    uint32_t max_yields = 8;
+};
+
+/**
+ * The number of contended acquisitions which succeeded in each wait phase
+ */
+struct wait_phase_stats {
+    // The mutex was acquired while spinning
+    uint64_t spin = 0;
+    // The mutex was acquired after yielding the CPU
+    uint64_t yield = 0;
+    // The mutex was acquired after waiting in the kernel
+    uint64_t park = 0;
+};
+
+/**
+ * Tell the CPU that this thread is spinning
+ */
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * Decides how long to spin and yield before waiting in
+ * the kernel for a contended mutex. Counts how often each
+ * phase acquired the mutex. The spin budget follows the
+ * number of spins recent acquisitions needed, like glibc's
+ * adaptive mutexes.
+ */
+class wait_policy {
+public:
+    /**
+     * Create a wait policy
+     *
+     * @param options the policy options
+     */
+    explicit wait_policy(const wait_policy_options &options = {}) : _options(options), _spin_estimate(0),
+                                                                     _spin(0), _yield(0), _park(0) {}
+
+    /**
+     * Try to acquire a mutex before waiting in the kernel.
+     * Spins, then yields the CPU. Does nothing in park mode.
+     *
+     * @param try_acquire the function trying to acquire the mutex
+     * @param deadline the time point to stop at
+     * @return true, if the mutex was acquired
+     */
+    template<class TryAcquire>
+    bool spin(TryAcquire &&try_acquire, futex::clock::time_point deadline = futex::clock::time_point::max()) {
+        if (_options.mode == wait_mode::park) return false;
+
+        // Spin about twice as long as recent acquisitions needed. Spinning
+        // is pointless on a single core, the owner can't run in the meantime.
+        static const bool multi_core = std::thread::hardware_concurrency() > 1;
+        const int32_t estimate = _spin_estimate.load(std::memory_order_relaxed);
+        const uint32_t max_spins = multi_core ? std::min<uint32_t>(_options.max_spins, spin_cap) : 0;
+        const int32_t limit = std::min<int32_t>(static_cast<int32_t>(max_spins), estimate * 2 + 10);
+
+        for (int32_t spins = 1; spins <= limit; spins++) {
+            cpu_relax();
+            if (try_acquire()) {
+                _spin_estimate.store(estimate + (spins - estimate) / 8, std::memory_order_relaxed);
+                _spin.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        _spin_estimate.store(estimate + (limit - estimate) / 8, std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < _options.max_yields && futex::clock::now() < deadline; i++) {
+            std::this_thread::yield();
+            if (try_acquire()) {
+                _yield.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Record that the mutex was acquired after waiting in the kernel
+     */
+    void parked() noexcept {
+        _park.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of acquisitions per phase
+     *
+     * @return the phase statistics
+     */
+    [[nodiscard]] wait_phase_stats stats() const noexcept {
+        wait_phase_stats stats;
+        stats.spin = _spin.load(std::memory_order_relaxed);
+        stats.yield = _yield.load(std::memory_order_relaxed);
+        stats.park = _park.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    /**
+     * Get the policy options
+     *
+     * @return the options
+     */
+    [[nodiscard]] const wait_policy_options &options() const noexcept {
+        return _options;
+    }
+
+private:
+    // The upper bound for the max number of spins
+    static constexpr uint32_t spin_cap = 1u << 20u;
+
+    // The policy options
+    const wait_policy_options _options;
+    // The estimated number of spins needed to acquire the mutex
+    std::atomic<int32_t> _spin_estimate;
+    // The number of acquisitions while spinning
+    std::atomic<uint64_t> _spin;
+    // The number of acquisitions after yielding
+    std::atomic<uint64_t> _yield;
+    // The number of acquisitions after waiting in the kernel
+    std::atomic<uint64_t> _park;
+};
+
+/**
+ * A wait policy for basic_shared_mutex which always waits in the kernel
+ * immediately. Has the interface of wait_policy, but keeps no state and
+ * no statistics, so waiting for a contended mutex does nothing extra.
+ */
+class park_wait_policy {
+public:
+    /**
+     * Never spin
+     *
+     * @return false
+     */
+    template<class TryAcquire>
+    static constexpr bool spin(TryAcquire &&, futex::clock::time_point = futex::clock::time_point::max()) noexcept {
+        return false;
+    }
+
+    /**
+     * Record nothing
+     */
+    static constexpr void parked() noexcept {}
+
+    /**
+     * Get the number of acquisitions per phase
+     *
+     * @return all zero
+     */
+    [[nodiscard]] static constexpr wait_phase_stats stats() noexcept {
+        return {};
+    }
+};
+
+#endif //SHARED_MUTEX_WAIT_POLICY_HPP
@@ -1,5 +1,7 @@
 const {fork} = require('child_process');
 const assert = require("assert");
+const fs = require('fs');
+const {Worker} = require('worker_threads');
 
 const mutex = require('./index');
 
@@ -76,6 +78,46 @@ describe('processMutex', () => {
             mtx.destroy();
         });
     });
+
+    describe('#lock_file backend', () => {
+        const NAME = "test_lock_file";
+        let mtx;
+        it('create: should not throw', () => {
+            mtx = new mutex.process_mutex(NAME, {backend: "lock_file", receive_args: true});
+        });
+
+        it('create: should throw an exception', () => {
+            assert.throws(() => {
+                new mutex.process_mutex(NAME, {backend: "lock_file"});
+            }, Error, "A mutex with the name 'test_lock_file' is already owned by another program");
+            assert.strictEqual(mutex.process_mutex.try_create(NAME, {backend: "lock_file"}), null);
+        });
+
+        it('receive_args: should receive the arguments of another process', async () => {
+            const received = mtx.receive_args({timeout: 10000});
+            fork("child_test.js", ["forwardArgs", NAME, "--open", "a file.txt", ""]);
+
+            assert.deepStrictEqual(await received, ["--open", "a file.txt", ""]);
+        });
+
+        it('receive_args: should time out', async () => {
+            await assert.rejects(mtx.receive_args({timeout: 10}), /timed out/);
+        });
+
+        it('destroy: should reject pending receive_args calls', async () => {
+            const received = mtx.receive_args();
+            mtx.destroy();
+            await assert.rejects(received, Error);
+            assert.strictEqual(mutex.process_mutex.forward_args(NAME, ["a"]), false);
+        });
+
+        it('create after the owner crashed: should not throw', (done) => {
+            fork("child_test.js", ["lockFileAndDie", NAME]).on('close', () => {
+                new mutex.process_mutex(NAME, {backend: "lock_file"}).destroy();
+                done();
+            });
+        });
+    });
 });
 
 describe('sharedMutex', () => {
@@ -186,4 +228,922 @@ describe('sharedMutex', () => {
             mtx2.destroy();
         });
     });
+
+    describe('#shared ownership', () => {
+        let mtx1, mtx2;
+        it('create: should not throw', () => {
+            mtx1 = new mutex.shared_mutex("test_shared", {writer_preference: true});
+            mtx2 = new mutex.shared_mutex("test_shared", {writer_preference: true});
+        });
+
+        if (process.platform === 'linux') {
+            it('create: should reject a different writer preference', () => {
+                assert.throws(() => new mutex.shared_mutex("test_shared", {writer_preference: false}));
+            });
+        }
+
+        if (process.platform === 'linux') {
+            it('lock shared: should allow multiple readers', async () => {
+                await mtx1.lock_shared();
+                assert(mtx2.try_lock_shared() === true, "mtx2.try_lock_shared() should return true");
+                assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+
+                mtx1.unlock_shared();
+                mtx2.unlock_shared();
+            });
+        }
+
+        it('lock: should block readers', async () => {
+            await mtx1.lock();
+            assert(mtx2.try_lock_shared() === false, "mtx2.try_lock_shared() should return false");
+
+            const shared = mtx2.lock_shared();
+            mtx1.unlock();
+            await shared;
+
+            assert(mtx1.try_lock() === false, "mtx1.try_lock() should return false");
+            mtx2.unlock_shared();
+            assert(mtx1.try_lock() === true, "mtx1.try_lock() should return true");
+            mtx1.unlock();
+        });
+
+        it('delete: should not throw', () => {
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+    });
+
+    describe('#handle registry', () => {
+        let mtx1, mtx2, mtx3;
+        const segment = "/dev/shm/test_registry.mutex";
+
+        it('should share one segment between instances with the same name', async () => {
+            mtx1 = new mutex.shared_mutex("test_registry");
+            mtx2 = new mutex.shared_mutex("test_registry");
+            if (process.platform === 'linux') {
+                const segments = fs.readdirSync("/dev/shm").filter(f => f.startsWith("test_registry"));
+                assert.deepStrictEqual(segments, ["test_registry.mutex"]);
+            }
+
+            await mtx1.lock();
+            assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+            mtx1.unlock();
+        });
+
+        it('should keep the name while an instance is alive', async () => {
+            mtx1.destroy();
+            if (process.platform === 'linux') {
+                assert(fs.existsSync(segment), "the segment should still exist");
+            }
+
+            mtx3 = new mutex.shared_mutex("test_registry");
+            await mtx2.lock();
+            assert(mtx3.try_lock() === false, "mtx3.try_lock() should return false");
+            mtx2.unlock();
+        });
+
+        it('should remove the name once the last instance is destroyed', () => {
+            mtx2.destroy();
+            mtx3.destroy();
+            if (process.platform === 'linux') {
+                assert(!fs.existsSync(segment), "the segment should have been removed");
+            }
+
+            const mtx = new mutex.shared_mutex("test_registry");
+            assert(mtx.try_lock() === true, "mtx.try_lock() should return true");
+            mtx.unlock();
+            mtx.destroy();
+        });
+    });
+
+    describe('#timed lock', () => {
+        let mtx1, mtx2;
+        it('create: should not throw', async () => {
+            mtx1 = new mutex.shared_mutex("test_timed");
+            mtx2 = new mutex.shared_mutex("test_timed");
+            await mtx1.lock();
+        });
+
+        it('lock with timeout: should time out', async () => {
+            await assert.rejects(mtx2.lock({timeout: 50}), {code: 'ETIMEDOUT'});
+            await assert.rejects(mtx2.lock_shared({timeout: 0}), {code: 'ETIMEDOUT'});
+        });
+
+        if (typeof AbortController !== 'undefined') {
+            it('lock with signal: should be aborted', async () => {
+                const controller = new AbortController();
+                const promise = mtx2.lock({signal: controller.signal});
+                setTimeout(() => controller.abort(), 20);
+
+                await assert.rejects(promise, {name: 'AbortError'});
+                await assert.rejects(mtx2.lock({signal: controller.signal}), {name: 'AbortError'});
+            });
+        }
+
+        it('lock with timeout: should lock the mutex', async () => {
+            const promise = mtx2.lock({timeout: 1000});
+            mtx1.unlock();
+            await promise;
+            mtx2.unlock();
+        });
+
+        it('lock with infinite timeout: should wait for the mutex', async () => {
+            await mtx1.lock();
+            const promise = mtx2.lock({timeout: Infinity});
+            await new Promise(resolve => setTimeout(resolve, 20));
+            mtx1.unlock();
+            await promise;
+            mtx2.unlock();
+        });
+
+        it('lock with NaN timeout: should throw a RangeError', async () => {
+            await assert.rejects(async () => mtx2.lock({timeout: NaN}), RangeError);
+        });
+
+        it('delete: should not throw', () => {
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+    });
+
+    describe('#async waiters', () => {
+        let mtx1, mutexes;
+        it('create: should not throw', async () => {
+            mtx1 = new mutex.shared_mutex("test_waiters");
+            mutexes = [];
+            for (let i = 0; i < 4; i++) {
+                mutexes.push(new mutex.shared_mutex("test_waiters"));
+            }
+
+            await mtx1.lock();
+        });
+
+        it('lock: should resolve many pending locks', async () => {
+            let locked = 0;
+            const promises = [];
+            for (let i = 0; i < 500; i++) {
+                const mtx = mutexes[i % mutexes.length];
+                promises.push(mtx.lock().then(() => {
+                    locked++;
+                    mtx.unlock();
+                }));
+            }
+
+            await new Promise(resolve => setTimeout(resolve, 20));
+            assert.strictEqual(locked, 0);
+
+            mtx1.unlock();
+            await Promise.all(promises);
+            assert.strictEqual(locked, 500);
+        });
+
+        it('lock: should time out while other locks are pending', async () => {
+            await mtx1.lock();
+            const pending = mutexes[0].lock();
+            await assert.rejects(mutexes[1].lock({timeout: 20}), {code: 'ETIMEDOUT'});
+
+            mtx1.unlock();
+            await pending;
+            mutexes[0].unlock();
+        });
+
+        it('delete: should not throw', () => {
+            mtx1.destroy();
+            mutexes.forEach(mtx => mtx.destroy());
+        });
+    });
+
+    describe('#with_lock', () => {
+        it('should unlock after the function returned or threw', async () => {
+            const mtx1 = new mutex.shared_mutex("test_with_lock");
+            const mtx2 = new mutex.shared_mutex("test_with_lock");
+
+            const value = await mtx1.with_lock(async () => {
+                assert(mtx2.try_lock() === false, "the mutex should be locked");
+                return 42;
+            });
+
+            assert.strictEqual(value, 42);
+            await assert.rejects(mtx1.with_lock(() => {
+                throw new Error("failed");
+            }), {message: "failed"});
+
+            assert(mtx2.try_lock() === true, "the mutex should have been unlocked");
+            await assert.rejects(mtx1.with_lock(() => {}, {timeout: 20}), {code: 'ETIMEDOUT'});
+            mtx2.unlock();
+
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+    });
+
+    describe('#backends', () => {
+        const backends = process.platform === 'linux' ? ['semaphore', 'futex', 'fair', 'pi'] : ['semaphore', 'fair'];
+        for (const backend of backends) {
+            it(`${backend}: should lock and unlock`, async () => {
+                const mtx1 = new mutex.shared_mutex("test_backend", {backend});
+                const mtx2 = new mutex.shared_mutex("test_backend", {backend});
+
+                await mtx1.lock();
+                assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+
+                mtx1.unlock();
+                assert(mtx2.try_lock() === true, "mtx2.try_lock() should return true");
+
+                mtx2.unlock();
+                mtx1.destroy();
+                mtx2.destroy();
+            });
+        }
+
+        it('fair: should serve waiters in order', async () => {
+            const holder = new mutex.shared_mutex("test_fair", {backend: "fair"});
+            const waiters = [0, 1, 2].map(() => new mutex.shared_mutex("test_fair", {backend: "fair"}));
+            await holder.lock();
+
+            const order = [];
+            const promises = [];
+            for (let i = 0; i < waiters.length; i++) {
+                promises.push(waiters[i].lock().then(() => {
+                    order.push(i);
+                    waiters[i].unlock();
+                }));
+
+                await new Promise(resolve => setTimeout(resolve, 10));
+            }
+
+            holder.unlock();
+            await Promise.all(promises);
+            assert.deepStrictEqual(order, [0, 1, 2]);
+
+            holder.destroy();
+            waiters.forEach(mtx => mtx.destroy());
+        });
+
+        if (process.platform === 'linux') {
+            it('pi: should be locked by async waiters on the calling thread', async () => {
+                const mtx1 = new mutex.shared_mutex("test_pi", {backend: "pi"});
+                const mtx2 = new mutex.shared_mutex("test_pi", {backend: "pi"});
+                await mtx1.lock();
+
+                const locked = mtx2.lock();
+                await new Promise(resolve => setTimeout(resolve, 10));
+                mtx1.unlock();
+                await locked;
+
+                assert(mtx1.try_lock() === false, "the mutex should be locked by mtx2");
+                mtx2.unlock();
+                assert(mtx1.try_lock() === true, "the mutex should have been unlocked");
+                mtx1.unlock();
+
+                mtx1.destroy();
+                mtx2.destroy();
+            });
+        }
+
+        if (process.platform !== 'win32') {
+            it('robust: should recover from the owner dying', (done) => {
+                fork("child_test.js", ["lockAndDie", "test_robust"]).on('close', () => {
+                    const mtx = new mutex.shared_mutex("test_robust", {backend: "robust"});
+                    mtx.lock().then(({inconsistent}) => {
+                        assert(inconsistent === true, "inconsistent should be true");
+                        assert(mtx.owner_died() === true, "mtx.owner_died() should return true");
+                        mtx.unlock();
+
+                        assert(mtx.try_lock() === true, "mtx.try_lock() should return true");
+                        assert(mtx.owner_died() === false, "mtx.owner_died() should return false");
+                        mtx.destroy();
+                    }).then(done, done);
+                });
+            }).timeout(5000);
+
+            it('robust: should detect a dead owner within the liveness interval', (done) => {
+                const mtx = new mutex.shared_mutex("test_robust_alive", {backend: "robust"});
+                const child = fork("child_test.js", ["lockAndWait", "test_robust_alive"]);
+                child.on('message', () => {
+                    // Remember the owner as alive, then kill it
+                    assert(mtx.try_lock() === false, "mtx.try_lock() should return false");
+                    child.kill("SIGKILL");
+                });
+
+                child.on('exit', () => {
+                    // The owner must not be remembered as alive for longer than the liveness interval
+                    setTimeout(() => {
+                        try {
+                            assert(mtx.try_lock() === true, "mtx.try_lock() should return true");
+                            assert(mtx.owner_died() === true, "mtx.owner_died() should return true");
+                            mtx.unlock();
+                            mtx.destroy();
+                            done();
+                        } catch (e) {
+                            done(e);
+                        }
+                    }, 20);
+                });
+            }).timeout(5000);
+        }
+
+        it('unknown backend: should throw', () => {
+            assert.throws(() => {
+                new mutex.shared_mutex("test_backend", {backend: "unknown"});
+            }, TypeError);
+        });
+    });
+
+    describe('#wait policy', () => {
+        it('adaptive: should lock and unlock', async () => {
+            const mtx1 = new mutex.shared_mutex("test_wait_policy", {wait_policy: "adaptive", max_spins: 100});
+            const mtx2 = new mutex.shared_mutex("test_wait_policy", {wait_policy: "adaptive", max_yields: 2});
+
+            await mtx1.lock();
+            const promise = mtx2.lock();
+            mtx1.unlock();
+            await promise;
+            mtx2.unlock();
+
+            const stats = mtx2.wait_stats();
+            for (const phase of ['spin', 'yield', 'park']) {
+                assert(typeof stats[phase] === 'number', `stats.${phase} should be a number`);
+            }
+
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+
+        it('unknown wait policy: should throw', () => {
+            assert.throws(() => {
+                new mutex.shared_mutex("test_wait_policy", {wait_policy: "unknown"});
+            }, TypeError);
+        });
+    });
+
+    describe('#stats', () => {
+        it('should count acquisitions and contention', async () => {
+            const mtx1 = new mutex.shared_mutex("test_stats", {stats: true});
+            const mtx2 = new mutex.shared_mutex("test_stats", {stats: true});
+            const stats = mtx1.stats();
+            if (!stats.enabled) return;
+
+            await mtx1.lock();
+            assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+
+            const promise = mtx2.lock();
+            await new Promise(resolve => setTimeout(resolve, 20));
+            assert(mtx1.stats().waiters === stats.waiters + 1, "there should be one waiter");
+
+            mtx1.unlock();
+            await promise;
+            mtx2.unlock();
+
+            const after = mtx2.stats();
+            assert(after.acquisitions === stats.acquisitions + 2, "the mutex should have been acquired twice");
+            assert(after.contended === stats.contended + 1, "one acquisition should have been contended");
+            assert(after.try_lock_failures === stats.try_lock_failures + 1, "one try_lock should have failed");
+            assert(after.waiters === stats.waiters, "nobody should be waiting");
+            assert(after.max_wait_ns >= 10e6, "the max wait time should be at least 10ms");
+            const holds = histogram => histogram.reduce((a, b) => a + b, 0);
+            assert(holds(after.hold_histogram) === holds(stats.hold_histogram) + 2, "two holds should have been recorded");
+
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+
+        it('should not record statistics by default', async () => {
+            const mtx = new mutex.shared_mutex("test_stats_default");
+            await mtx.lock();
+            mtx.unlock();
+
+            const stats = mtx.stats();
+            assert(stats.enabled === false, "the statistics should not be enabled");
+            assert(stats.acquisitions === 0, "no acquisitions should have been recorded");
+            mtx.destroy();
+        });
+    });
+
+    describe('#trace', () => {
+        it('should export the traced lock events', async () => {
+            const mtx1 = new mutex.shared_mutex("test_trace", {trace: true, stats: true});
+            const mtx2 = new mutex.shared_mutex("test_trace", {trace: true});
+            if (!mtx1.stats().enabled) return;
+
+            await mtx1.lock();
+            assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+            const promise = mtx2.lock();
+            await new Promise(resolve => setTimeout(resolve, 10));
+            mtx1.unlock();
+            await promise;
+            mtx2.unlock();
+
+            const events = JSON.parse(mutex.shared_mutex.export_trace()).traceEvents
+                .filter(e => e.name === "test_trace" && e.pid === process.pid);
+            const count = cat => events.filter(e => e.cat === cat).length;
+            assert(count('hold') >= 2, "both holds should have been traced");
+            assert(count('wait') >= 1, "the wait should have been traced");
+            assert(count('try_lock_failed') >= 1, "the failed try_lock should have been traced");
+
+            mtx1.destroy();
+            mtx2.destroy();
+        });
+    });
+
+    describe('#lock_all', () => {
+        it('should lock all mutexes at once', async () => {
+            const a = new mutex.shared_mutex("test_lock_all_a");
+            const b = new mutex.shared_mutex("test_lock_all_b");
+            const other = new mutex.shared_mutex("test_lock_all_b");
+
+            const results = await mutex.shared_mutex.lock_all([a, b]);
+            assert.deepStrictEqual(results, [{inconsistent: false}, {inconsistent: false}]);
+            assert(other.try_lock() === false, "the mutex should be locked");
+            mutex.shared_mutex.unlock_all([a, b]);
+
+            // Wait for the contended mutex without holding the other one
+            assert(other.try_lock() === true, "other.try_lock() should return true");
+            const promise = mutex.shared_mutex.lock_all([a, b]);
+            await new Promise(resolve => setTimeout(resolve, 10));
+            assert(a.try_lock() === true, "a should not be held while waiting");
+            a.unlock();
+            other.unlock();
+            await promise;
+            mutex.shared_mutex.unlock_all([a, b]);
+
+            a.destroy();
+            b.destroy();
+            other.destroy();
+        });
+
+        it('should not deadlock in opposite orders', async () => {
+            const a = new mutex.shared_mutex("test_lock_all_order_a");
+            const b = new mutex.shared_mutex("test_lock_all_order_b");
+            const c = new mutex.shared_mutex("test_lock_all_order_c");
+
+            let running = 0;
+            const run = mutexes => mutex.shared_mutex.with_lock_all(mutexes, async () => {
+                assert(++running === 1, "the critical sections should not overlap");
+                await new Promise(resolve => setImmediate(resolve));
+                running--;
+            }, {timeout: 5000});
+
+            const promises = [];
+            for (let i = 0; i < 20; i++) {
+                promises.push(run([a, b, c]), run([c, b, a]), run([b, c, a]));
+            }
+
+            await Promise.all(promises);
+            a.destroy();
+            b.destroy();
+            c.destroy();
+        });
+
+        it('should release all mutexes on timeout', async () => {
+            const a = new mutex.shared_mutex("test_lock_all_timeout_a");
+            const b = new mutex.shared_mutex("test_lock_all_timeout_b");
+            const other = new mutex.shared_mutex("test_lock_all_timeout_b");
+            assert.throws(() => mutex.shared_mutex.lock_all([a, other]));
+
+            await other.lock();
+            await assert.rejects(mutex.shared_mutex.lock_all([a, b], {timeout: 20}), {code: 'ETIMEDOUT'});
+            assert(a.try_lock() === true, "a should have been released");
+            a.unlock();
+            other.unlock();
+
+            a.destroy();
+            b.destroy();
+            other.destroy();
+        });
+    });
+});
+
+describe('lockTable', () => {
+    describe('#basic tests', () => {
+        let table1, table2;
+        it('create: should not throw', () => {
+            table1 = new mutex.lock_table("test_table", {slots: 64});
+            table2 = new mutex.lock_table("test_table", {slots: 64});
+        });
+
+        it('try_lock: should lock keys independently', () => {
+            assert(table1.try_lock("a") === true, "table1.try_lock(a) should return true");
+            assert(table2.try_lock("a") === false, "table2.try_lock(a) should return false");
+
+            let other = 0;
+            while (table1.home_slot("k" + other) === table1.home_slot("a")) other++;
+            assert(table2.try_lock("k" + other) === true, "a key on another slot should not be locked");
+            table2.unlock("k" + other);
+        });
+
+        it('lock: should wait for the key', async () => {
+            const promise = table2.lock("a", {timeout: 1000});
+            table1.unlock("a");
+            await promise;
+            await assert.rejects(table1.lock("a", {timeout: 20}), {code: 'ETIMEDOUT'});
+            table2.unlock("a");
+        });
+
+        it('unlock: should throw if the key is not locked', () => {
+            assert.throws(() => table1.unlock("a"));
+        });
+
+        it('different options: should throw', () => {
+            assert.throws(() => new mutex.lock_table("test_table", {slots: 32}));
+        });
+
+        it('delete: should unlock all keys', () => {
+            table1.lock_blocking("b");
+            table1.destroy();
+            assert(table2.try_lock("b") === true, "table2.try_lock(b) should return true");
+            table2.destroy();
+        });
+    });
+
+    describe('#collision detection', () => {
+        it('should not block different keys on the same slot', async () => {
+            const table1 = new mutex.lock_table("test_table_collisions", {slots: 64, detect_collisions: true});
+            const table2 = new mutex.lock_table("test_table_collisions", {slots: 64, detect_collisions: true});
+
+            let other = 0;
+            while (table1.home_slot("k" + other) !== table1.home_slot("a")) other++;
+
+            await table1.lock("a");
+            assert(table2.try_lock("k" + other) === true, "a colliding key should be locked");
+            assert(table2.try_lock("a") === false, "table2.try_lock(a) should return false");
+
+            table1.unlock("a");
+            table2.unlock("k" + other);
+            table1.destroy();
+            table2.destroy();
+        });
+    });
+});
+
+describe('sharedSemaphore', () => {
+    describe('#basic tests', () => {
+        let sem1, sem2;
+        it('create: should not throw', () => {
+            sem1 = new mutex.shared_semaphore("test_semaphore", {initial: 3, max: 4});
+            sem2 = new mutex.shared_semaphore("test_semaphore", {max: 4});
+            assert.strictEqual(sem2.count(), 3);
+        });
+
+        it('try_acquire: should acquire multiple permits at once', () => {
+            assert(sem1.try_acquire(2) === true, "sem1.try_acquire(2) should return true");
+            assert(sem2.try_acquire(2) === false, "sem2.try_acquire(2) should return false");
+            assert.strictEqual(sem1.count(), 1);
+        });
+
+        it('acquire: should wait for the permits', async () => {
+            const promise = sem2.acquire(3, {timeout: 1000});
+            await assert.rejects(sem1.acquire(4, {timeout: 20}), {code: 'ETIMEDOUT'});
+            sem1.release(2);
+            await promise;
+            assert.strictEqual(sem1.count(), 0);
+            sem2.release(3);
+        });
+
+        it('release: should throw if the max count is exceeded', () => {
+            sem1.release();
+            assert.throws(() => sem1.release());
+            sem2.acquire_blocking();
+        });
+
+        it('different max count: should throw', () => {
+            assert.throws(() => new mutex.shared_semaphore("test_semaphore", {max: 2}));
+        });
+
+        it('delete: should release the acquired permits', () => {
+            sem1.acquire_blocking(2);
+            sem1.destroy();
+            assert.strictEqual(sem2.count(), 3);
+            sem2.destroy();
+        });
+    });
+});
+
+describe('sharedConditionVariable', () => {
+    it('wait: should be notified', async () => {
+        const mtx1 = new mutex.shared_mutex("test_condition_mutex");
+        const mtx2 = new mutex.shared_mutex("test_condition_mutex");
+        const condition = new mutex.shared_condition_variable("test_condition");
+
+        await mtx1.lock();
+        const promise = condition.wait(mtx1);
+
+        // The mutex is unlocked while waiting
+        await mtx2.lock();
+        mtx2.unlock();
+        condition.notify_one();
+
+        assert(await promise === true, "the wait should have been notified");
+        assert(mtx2.try_lock() === false, "the mutex should be locked again");
+        mtx1.unlock();
+
+        mtx1.destroy();
+        mtx2.destroy();
+        condition.destroy();
+    });
+
+    it('wait with timeout: should lock the mutex again', async () => {
+        const mtx1 = new mutex.shared_mutex("test_condition_timeout");
+        const mtx2 = new mutex.shared_mutex("test_condition_timeout");
+        const condition = new mutex.shared_condition_variable("test_condition_timeout");
+
+        assert.throws(() => condition.wait(mtx1), /must be locked/);
+        await mtx1.lock();
+        assert(await condition.wait(mtx1, {timeout: 20}) === false, "the wait should have timed out");
+        assert(mtx2.try_lock() === false, "the mutex should be locked again");
+        assert(condition.wait_blocking(mtx1, 10) === false, "the blocking wait should have timed out");
+        mtx1.unlock();
+
+        mtx1.destroy();
+        mtx2.destroy();
+        condition.destroy();
+    });
+
+    it('wait: should accept a mutex created in a worker thread', async () => {
+        const worker = new Worker(`
+            const {parentPort} = require('worker_threads');
+            const mutex = require(${JSON.stringify(require.resolve('./index'))});
+            (async () => {
+                const mtx1 = new mutex.shared_mutex("test_condition_worker");
+                const mtx2 = new mutex.shared_mutex("test_condition_worker");
+                const condition = new mutex.shared_condition_variable("test_condition_worker");
+                await mtx1.lock();
+                const notified = await condition.wait(mtx1, {timeout: 10});
+                const locked = mtx2.try_lock() === false;
+                mtx1.unlock();
+                mtx1.destroy();
+                mtx2.destroy();
+                condition.destroy();
+                parentPort.postMessage({notified, locked});
+            })().catch(e => parentPort.postMessage({error: e.message}));
+        `, {eval: true});
+
+        const result = await new Promise((resolve, reject) => {
+            worker.once('message', resolve);
+            worker.once('error', reject);
+        });
+        await worker.terminate();
+
+        assert.deepStrictEqual(result, {notified: false, locked: true});
+
+        // The constructors of the main thread still work after the worker exited
+        const mtx = new mutex.shared_mutex("test_condition_worker");
+        assert(mtx.try_lock() === true, "mtx.try_lock() should return true");
+        mtx.unlock();
+        mtx.destroy();
+    });
+});
+
+describe('sharedEvent', () => {
+    it('auto reset: should release a single waiter', async () => {
+        const event1 = new mutex.shared_event("test_event");
+        const event2 = new mutex.shared_event("test_event");
+        assert(event1.try_wait() === false, "the event should not be set");
+
+        const promise = event2.wait({timeout: 1000});
+        event1.set();
+        await promise;
+        assert(event1.try_wait() === false, "the event should have been reset");
+        await assert.rejects(event2.wait({timeout: 20}), {code: 'ETIMEDOUT'});
+
+        event1.destroy();
+        event2.destroy();
+    });
+
+    it('manual reset: should release all waiters', async () => {
+        const event = new mutex.shared_event("test_event_manual", {manual_reset: true});
+        const promises = [event.wait(), event.wait()];
+        event.set();
+        await Promise.all(promises);
+        assert(event.try_wait() === true, "the event should still be set");
+
+        event.reset();
+        assert(event.try_wait() === false, "the event should have been reset");
+        assert.throws(() => new mutex.shared_event("test_event_manual"));
+        event.destroy();
+    });
+});
+
+describe('cohortMutex', () => {
+    it('should hand off the mutex inside the process', async () => {
+        const mtx1 = new mutex.cohort_mutex("test_cohort");
+        const mtx2 = new mutex.cohort_mutex("test_cohort");
+        const other = new mutex.shared_mutex("test_cohort");
+        const stats = mtx1.stats();
+
+        await mtx1.lock();
+        assert(mtx2.try_lock() === false, "mtx2.try_lock() should return false");
+        assert(other.try_lock() === false, "the cross-process mutex should be locked");
+
+        const promise = mtx2.lock();
+        await new Promise(resolve => setTimeout(resolve, 20));
+        mtx1.unlock();
+        await promise;
+
+        assert(other.try_lock() === false, "the cross-process mutex should have been handed off");
+        mtx2.unlock();
+        assert(other.try_lock() === true, "the cross-process mutex should have been released");
+        other.unlock();
+
+        const after = mtx1.stats();
+        assert(after.global_acquisitions === stats.global_acquisitions + 1, "the mutex should have been acquired once");
+        assert(after.local_handoffs === stats.local_handoffs + 1, "the mutex should have been handed off once");
+
+        mtx1.destroy();
+        mtx2.destroy();
+        other.destroy();
+    });
+
+    it('lock with timeout: should time out', async () => {
+        const mtx = new mutex.cohort_mutex("test_cohort_timeout");
+        const other = new mutex.shared_mutex("test_cohort_timeout");
+
+        await other.lock();
+        await assert.rejects(mtx.lock({timeout: 20}), {code: 'ETIMEDOUT'});
+        other.unlock();
+        await mtx.lock({timeout: 1000});
+        mtx.unlock();
+
+        mtx.destroy();
+        other.destroy();
+    });
+});
+
+describe('leaseMutex', () => {
+    it('should issue increasing fencing tokens', async () => {
+        const mtx1 = new mutex.lease_mutex("test_lease");
+        const mtx2 = new mutex.lease_mutex("test_lease");
+
+        const token1 = await mtx1.lock({ttl: 1000});
+        assert(typeof token1 === 'bigint', "the token should be a bigint");
+        assert(mtx2.try_lock() === null, "mtx2.try_lock() should return null");
+        assert(mtx1.held() && mtx1.is_current(token1), "mtx1 should hold the lease");
+        assert(mtx1.renew(1000) === true, "the lease should have been renewed");
+        assert(mtx1.unlock() === true, "the lease should have been released");
+
+        const token2 = mtx2.try_lock();
+        assert(token2 > token1, "the token should have increased");
+        assert(!mtx1.is_current(token1), "the old token should not be current");
+        mtx2.unlock();
+
+        mtx1.destroy();
+        mtx2.destroy();
+    });
+
+    it('should take over an expired lease', async () => {
+        const mtx1 = new mutex.lease_mutex("test_lease_expired");
+        const mtx2 = new mutex.lease_mutex("test_lease_expired");
+
+        const token1 = mtx1.lock_blocking(50);
+        const token2 = await mtx2.lock({ttl: 1000, timeout: 2000});
+        assert(token2 > token1, "the token should have increased");
+        assert(mtx1.held() === false, "mtx1 should have lost the lease");
+        assert(mtx1.renew() === false, "the lost lease should not be renewed");
+
+        await assert.rejects(mtx1.lock({timeout: 20}), {code: 'ETIMEDOUT'});
+        assert(mtx2.unlock() === true, "the lease should have been released");
+        assert.throws(() => mtx1.lock_blocking(0), RangeError);
+
+        mtx1.destroy();
+        mtx2.destroy();
+    });
+});
+
+describe('sharedSeqlock', () => {
+    it('should copy data in and out', () => {
+        const region1 = new mutex.shared_seqlock("test_seqlock", 16);
+        const region2 = new mutex.shared_seqlock("test_seqlock", 16);
+        assert.throws(() => new mutex.shared_seqlock("test_seqlock", 8));
+
+        const sequence = region2.sequence();
+        region1.write(Buffer.from([1, 2, 3, 4]), 10);
+        assert(region2.sequence() > sequence, "the sequence number should have increased");
+        assert.deepStrictEqual([...region2.read().subarray(10, 14)], [1, 2, 3, 4]);
+
+        const target = new Uint8Array(3);
+        assert.strictEqual(region2.read_into(target, 11), region2.sequence());
+        assert.deepStrictEqual([...target], [2, 3, 4]);
+        assert.throws(() => region2.read_into(target, 14));
+
+        region1.destroy();
+        region2.destroy();
+    });
+});
+
+describe('sharedBuffer', () => {
+    it('should share memory between instances', async () => {
+        const shared1 = new mutex.shared_buffer("test_buffer", 16);
+        const shared2 = new mutex.shared_buffer("test_buffer", 8);
+        assert.strictEqual(shared2.size(), 16);
+
+        await shared1.mutex.with_lock(() => {
+            assert(shared2.mutex.try_lock() === false, "the mutex should be locked");
+            new Uint8Array(shared1.buffer()).set([1, 2, 3]);
+        });
+
+        const old = new Uint8Array(shared2.buffer());
+        assert.deepStrictEqual([...old.subarray(0, 3)], [1, 2, 3]);
+
+        if (process.platform !== 'win32') {
+            shared2.grow(64);
+            const view = new Uint8Array(shared1.buffer());
+            assert.strictEqual(view.length, 64);
+            view[0] = 42;
+            assert.strictEqual(old[0], 42);
+        }
+
+        shared1.destroy();
+        shared2.destroy();
+    });
+});
+
+describe('sharedRing', () => {
+    it('should pass messages between instances', async () => {
+        const ring1 = new mutex.shared_ring("test_ring", {capacity: 4, slot_size: 8});
+        const ring2 = new mutex.shared_ring("test_ring", {capacity: 4, slot_size: 8});
+        assert.strictEqual(ring2.capacity(), 4);
+        assert.throws(() => ring1.try_push(Buffer.alloc(9)));
+
+        assert(ring1.try_push(Buffer.from([1, 2, 3])), "the message should have been pushed");
+        assert.strictEqual(ring1.try_push_batch([Buffer.from([4]), Buffer.from([5]), Buffer.from([6]),
+            Buffer.from([7])]), 3);
+        assert.strictEqual(ring2.size(), 4);
+        await assert.rejects(ring1.push(Buffer.from([8]), {timeout: 20}), {code: 'ETIMEDOUT'});
+
+        assert.deepStrictEqual([...ring2.try_pop()], [1, 2, 3]);
+        assert.deepStrictEqual(ring2.try_pop_batch(8).map(m => m[0]), [4, 5, 6]);
+        assert.strictEqual(ring2.try_pop(), null);
+        assert.deepStrictEqual(ring2.try_pop_batch(8), []);
+
+        const popped = ring2.pop();
+        await ring1.push(Buffer.from([9]));
+        assert.deepStrictEqual([...await popped], [9]);
+
+        ring1.destroy();
+        ring2.destroy();
+    });
+});
+
+describe('sharedBarrier', () => {
+    it('should release all participants once the last one arrived', async () => {
+        const barrier1 = new mutex.shared_barrier("test_barrier", 3);
+        const barrier2 = new mutex.shared_barrier("test_barrier", 3);
+        assert.strictEqual(barrier1.count(), 3);
+        assert.throws(() => new mutex.shared_barrier("test_barrier", 2));
+
+        for (let phase = 0; phase < 3; phase++) {
+            const promises = [barrier1.wait(), barrier2.wait()];
+            assert.strictEqual(barrier1.arrived(), 2);
+            assert(barrier1.wait_blocking(1000) === true, "the phase should have completed");
+            await Promise.all(promises);
+            assert.strictEqual(barrier2.arrived(), 0);
+        }
+
+        barrier1.destroy();
+        barrier2.destroy();
+    });
+
+    it('should withdraw the arrival on timeout', async () => {
+        const barrier = new mutex.shared_barrier("test_barrier_timeout", 2);
+        await assert.rejects(barrier.wait({timeout: 20}), {code: 'ETIMEDOUT'});
+        assert(barrier.wait_blocking(20) === false, "the wait should have timed out");
+        assert.strictEqual(barrier.arrived(), 0);
+        barrier.destroy();
+    });
+
+    it('should rendezvous with another process', async () => {
+        const barrier = new mutex.shared_barrier("test_barrier_process", 2);
+        const latch = new mutex.shared_latch("test_barrier_process", 1);
+        const child = fork("child_test.js", ["barrierWait", "test_barrier_process"]);
+
+        await barrier.wait({timeout: 5000});
+        await latch.wait({timeout: 5000});
+        await new Promise(resolve => child.on('close', resolve));
+
+        barrier.destroy();
+        latch.destroy();
+    });
+});
+
+describe('sharedLatch', () => {
+    it('should open once the counter reached zero', async () => {
+        const latch1 = new mutex.shared_latch("test_latch", 3);
+        const latch2 = new mutex.shared_latch("test_latch", 1);
+        assert.strictEqual(latch2.count(), 3);
+        assert(latch1.try_wait() === false, "the latch should be closed");
+
+        const promise = latch2.wait();
+        await assert.rejects(latch1.wait({timeout: 20}), {code: 'ETIMEDOUT'});
+        latch1.count_down(2);
+        assert.throws(() => latch2.count_down(2));
+        assert(latch1.wait_blocking(20) === false, "the wait should have timed out");
+
+        latch2.count_down();
+        await promise;
+        assert(latch1.try_wait() === true, "the latch should be open");
+        assert(latch1.wait_blocking() === true, "the latch should be open");
+
+        latch1.destroy();
+        latch2.destroy();
+    });
 });